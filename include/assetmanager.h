@@ -0,0 +1,133 @@
+#ifndef ASSETMANAGER_H
+#define ASSETMANAGER_H
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "meshcache.h"
+#include "texturecache.h"
+
+// Carregamento dos recursos do jogo (modelos, texturas e shaders) em threads
+// auxiliares, a partir de um manifesto (veja "data/assets.txt"). As threads
+// leem os arquivos e fazem todo o trabalho de CPU: malhas são mapeadas do
+// cache ".mesh" ou construídas a partir do OBJ (e o cache é gravado),
+// imagens são lidas do arquivo ".tex" ou decodificadas, e o código dos
+// shaders é lido do disco. O gerenciador não faz chamadas OpenGL: a thread
+// do contexto OpenGL pega os recursos prontos com AssetManager_Take(), os
+// envia para a GPU e os marca com AssetManager_MarkReady(), que chama o
+// callback registrado para o recurso (veja UploadLoadedAssets() em
+// "scene.cpp").
+//
+// Recursos marcados como essenciais no manifesto são carregados antes dos
+// demais; o jogo só precisa esperar por eles para desenhar o primeiro quadro.
+
+// Manifesto dos recursos do jogo, relativo ao diretório "bin/<sistema>" de
+// onde o jogo é executado
+#define ASSET_MANIFEST "../../data/assets.txt"
+
+// Tipos de recurso (primeira coluna do manifesto)
+#define ASSET_MESH    0 // "mesh": modelo OBJ
+#define ASSET_TEXTURE 1 // "texture": imagem de textura
+#define ASSET_SHADER  2 // "shader": código GLSL
+
+// Estados de um recurso (campo "state" de Asset)
+#define ASSET_PENDING 0 // Ainda não carregado
+#define ASSET_LOADED  1 // Carregado (ou com erro, veja "failed") e ainda não devolvido
+#define ASSET_TAKEN   2 // Devolvido por AssetManager_Take(), sendo enviado para a GPU
+#define ASSET_READY   3 // Marcado por AssetManager_MarkReady()
+
+struct Asset;
+
+// Função chamada pela thread do OpenGL quando um recurso fica pronto. "user"
+// é o ponteiro passado para AssetManager_OnReady().
+typedef void (*AssetCallback)(Asset *asset, void *user);
+
+struct Asset
+{
+    int type;             // ASSET_MESH, ASSET_TEXTURE ou ASSET_SHADER
+    std::string name;     // Nome do recurso no manifesto
+    std::string filename; // Caminho do arquivo, relativo ao diretório atual
+    bool essential;
+
+    // Resultado da leitura, preenchido pela thread auxiliar conforme o tipo
+    MeshCacheFile cache;  // Malha mapeada do cache ".mesh" (se "from_cache")
+    MeshData mesh;        // Malha construída a partir do OBJ
+    TextureData texture;  // Níveis de mipmap da textura
+    std::string source;   // Código do shader
+    bool from_cache;      // Lido do arquivo ".mesh" ou ".tex"
+    bool failed;          // Erro ao ler ou decodificar o arquivo
+    double load_seconds;  // Tempo gasto pela thread auxiliar
+
+    // Preenchidos pela thread do OpenGL
+    int object_id;             // Primeiro objeto do modelo em g_VirtualScene (ASSET_MESH)
+    unsigned int texture_unit; // Unidade de textura (ASSET_TEXTURE)
+    unsigned int texture_id;   // Textura OpenGL (ASSET_TEXTURE)
+
+    AssetCallback on_ready;
+    void *user;
+
+    std::atomic<int> state;
+};
+
+struct AssetManager
+{
+    std::vector<Asset *> assets; // Na ordem do manifesto
+    std::vector<Asset *> queue;  // Ordem de carregamento: essenciais primeiro
+    std::vector<std::thread> threads;
+    std::atomic<size_t> next_asset; // Próximo recurso de "queue" a ser carregado por uma thread
+    int threads_per_asset;          // Threads de ObjLoader_Load() e ComputeVertexNormals() em cada thread
+    uint32_t texture_format;        // Formato das texturas (TEXTURE_FORMAT_*)
+    std::chrono::steady_clock::time_point start;
+};
+
+// Adiciona os recursos listados no arquivo "filename". Cada linha tem o
+// formato
+//
+//     # comentário
+//     # tipo    nome       arquivo               [essential]
+//     mesh      spaceship  spaceship.obj
+//     shader    vertex     ../src/shader.glsl    essential
+//
+// onde os caminhos são relativos ao diretório do manifesto. Retorna false,
+// imprimindo o erro, se o arquivo não existir ou tiver uma linha inválida.
+bool AssetManager_ReadManifest(AssetManager *manager, const char *filename);
+
+// Adiciona um recurso. Deve ser chamada antes de AssetManager_Start().
+Asset *AssetManager_Add(AssetManager *manager, int type, const char *name, const char *filename, bool essential);
+
+// Busca um recurso pelo nome; retorna NULL se ele não existir
+Asset *AssetManager_Find(const AssetManager *manager, const char *name);
+
+// Registra a função chamada quando o recurso "name" ficar pronto. Se ele já
+// estiver pronto, a função é chamada imediatamente. Retorna false se o
+// recurso não existir. Deve ser chamada pela thread do OpenGL.
+bool AssetManager_OnReady(AssetManager *manager, const char *name, AssetCallback callback, void *user);
+
+// Começa a carregar todos os recursos, com texturas no formato "format", com
+// até "num_threads" threads (0 para o número de núcleos da máquina). Retorna
+// imediatamente.
+void AssetManager_Start(AssetManager *manager, uint32_t texture_format, int num_threads = 0);
+
+// Devolve um recurso já carregado e ainda não devolvido, ou NULL se nenhum
+// estiver pronto. Com "wait" verdadeiro, espera até que algum fique pronto;
+// nesse caso só retorna NULL quando todos já tiverem sido devolvidos. Deve
+// ser chamada sempre pela mesma thread.
+Asset *AssetManager_Take(AssetManager *manager, bool wait);
+
+// Marca como pronto um recurso devolvido por AssetManager_Take() e, se ele
+// foi carregado sem erro, chama o seu callback. Em seguida libera os dados
+// de CPU do recurso ("mesh", "texture", "source" etc.), que o callback ainda
+// pode utilizar.
+void AssetManager_MarkReady(AssetManager *manager, Asset *asset);
+
+// Retorna true se todos os recursos essenciais (ou todos, com
+// "essential_only" falso) já foram marcados como prontos
+bool AssetManager_Ready(const AssetManager *manager, bool essential_only);
+
+// Espera as threads terminarem e libera todos os recursos
+void AssetManager_Finish(AssetManager *manager);
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+// Modos de benchmark, executados pela linha de comando sem abrir janela nem
+// criar contexto OpenGL:
+//
+//     main --bench <nome> [argumentos]
+//
+// Retorna o código de saída do programa.
+int Benchmark_Run(int argc, char *argv[]);
+
+#endif
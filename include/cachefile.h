@@ -0,0 +1,56 @@
+#ifndef CACHEFILE_H
+#define CACHEFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Funções comuns aos arquivos de cache gravados em disco: ".mesh"
+// ("meshcache.h"), ".tex" ("texturecache.h") e programas de GPU
+// ("programcache.h"). Cada arquivo começa com um cabeçalho próprio, que
+// identifica o arquivo de origem pelo tamanho, pela data de modificação e
+// pelo hash do conteúdo.
+
+// Valor inicial do hash FNV-1a de 64 bits
+#define CACHE_FILE_HASH_SEED 14695981039346656037ULL
+
+// Acumula "size" bytes no hash FNV-1a de 64 bits "h"
+uint64_t CacheFile_HashBytes(uint64_t h, const void *data, size_t size);
+
+// Hash FNV-1a de 64 bits do conteúdo de um arquivo. Retorna false se o
+// arquivo não puder ser lido.
+bool CacheFile_Hash(const char *filename, uint64_t *hash);
+
+// Tamanho e data de modificação de um arquivo. A data é em nanosegundos
+// quando o sistema a fornece, para que duas edições no mesmo segundo não
+// sejam confundidas.
+bool CacheFile_Stat(const char *filename, uint64_t *size, int64_t *mtime);
+
+// Retorna true se o arquivo de origem de um cache não mudou desde que o
+// cache foi gravado com os valores "size", "mtime" e "hash". Se o tamanho e a
+// data de modificação coincidem, confiamos no cache sem ler o arquivo. Se
+// somente a data mudou (ex: arquivo copiado ou "git checkout"), comparamos o
+// hash do conteúdo.
+bool CacheFile_SourceUnchanged(const char *filename, uint64_t size, int64_t mtime, uint64_t hash);
+
+// Nome do arquivo de cache de "source_filename": mesmo diretório e nome,
+// com a extensão trocada por "extension" (ex: ".mesh")
+std::string CacheFile_Filename(const char *source_filename, const char *extension);
+
+// Trecho de dados gravado após o cabeçalho por CacheFile_Write()
+struct CacheFileChunk
+{
+    const void *data;
+    size_t size;
+};
+
+// Grava "filename" com o cabeçalho "header" seguido dos trechos "chunks".
+// Primeiro é gravado um cabeçalho zerado e só no final o cabeçalho
+// verdadeiro, de modo que um arquivo escrito pela metade (ex: programa
+// interrompido) nunca seja aceito pela leitura, que confere o campo "magic"
+// do cabeçalho. Em caso de erro imprime um aviso, apaga o arquivo e retorna
+// false.
+bool CacheFile_Write(const char *filename, const void *header, size_t header_size,
+                     const CacheFileChunk *chunks, int num_chunks);
+
+#endif
@@ -3,6 +3,11 @@
 
 #include <glm/glm.hpp>
 
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
 struct HitBox
 {
     glm::vec3 minPoint;
@@ -20,4 +25,126 @@ bool SpaceshipCoinCollision(HitBox SpaceshipHitBox, HitBox CoinHitBox);
 bool SpaceshipMoonCollision(HitBox SpaceshipHitBox, HitSphere MoonHitSphere);
 bool SpaceshipUniverseCollision(HitBox SpaceshipHitBox, float limit);
 
+// Colees de caixas e esferas no formato "structure of arrays": cada
+// coeficiente fica em um vetor separado, alinhado em 32 bytes e com
+// capacidade mltipla de 8, de modo que as funes *_OverlapBatch() abaixo
+// testem 4 (SSE) ou 8 (AVX2) corpos por instruo. As posies entre "count"
+// e "capacity" guardam corpos vazios, que nunca colidem.
+struct HitBoxSoA
+{
+    float *min_x, *min_y, *min_z;
+    float *max_x, *max_y, *max_z;
+    size_t count;
+    size_t capacity;
+    void *memory;
+};
+
+struct HitSphereSoA
+{
+    float *center_x, *center_y, *center_z;
+    float *radius;
+    size_t count;
+    size_t capacity;
+    void *memory;
+};
+
+void HitBoxSoA_Init(HitBoxSoA *boxes);
+void HitBoxSoA_Free(HitBoxSoA *boxes);
+void HitBoxSoA_Resize(HitBoxSoA *boxes, size_t count); // Novas caixas ficam vazias
+void HitBoxSoA_Set(HitBoxSoA *boxes, size_t index, HitBox box);
+void HitBoxSoA_SetEmpty(HitBoxSoA *boxes, size_t index);
+void HitBoxSoA_Push(HitBoxSoA *boxes, HitBox box);
+
+void HitSphereSoA_Init(HitSphereSoA *spheres);
+void HitSphereSoA_Free(HitSphereSoA *spheres);
+void HitSphereSoA_Resize(HitSphereSoA *spheres, size_t count);
+void HitSphereSoA_Set(HitSphereSoA *spheres, size_t index, HitSphere sphere);
+void HitSphereSoA_Push(HitSphereSoA *spheres, HitSphere sphere);
+
+// Nmero de palavras de 64 bits das mscaras das funes abaixo
+inline size_t CollisionMask_Words(size_t count) { return (count + 63) / 64; }
+
+// Testam todas as caixas (ou esferas) da coleo contra a caixa "query". O
+// bit i de "mask" (palavra i / 64, bit i % 64) indica coliso com o corpo i;
+// "mask" deve ter CollisionMask_Words(count) palavras. Retornam o nmero de
+// colises. Equivalentes a SpaceshipAsteroidCollision() e
+// SpaceshipMoonCollision() aplicadas a cada corpo.
+size_t HitBox_OverlapBatch(const HitBoxSoA *boxes, HitBox query, uint64_t *mask);
+size_t HitSphere_OverlapBatch(const HitSphereSoA *spheres, HitBox query, uint64_t *mask);
+
+// Implementaes das funes *_OverlapBatch(). A melhor implementao
+// suportada pelo processador  escolhida automaticamente na primeira
+// chamada; CollisionKernels_Select() permite forar outra (ex: benchmarks).
+#define COLLISION_KERNELS_SCALAR 0
+#define COLLISION_KERNELS_SSE    1
+#define COLLISION_KERNELS_AVX2   2
+
+bool CollisionKernels_Supported(int kernels);
+bool CollisionKernels_Select(int kernels); // Retorna false se no suportada
+int CollisionKernels_Selected();
+const char *CollisionKernels_Name(int kernels);
+
+// Formato de um corpo do mundo de colises
+#define COLLISION_BOX    0
+#define COLLISION_SPHERE 1
+
+// Um corpo (caixa ou esfera) registrado em um CollisionWorld. Os campos
+// "kind" e "user_data" no so interpretados pelo mundo; servem para quem
+// trata a coliso identificar o objeto (ex: asteroide, moeda nmero 2).
+struct CollisionBody
+{
+    int shape;            // COLLISION_BOX ou COLLISION_SPHERE
+    HitBox box;           // Caixa do corpo (para esferas, a AABB da esfera)
+    HitSphere sphere;     // Esfera do corpo (somente se shape == COLLISION_SPHERE)
+    int kind;
+    int user_data;
+    bool active;          // false se o corpo foi removido
+    bool large;           // true se o corpo  grande demais para a grade
+    glm::ivec3 cell_min;  // Intervalo de clulas da grade ocupadas pelo corpo
+    glm::ivec3 cell_max;
+    uint32_t query_stamp; // Evita retornar o mesmo corpo mais de uma vez por consulta
+};
+
+// Mundo de colises: os corpos so armazenados em uma grade uniforme esparsa
+// (tabela hash de clulas cbicas), de modo que uma consulta examina somente
+// os corpos das clulas prximas  caixa consultada, e no todos os corpos.
+// Corpos que ocupam muitas clulas ficam em uma lista separada, testada em
+// todas as consultas.
+struct CollisionWorld
+{
+    float cell_size;
+    std::vector<CollisionBody> bodies;
+    std::vector<int> free_bodies; // ndices de "bodies" removidos, para reutilizao
+    std::unordered_map<uint64_t, std::vector<int> > cells;
+    std::vector<int> large_bodies;
+    uint32_t query_stamp;
+    HitBoxSoA grid_boxes;            // Caixas dos corpos da grade, indexadas pelo identificador (vazias para os demais)
+    std::vector<uint64_t> grid_mask; // Mscara de HitBox_OverlapBatch() sobre "grid_boxes"
+};
+
+// CollisionWorld_Init() deve ser chamada uma nica vez antes do uso, e
+// CollisionWorld_Free() libera a memria do mundo.
+void CollisionWorld_Init(CollisionWorld *world, float cell_size);
+void CollisionWorld_Clear(CollisionWorld *world);
+void CollisionWorld_Free(CollisionWorld *world);
+
+// Inserem um corpo no mundo, retornando seu identificador.
+int CollisionWorld_AddBox(CollisionWorld *world, HitBox box, int kind, int user_data);
+int CollisionWorld_AddSphere(CollisionWorld *world, HitSphere sphere, int kind, int user_data);
+
+// Remove ou move um corpo dinmico. O identificador de um corpo removido
+// pode ser reutilizado por inseres posteriores. Mover um corpo j
+// removido no tem efeito.
+void CollisionWorld_Remove(CollisionWorld *world, int body);
+void CollisionWorld_MoveBox(CollisionWorld *world, int body, HitBox box);
+void CollisionWorld_MoveSphere(CollisionWorld *world, int body, HitSphere sphere);
+
+// Fase ampla: adiciona em "candidates" os corpos cujas clulas da grade
+// intersectam a caixa "query". Alguns candidatos podem no colidir.
+void CollisionWorld_QueryCandidates(CollisionWorld *world, HitBox query, std::vector<int> *candidates);
+
+// Fase ampla seguida do teste exato: adiciona em "hits" somente os corpos
+// que colidem com a caixa "query". Retorna o nmero de colises.
+int CollisionWorld_Collide(CollisionWorld *world, HitBox query, std::vector<int> *hits);
+
 #endif
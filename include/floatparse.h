@@ -0,0 +1,25 @@
+#ifndef FLOATPARSE_H
+#define FLOATPARSE_H
+
+// Conversão de números decimais em texto para float, com arredondamento
+// correto (o float mais próximo do valor decimal, com empate para o par),
+// usada na leitura dos arquivos OBJ (veja "objloader.cpp").
+//
+// Os dígitos significativos são acumulados em um inteiro de 64 bits "w", e o
+// valor é w * 10^q. Casos simples (w < 2^24 e |q| <= 10) são resolvidos com
+// uma única multiplicação ou divisão em float, que é exata antes do
+// arredondamento. Os demais usam o algoritmo de Eisel-Lemire: w é
+// multiplicado por uma aproximação de 128 bits de 5^q, tabelada, e o
+// resultado já determina os 24 bits da mantissa e o expoente em base 2.
+// Números com mais de 19 dígitos significativos, em que "w" é truncado, são
+// convertidos pelo mesmo algoritmo com w e w + 1; se os resultados forem
+// diferentes, strtof() decide.
+
+// Converte o número no início de [begin, end) e o grava em "value".
+// Aceita a mesma sintaxe da leitura de tinyobj: sinal opcional, dígitos com
+// ponto decimal opcional (".5", "1." e "-.25e+2" são válidos) e expoente
+// opcional. Caracteres após o número são ignorados. Retorna false, sem
+// alterar "value", se não houver um número no início do texto.
+bool ParseFloat(const char *begin, const char *end, float *value);
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef GPUTIMER_H
+#define GPUTIMER_H
+
+#include "profiler.h"
+
+// Medição do tempo de GPU de cada passe de renderização (PROFILER_GPU_*) com
+// queries GL_TIME_ELAPSED. O resultado de uma query só fica disponível
+// quando a GPU termina o passe, alguns quadros depois do envio; esperar por
+// ele pararia a CPU até a GPU alcançá-la. Por isso cada quadro utiliza um
+// conjunto próprio de queries, em um anel de GPU_TIMER_FRAMES conjuntos, e
+// os resultados de um conjunto são lidos somente quando ele vai ser
+// reutilizado, se já estiverem disponíveis. Os tempos lidos são entregues a
+// Profiler_GpuFrame(), que os mostra no overlay e no arquivo de trace.
+
+// Número de quadros em andamento na GPU sem perda de resultados
+#define GPU_TIMER_FRAMES 3
+
+// Cria as queries. Deve ser chamada com o contexto OpenGL já criado; se o
+// driver não tiver o contador de tempo, as demais funções não fazem nada.
+void GpuTimer_Init();
+
+// Lê os resultados do conjunto de queries mais antigo, se disponíveis, e o
+// reutiliza para o quadro atual. Deve ser chamada uma vez por quadro, antes
+// de desenhar.
+void GpuTimer_BeginFrame();
+
+// Início e fim dos comandos do passe "pass" no quadro atual. Somente um passe
+// pode ser medido por vez (GL_TIME_ELAPSED não aninha): GpuTimer_Begin()
+// termina o passe anterior, se ainda aberto. Cada passe é medido no máximo
+// uma vez por quadro.
+void GpuTimer_Begin(int pass);
+void GpuTimer_End();
+
+// Espera a GPU terminar todos os quadros enviados e entrega os seus
+// resultados a Profiler_GpuFrame(), do mais antigo para o mais recente. Para
+// o benchmark, que precisa dos tempos de quadros exatos; no loop do jogo,
+// GpuTimer_BeginFrame() lê os resultados sem esperar.
+void GpuTimer_Flush();
+
+// Número de quadros cujos resultados ainda não estavam disponíveis quando o
+// seu conjunto de queries foi reutilizado, e portanto foram descartados
+unsigned long GpuTimer_DroppedFrames();
+
+#endif
@@ -0,0 +1,13 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+// Executa a simulação do jogo (veja "simulation.h") sem janela e sem contexto
+// OpenGL, com a entrada lida de um arquivo de roteiro:
+//
+//     main --headless <roteiro> [passos] [--quiet]
+//
+// Imprime o estado e o tempo de cada passo, seguidos de um resumo. Retorna o
+// código de saída do programa.
+int Headless_Run(int argc, char *argv[]);
+
+#endif
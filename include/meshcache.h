@@ -0,0 +1,98 @@
+#ifndef MESHCACHE_H
+#define MESHCACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Versão do formato dos arquivos ".mesh". Deve ser incrementada sempre que o
+// layout do cabeçalho, dos objetos ou dos vértices mudar, para que caches
+// antigos sejam descartados automaticamente.
+#define MESH_CACHE_VERSION 3
+
+// Atributos presentes na malha (campo "flags" de MeshView)
+#define MESH_HAS_NORMALS   0x1
+#define MESH_HAS_TEXCOORDS 0x2
+
+// Vértice quantizado, com todos os atributos intercalados (16 bytes):
+//   - posição com 16 bits por coeficiente, normalizada na AABB do objeto;
+//   - normal empacotada no formato GL_INT_2_10_10_10_REV;
+//   - coordenadas de textura como half floats.
+// Os coeficientes W da posição e da normal são reconstruídos em
+// "shader_vertex.glsl".
+struct MeshVertex
+{
+    uint16_t position[4];  // X, Y, Z em [0, 65535] dentro da AABB (o quarto valor não é utilizado)
+    uint32_t normal;       // X, Y, Z com 10 bits cada, com sinal
+    uint16_t texcoords[2]; // U, V em half float
+};
+
+// Um objeto ("shape") do arquivo OBJ. Cada objeto possui seus próprios
+// vértices (sem repetições) e índices relativos a "base_vertex", armazenados
+// com 16 bits sempre que o objeto tiver no máximo 65536 vértices.
+struct MeshShape
+{
+    char name[64];         // Nome do objeto (terminado em '\0')
+    uint32_t index_offset; // Deslocamento, em bytes, do primeiro índice dentro do buffer de índices
+    uint32_t num_indices;  // Número de índices do objeto
+    uint32_t index_size;   // Tamanho de cada índice em bytes (2 ou 4)
+    uint32_t base_vertex;  // Primeiro vértice do objeto dentro do buffer de vértices
+    uint32_t num_vertices; // Número de vértices únicos do objeto
+    float bbox_min[3];     // Axis-Aligned Bounding Box do objeto
+    float bbox_max[3];
+};
+
+// Malha construída na CPU, pronta para ser enviada para a GPU. Veja
+// BuildTriangles() em "scene.cpp".
+struct MeshData
+{
+    std::vector<MeshShape> shapes;
+    std::vector<MeshVertex> vertices;
+    std::vector<unsigned char> indices; // Índices de 16 ou 32 bits (veja MeshShape)
+    uint32_t flags = 0;
+};
+
+// Visão somente-leitura de uma malha, seja ela construída em memória
+// (MeshData) ou mapeada diretamente de um arquivo ".mesh".
+struct MeshView
+{
+    const MeshShape *shapes;
+    uint32_t num_shapes;
+    const MeshVertex *vertices;
+    uint32_t num_vertices;
+    const void *indices;
+    uint32_t index_bytes;
+    uint32_t flags;
+};
+
+// Arquivo ".mesh" mapeado em memória. Os ponteiros de "view" apontam para
+// dentro do mapeamento e são válidos até MeshCache_Close().
+struct MeshCacheFile
+{
+    void *mapping = NULL;
+    size_t size = 0;
+    MeshView view;
+};
+
+MeshView MeshData_View(const MeshData &mesh);
+
+// Nome do arquivo de cache correspondente a um ".obj" (mesmo diretório,
+// extensão ".mesh").
+std::string MeshCache_Filename(const char *obj_filename);
+
+// Abre o cache do modelo "obj_filename". Retorna false caso o cache não
+// exista, seja de outra versão, ou esteja desatualizado em relação ao OBJ.
+bool MeshCache_Open(const char *obj_filename, MeshCacheFile *file);
+void MeshCache_Close(MeshCacheFile *file);
+
+// Grava o cache do modelo "obj_filename" a partir da malha já construída.
+bool MeshCache_Write(const char *obj_filename, const MeshView &mesh);
+
+// Mapeia um arquivo inteiro em memória, somente para leitura. Retorna NULL
+// caso o arquivo não exista ou esteja vazio. Também utilizada pela leitura
+// dos arquivos OBJ (veja "objloader.cpp").
+void *MeshCache_MapFile(const char *filename, size_t *size);
+void MeshCache_UnmapFile(void *data, size_t size);
+
+#endif
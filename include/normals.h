@@ -0,0 +1,30 @@
+#ifndef NORMALS_H
+#define NORMALS_H
+
+#include <cstddef>
+
+// Cálculo das normais dos vértices de uma malha de triângulos pelo método
+// de Gouraud: a normal de cada vértice é a média, ponderada, das normais de
+// todas as faces que compartilham este vértice. Veja ComputeNormals() em
+// "scene.cpp". Não depende de OpenGL.
+
+// Peso da normal de cada face na média de um vértice
+#define NORMALS_WEIGHT_AREA  0 // Área do triângulo (produto vetorial sem normalizar)
+#define NORMALS_WEIGHT_ANGLE 1 // Ângulo do triângulo no vértice
+
+// Calcula as normais dos "num_vertices" vértices de "positions" (X, Y, Z),
+// a partir dos "num_triangles" triângulos de "triangles" (3 índices de
+// vértice por triângulo), e as grava em "normals" (X, Y, Z, normalizadas).
+// Vértices que não pertencem a nenhum triângulo (ou somente a triângulos
+// degenerados) recebem a normal nula.
+//
+// Os triângulos são divididos em intervalos contíguos, um por thread, e
+// cada thread acumula as normais das suas faces em um vetor próprio, sem
+// sincronização; em seguida os vetores parciais são somados, também em
+// paralelo, por intervalos de vértices. Com "num_threads" igual a 0 o número
+// de threads é escolhido pelo tamanho da malha e pelo número de núcleos da
+// máquina; com 1, tudo é feito na thread que chamou a função.
+void ComputeVertexNormals(const float *positions, size_t num_vertices, const int *triangles, size_t num_triangles,
+                          int weighting, float *normals, int num_threads = 0);
+
+#endif
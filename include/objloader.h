@@ -0,0 +1,38 @@
+#ifndef OBJLOADER_H
+#define OBJLOADER_H
+
+#include <string>
+#include <vector>
+
+#include <tiny_obj_loader.h>
+
+// Leitura de arquivos OBJ em paralelo, com o mesmo resultado de
+// tinyobj::LoadObj(), exceto pelos números: ParseFloat() (veja
+// "floatparse.h") arredonda corretamente, e a conversão de tinyobj pode
+// diferir do float mais próximo no último bit. O arquivo é mapeado em
+// memória e dividido em trechos que terminam em fim de linha, processados
+// por várias threads em três passos:
+//   1. cada trecho conta as suas linhas "v", "vn" e "vt", de modo que o
+//      índice global do primeiro vértice de cada trecho seja conhecido;
+//   2. cada trecho lê os seus números diretamente para a posição final em
+//      "attrib", e as suas faces e comandos ("o", "g", "usemtl", "s",
+//      "mtllib") para listas próprias. Índices relativos (negativos) das
+//      faces são resolvidos com os contadores globais do passo 1;
+//   3. os quadriláteros são divididos em triângulos, como em tinyobj, já com
+//      todas as posições lidas.
+// Por fim, as faces de todos os trechos são reunidas em objetos
+// ("shapes"), em ordem, repetindo os comandos de cada trecho.
+//
+// Arquivos com elementos que esta leitura não trata (linhas "l", "p", "t" ou
+// "vw", faces com menos de 3 vértices, ou com mais de 4 quando
+// "triangulate" é verdadeiro) são lidos por tinyobj::LoadObj().
+
+// Mesmos parâmetros e retorno de tinyobj::LoadObj(). Com "num_threads"
+// igual a 0, o número de threads é escolhido pelo tamanho do arquivo e pelo
+// número de núcleos da máquina.
+bool ObjLoader_Load(tinyobj::attrib_t *attrib, std::vector<tinyobj::shape_t> *shapes,
+                    std::vector<tinyobj::material_t> *materials, std::string *warn, std::string *err,
+                    const char *filename, const char *basepath = NULL, bool triangulate = true,
+                    int num_threads = 0);
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+// Medição do tempo de CPU gasto em cada estágio dos quadros. Trechos de
+// código são marcados com PROFILE_SCOPE(estágio), e Profiler_BeginFrame()
+// separa os quadros. A soma dos tempos de cada estágio nos últimos
+// PROFILER_HISTORY quadros dá a média e o percentil 99 mostrados na tela
+// (tecla P, veja ShowProfilerOverlay() em "main.cpp"). Profiler_CaptureTrace()
+// grava os próximos quadros em um arquivo JSON no formato "Trace Event" do
+// Chrome, que pode ser aberto em chrome://tracing ou https://ui.perfetto.dev .
+// Não depende de OpenGL; somente a thread principal é medida. Os tempos de
+// GPU de cada passe de renderização são medidos em "gputimer.cpp" e
+// entregues ao profiler com Profiler_GpuFrame().
+
+// Estágios medidos
+#define PROFILER_INPUT      0 // Eventos da janela e estado das teclas
+#define PROFILER_SIMULATION 1 // Passos da simulação, incluindo PROFILER_COLLISION
+#define PROFILER_COLLISION  2 // Testes de colisão da nave em cada passo
+#define PROFILER_SCENE      3 // Scene_Draw(): envio dos objetos e comandos para a GPU
+#define PROFILER_TEXT       4 // Texto informativo e overlay do profiler
+#define PROFILER_SWAP       5 // glfwSwapBuffers(): espera pela apresentação do quadro
+#define PROFILER_NUM_STAGES 6
+
+// Passes de renderização medidos na GPU, na ordem em que são desenhados
+#define PROFILER_GPU_WORLD      0 // Asteroides, moedas e lua
+#define PROFILER_GPU_SHIP       1 // Nave
+#define PROFILER_GPU_SKYBOX     2 // Esfera do céu, vista por dentro
+#define PROFILER_GPU_HUD        3 // Texto informativo e overlay do profiler
+#define PROFILER_GPU_NUM_PASSES 4
+
+// Número de quadros utilizados nas médias e no percentil 99
+#define PROFILER_HISTORY 240
+
+// Estatísticas de um estágio (ou do quadro inteiro) nos últimos quadros, em
+// milissegundos
+struct ProfilerStats
+{
+    double average;
+    double p99;
+    double last;
+};
+
+// Nome de um estágio, utilizado na tela e no arquivo de trace
+const char *Profiler_StageName(int stage);
+
+// Termina o quadro atual e começa o próximo. Deve ser chamada uma vez por
+// quadro, no início do loop de renderização.
+void Profiler_BeginFrame();
+
+// Início e fim de um trecho do estágio "stage". Um estágio pode ser medido
+// várias vezes no mesmo quadro (os tempos são somados), mas não dentro de
+// si mesmo. Prefira PROFILE_SCOPE().
+void Profiler_Begin(int stage);
+void Profiler_End(int stage);
+
+// Estatísticas do estágio "stage" nos quadros já terminados. Retorna false
+// se nenhum quadro foi medido ainda.
+bool Profiler_StageStats(int stage, ProfilerStats *stats);
+
+// Estatísticas do tempo total dos quadros
+bool Profiler_FrameStats(ProfilerStats *stats);
+
+// Nome de um passe de GPU
+const char *Profiler_GpuPassName(int pass);
+
+// Adiciona os tempos de GPU de um quadro já terminado: a duração de cada
+// passe, em milissegundos, e o instante em que cada passe foi enviado, em
+// microssegundos (veja Profiler_Time()). Os resultados chegam alguns quadros
+// depois do envio, portanto não são associados a um quadro da CPU.
+void Profiler_GpuFrame(const double *pass_ms, const double *submit_us);
+
+// Estatísticas de um passe de GPU, ou do total de todos com "pass" igual a
+// PROFILER_GPU_NUM_PASSES. Retorna false se nenhum quadro foi medido ainda.
+bool Profiler_GpuPassStats(int pass, ProfilerStats *stats);
+
+// Descarta o histórico de CPU e de GPU, por exemplo após quadros de aquecimento
+void Profiler_ClearHistory();
+
+// Instante atual, em microssegundos, na escala de tempo do arquivo de trace
+double Profiler_Time();
+
+// Grava os próximos "num_frames" quadros no arquivo "filename", no formato
+// "Trace Event" do Chrome. O arquivo é escrito ao final do último quadro.
+void Profiler_CaptureTrace(const char *filename, int num_frames);
+
+// Retorna true enquanto uma captura estiver em andamento
+bool Profiler_Capturing();
+
+// Mede o trecho entre a sua criação e o fim do escopo
+struct ProfilerScope
+{
+    int stage;
+    ProfilerScope(int stage) : stage(stage) { Profiler_Begin(stage); }
+    ~ProfilerScope() { Profiler_End(stage); }
+};
+
+#define PROFILE_SCOPE(stage) ProfilerScope profiler_scope_##stage(stage)
+
+#endif
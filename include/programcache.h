@@ -0,0 +1,37 @@
+#ifndef PROGRAMCACHE_H
+#define PROGRAMCACHE_H
+
+#include <cstdint>
+#include <string>
+
+#include <glad/glad.h>
+
+// Cache em disco de programas de GPU já compilados e linkados, lidos e
+// gravados com glGetProgramBinary()/glProgramBinary() (extensão
+// GL_ARB_get_program_binary). Cada arquivo guarda a chave de
+// ProgramCache_Key(); se o código dos shaders, o driver ou a placa de vídeo
+// mudarem, a chave muda e o arquivo é ignorado e sobrescrito.
+
+// Versão do formato dos arquivos de cache. Deve ser incrementada sempre que
+// o cabeçalho mudar.
+#define PROGRAM_CACHE_VERSION 1
+
+// Retorna true se o driver consegue devolver o binário de programas. Deve
+// ser chamada com o contexto OpenGL já criado.
+bool ProgramCache_Supported();
+
+// Chave de um programa: hash FNV-1a do código dos dois shaders (já com os
+// "#define" das variantes) e das strings GL_VENDOR, GL_RENDERER e
+// GL_VERSION.
+uint64_t ProgramCache_Key(const std::string &vertex_source, const std::string &fragment_source);
+
+// Cria um programa a partir do binário gravado em "filename". Retorna 0 se o
+// arquivo não existir, tiver outra chave ou for recusado pelo driver.
+GLuint ProgramCache_Load(const char *filename, uint64_t key);
+
+// Grava o binário de um programa linkado com sucesso. O programa deve ter
+// sido linkado com GL_PROGRAM_BINARY_RETRIEVABLE_HINT. Retorna false em caso
+// de erro.
+bool ProgramCache_Store(const char *filename, uint64_t key, GLuint program_id);
+
+#endif
@@ -0,0 +1,184 @@
+#ifndef SCENE_H
+#define SCENE_H
+
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#include <glad/glad.h>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+#include <tiny_obj_loader.h>
+
+#include "meshcache.h"
+#include "normals.h"
+#include "objloader.h"
+#include "simulation.h"
+
+// Cena virtual do jogo: carregamento de shaders, texturas e modelos, e o
+// desenho de um quadro completo. Não depende de GLFW; o contexto OpenGL é
+// criado pelo chamador, seja a janela do jogo (veja "main.cpp") ou um
+// framebuffer sem janela (veja "bench_render.cpp").
+
+// Estrutura que representa um modelo geométrico carregado a partir de um
+// arquivo ".obj". Veja https://en.wikipedia.org/wiki/Wavefront_.obj_file .
+struct ObjModel
+{
+    tinyobj::attrib_t attrib;
+    std::vector<tinyobj::shape_t> shapes;
+    std::vector<tinyobj::material_t> materials;
+
+    // Este construtor lê o modelo de um arquivo utilizando a biblioteca tinyobjloader.
+    // Veja: https://github.com/syoyo/tinyobjloader
+    // "num_threads" é repassado para ObjLoader_Load().
+    ObjModel(const char *filename, const char *basepath = NULL, bool triangulate = true, int num_threads = 0)
+    {
+        printf("Carregando objetos do arquivo \"%s\"...\n", filename);
+
+        // Se basepath == NULL, então setamos basepath como o dirname do
+        // filename, para que os arquivos MTL sejam corretamente carregados caso
+        // estejam no mesmo diretório dos arquivos OBJ.
+        std::string fullpath(filename);
+        std::string dirname;
+        if (basepath == NULL)
+        {
+            auto i = fullpath.find_last_of("/");
+            if (i != std::string::npos)
+            {
+                dirname = fullpath.substr(0, i + 1);
+                basepath = dirname.c_str();
+            }
+        }
+
+        std::string warn;
+        std::string err;
+        bool ret = ObjLoader_Load(&attrib, &shapes, &materials, &warn, &err, filename, basepath, triangulate, num_threads);
+
+        if (!err.empty())
+            fprintf(stderr, "\n%s\n", err.c_str());
+
+        if (!ret)
+            throw std::runtime_error("Erro ao carregar modelo.");
+
+        for (size_t shape = 0; shape < shapes.size(); ++shape)
+        {
+            if (shapes[shape].name.empty())
+            {
+                fprintf(stderr,
+                        "*********************************************\n"
+                        "Erro: Objeto sem nome dentro do arquivo '%s'.\n"
+                        "Veja https://www.inf.ufrgs.br/~eslgastal/fcg-faq-etc.html#Modelos-3D-no-formato-OBJ .\n"
+                        "*********************************************\n",
+                        filename);
+                throw std::runtime_error("Objeto sem nome.");
+            }
+            printf("- Objeto '%s'\n", shapes[shape].name.c_str());
+        }
+
+        printf("OK.\n");
+    }
+};
+
+// Definimos uma estrutura que armazenará dados necessários para renderizar
+// cada objeto da cena virtual.
+struct SceneObject
+{
+    std::string name;              // Nome do objeto
+    size_t index_offset;           // Deslocamento, em bytes, do primeiro índice dentro do buffer de índices. Veja BuildTriangles() e AddMeshToVirtualScene()
+    size_t num_indices;            // Número de índices do objeto dentro do buffer de índices
+    GLenum index_type;             // Tipo dos índices (GL_UNSIGNED_SHORT ou GL_UNSIGNED_INT)
+    GLint base_vertex;             // Vértice somado a todos os índices do objeto
+    GLenum rendering_mode;         // Modo de rasterização (GL_TRIANGLES, GL_TRIANGLE_STRIP, etc.)
+    GLuint vertex_array_object_id; // ID do VAO onde estão armazenados os atributos do modelo
+    glm::vec3 bbox_min;            // Axis-Aligned Bounding Box do objeto
+    glm::vec3 bbox_max;
+};
+
+// Câmera utilizada por Scene_Draw()
+struct SceneCamera
+{
+    float theta;        // Ângulo no plano ZX em relação ao eixo Z
+    float phi;          // Ângulo em relação ao eixo Y
+    bool first_person;  // Câmera livre (true) ou look-at na direção da nave (false)
+    float screen_ratio; // Razão de proporção do framebuffer (largura/altura)
+};
+
+// A cena virtual é uma lista contígua de objetos, indexada pelo identificador
+// inteiro retornado por AddMeshToVirtualScene(). Veja "scene.cpp".
+extern std::vector<SceneObject> g_VirtualScene;
+extern std::map<std::string, int> g_VirtualSceneIds; // Nome -> identificador
+
+// Identificadores dos objetos desenhados pelo jogo, ou -1 enquanto o seu
+// modelo não tiver sido carregado. Veja Scene_Init().
+extern int g_SpaceshipObject;
+extern int g_SphereObject;
+extern int g_MoonObject;
+extern int g_AsteroidObject;
+extern int g_CoinObject;
+
+// Contadores de desempenho de DrawVirtualObject(), zerados pelo chamador
+extern unsigned long g_DrawCalls;
+extern unsigned long g_DrawTriangles;
+extern double g_DrawCpuSeconds;
+
+// Programas de GPU (shaders), um para cada material. Veja LoadShadersFromFiles().
+#define SCENE_NUM_MATERIALS 5
+extern GLuint g_GpuProgramIDs[SCENE_NUM_MATERIALS];
+
+// Tempo máximo, por quadro, gasto por Scene_Draw() enviando para a GPU os
+// recursos carregados em segundo plano. Veja UploadLoadedAssets().
+#define SCENE_UPLOAD_BUDGET_SECONDS 0.002
+
+// Campo de asteroides. Veja LoadAsteroids().
+extern std::vector<glm::mat4> g_AsteroidInstances;
+
+// Começa a carregar os shaders, as texturas e os modelos do jogo, listados
+// em "data/assets.txt", e os modelos OBJ "extra_models", e configura o
+// Z-buffer e o backface culling. Retorna assim que os recursos essenciais
+// estiverem na GPU; os demais são enviados por Scene_Draw(), e os objetos
+// desenhados pelo jogo (g_SpaceshipObject etc.) valem -1 até lá. Deve ser
+// chamada com o contexto OpenGL já criado.
+void Scene_Init(const std::vector<std::string> &extra_models = std::vector<std::string>());
+
+// Desenha um quadro completo do jogo no framebuffer atual para o estado
+// "state" da simulação. "time" é o tempo, em segundos, que controla a
+// rotação das moedas.
+void Scene_Draw(const SimulationState &state, const SceneCamera &camera, float time);
+
+// Adiciona um objeto de g_VirtualScene à lista de desenho do quadro, que é
+// desenhada de uma só vez por DrawQueuedObjects() ao final de Scene_Draw().
+// "material" é o valor de "object_id" em "shader_fragment.glsl".
+void QueueVirtualObject(int object_id, const glm::mat4 &model, int material,
+                        GLsizei num_instances = 1, GLenum cull_face = GL_BACK);
+
+// Desenha os modelos das moedas e asteroides
+void LoadCoins(const SimulationState &state, float time);
+void LoadAsteroids(int num_extra_asteroids);
+void DrawAsteroidField();
+
+void BuildTriangles(ObjModel *model, MeshData *mesh);                        // Constrói a malha de triângulos de um ObjModel na CPU
+int AddMeshToVirtualScene(const MeshView &mesh);                             // Envia uma malha para a GPU e a adiciona em g_VirtualScene
+int FindVirtualObject(const char *object_name);                              // Busca o identificador de um objeto de g_VirtualScene pelo nome
+void ComputeNormals(ObjModel *model, int weighting = NORMALS_WEIGHT_AREA, int num_threads = 0); // Computa normais de um ObjModel, caso não existam.
+void LoadShadersFromFiles();                                                 // Recarrega os shaders de vértice e fragmento dos arquivos e recria os programas
+void CreateGpuPrograms();                                                    // Cria um programa de GPU por material a partir do código dos shaders
+void UploadLoadedAssets(bool wait, double budget_seconds = SCENE_UPLOAD_BUDGET_SECONDS); // Envia para a GPU os recursos já carregados por Scene_Init()
+GLuint CreateTexture(GLuint textureunit);                                    // Cria uma textura vazia e o seu sampler
+void DrawVirtualObject(int object_id, GLsizei num_instances = 1);            // Desenha um objeto armazenado em g_VirtualScene
+void CreateUniformBuffers();                                                 // Cria os buffers dos blocos de uniformes dos shaders
+void DrawQueuedObjects();                                                    // Desenha os objetos adicionados por QueueVirtualObject()
+std::string LoadShaderSource(const char *filename, const char *defines = "");    // Lê o código de um shader, inserindo "defines"
+std::string InsertShaderDefines(const std::string &source, const char *defines); // Insere "defines" após a diretiva "#version"
+void CompileShader(GLuint shader_id, const std::string &str, const char *filename); // Compila o código de um shader
+
+// Cria um programa de GPU. Se "cache_filename" não for NULL, o programa
+// linkado é gravado no cache em disco com a chave "cache_key" (veja
+// "programcache.h").
+GLuint CreateGpuProgram(GLuint vertex_shader_id, GLuint fragment_shader_id,
+                        const char *cache_filename = NULL, uint64_t cache_key = 0);
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <vector>
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include "collisions.h"
+
+// Lógica do jogo (movimento da nave, asteroide da curva de Bezier, coleta de
+// moedas e colisões), executada em passos de tempo fixos, independentes da
+// taxa de quadros da renderização. Não depende de GLFW nem de OpenGL.
+
+// Frequência da simulação, em passos por segundo
+#define SIMULATION_TICK_RATE 120
+
+// Número máximo de passos executados por quadro. Se a renderização atrasar
+// mais do que isso, o tempo excedente é descartado e o jogo fica mais lento,
+// em vez de travar tentando alcançar o tempo real.
+#define SIMULATION_MAX_TICKS_PER_FRAME 8
+
+#define SIMULATION_NUM_COINS 3
+
+// Escala do modelo do asteroide que percorre a curva de Bezier
+static const glm::vec3 SIMULATION_BEZIER_SCALE = glm::vec3(4.6f, 6.4f, 7.0f);
+
+// Entrada do usuário amostrada pelo loop principal a cada quadro
+struct SimulationInput
+{
+    bool forward;       // Tecla W
+    bool left;          // Tecla A
+    bool backward;      // Tecla S
+    bool right;         // Tecla D
+    bool roll;          // Tecla Z
+    bool reset_roll;    // Tecla espaço (zera a rotação da nave)
+    float camera_theta; // Ângulos da câmera, que definem a direção de movimento
+    float camera_phi;
+};
+
+// Estado do jogo em um instante da simulação
+struct SimulationState
+{
+    unsigned long tick;                      // Número de passos executados
+    double time;                             // Tempo simulado, em segundos
+    glm::vec4 displacement;                  // Deslocamento da nave em relação ao início
+    float angle_z;                           // Rotação da nave em torno do eixo Z
+    bool coin_visible[SIMULATION_NUM_COINS]; // false se a moeda já foi coletada
+    double bezier_start;                     // Início da passagem atual do asteroide (negativo se ainda não iniciada)
+    bool bezier_visible;                     // true se o asteroide está na curva
+    glm::vec4 bezier_position;               // Posição do asteroide na curva
+    unsigned int crashes;                    // Número de colisões que reiniciaram o jogo
+};
+
+struct Simulation
+{
+    SimulationState previous; // Estado do passo anterior, para interpolação
+    SimulationState current;
+    double accumulator;       // Tempo real ainda não simulado, em segundos
+    float universe_limit;     // Limite que a nave pode andar em qualquer uma das direções
+
+    CollisionWorld world;
+    int bezier_body;          // Corpo do asteroide da curva no mundo de colisões (-1 se inativo)
+    glm::vec3 asteroid_bbox_min; // AABB do modelo do asteroide, para a HitBox do asteroide da curva
+    glm::vec3 asteroid_bbox_max;
+    std::vector<int> collisions;
+};
+
+// Inicializa a simulação e registra as HitBoxes do nível. "asteroid_bbox_*" é
+// a AABB do modelo "Asteroid" em coordenadas locais.
+void Simulation_Init(Simulation *sim, glm::vec3 asteroid_bbox_min, glm::vec3 asteroid_bbox_max);
+void Simulation_Free(Simulation *sim);
+
+// Executa um único passo de 1/SIMULATION_TICK_RATE segundos.
+void Simulation_Tick(Simulation *sim, const SimulationInput &input);
+
+// Acumula "frame_seconds" de tempo real e executa quantos passos couberem,
+// até SIMULATION_MAX_TICKS_PER_FRAME. Após uma colisão, os passos seguintes
+// usam os ângulos da câmera zerados, como o loop principal fará. Retorna o
+// número de passos executados.
+int Simulation_Advance(Simulation *sim, double frame_seconds, const SimulationInput &input);
+
+// Estado para renderização, interpolado entre os dois últimos passos conforme
+// o tempo acumulado que ainda não foi simulado.
+SimulationState Simulation_Interpolate(const Simulation *sim);
+
+// HitBox da nave para um dado deslocamento
+HitBox Simulation_SpaceshipHitBox(glm::vec4 displacement);
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef TEXTRENDERING_H
+#define TEXTRENDERING_H
+
+#include <string>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+
+// Renderização de texto com a fonte embutida em "dejavufont.h". Veja
+// "textrendering.cpp".
+
+// Vértice de um caractere: posição em NDC e coordenadas de textura
+struct TextVertex
+{
+    float x, y, s, t;
+};
+
+// Busca dos glifos da fonte em TextRendering_LayoutString()
+#define TEXT_LOOKUP_TABLE  0 // Tabela indexada pelo codepoint
+#define TEXT_LOOKUP_LINEAR 1 // Busca linear na lista de glifos da fonte, como antes da tabela (para comparação)
+
+// Número de chamadas de desenho feitas por TextRendering_Flush()
+extern unsigned long g_TextDrawCalls;
+
+void TextRendering_Init();
+
+// Constrói as tabelas de busca de glifos. Chamada por TextRendering_Init();
+// não depende de OpenGL.
+void TextRendering_BuildGlyphTable();
+
+// Métricas da janela utilizadas no posicionamento do texto. Atualizadas a
+// cada redimensionamento da janela (veja FramebufferSizeCallback() em
+// "main.cpp"), para que as funções de texto não consultem a janela a cada
+// chamada.
+struct TextLayout
+{
+    int width, height; // Tamanho da janela, em pixels
+    float scale;       // Escala global do texto
+    float sx, sy;      // Conversão de pixels da fonte para NDC
+    float line_height; // Altura de uma linha de texto, em NDC
+    float char_width;  // Largura de um caractere, em NDC
+};
+
+extern TextLayout g_TextLayout;
+
+// Calcula as métricas de texto para uma janela de "width" x "height" pixels.
+// Não depende de OpenGL nem de GLFW.
+TextLayout TextLayout_Create(int width, int height, float scale);
+
+// Atualiza g_TextLayout para o novo tamanho da janela
+void TextRendering_SetWindowSize(int width, int height);
+
+// Gera os vértices dos caracteres de "str" (em UTF-8) a partir do ponto
+// (x, y) em NDC, com as métricas de "layout" multiplicadas por "scale".
+// Retorna a coordenada X após o último caractere.
+float TextRendering_LayoutString(const TextLayout &layout, const std::string &str, float x, float y, float scale,
+                                 std::vector<TextVertex> *vertices, int lookup = TEXT_LOOKUP_TABLE);
+
+// Funções que adicionam texto ao lote do quadro, desenhado de uma só vez
+// por TextRendering_Flush()
+void TextRendering_PrintString(const std::string &str, float x, float y, float scale = 1.0f);
+void TextRendering_PrintMatrix(glm::mat4 M, float x, float y, float scale = 1.0f);
+void TextRendering_PrintVector(glm::vec4 v, float x, float y, float scale = 1.0f);
+void TextRendering_PrintMatrixVectorProduct(glm::mat4 M, glm::vec4 v, float x, float y, float scale = 1.0f);
+void TextRendering_PrintMatrixVectorProductMoreDigits(glm::mat4 M, glm::vec4 v, float x, float y, float scale = 1.0f);
+void TextRendering_PrintMatrixVectorProductDivW(glm::mat4 M, glm::vec4 v, float x, float y, float scale = 1.0f);
+float TextRendering_LineHeight();
+float TextRendering_CharWidth();
+void TextRendering_Flush();
+
+#endif
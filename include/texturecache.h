@@ -0,0 +1,58 @@
+#ifndef TEXTURECACHE_H
+#define TEXTURECACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Texturas pré-processadas em arquivos ".tex", gravados ao lado da imagem de
+// origem na primeira vez em que ela é carregada (como os arquivos ".mesh" de
+// "meshcache.h"). Cada arquivo guarda todos os níveis de mipmap já prontos,
+// comprimidos no formato BC1 (S3TC DXT1) quando a placa de vídeo o suporta.
+// Nas execuções seguintes a imagem não é decodificada, os mipmaps não são
+// gerados pelo driver, e cada textura ocupa 0.5 byte por pixel na GPU, em vez
+// dos 3 ou 4 bytes de GL_SRGB8. Não depende de OpenGL.
+
+// Versão do formato dos arquivos ".tex". Deve ser incrementada sempre que o
+// cabeçalho, a geração dos mipmaps ou o compressor mudarem.
+#define TEXTURE_CACHE_VERSION 1
+
+// Formato dos níveis de uma textura (campo "format" de TextureData)
+#define TEXTURE_FORMAT_RGB8 0 // 3 bytes por pixel, sem compressão (placas sem S3TC)
+#define TEXTURE_FORMAT_BC1  1 // Blocos de 4x4 pixels com 8 bytes cada
+
+// Textura com todos os seus níveis de mipmap, sempre com cores em sRGB
+struct TextureData
+{
+    uint32_t format = TEXTURE_FORMAT_RGB8;
+    uint32_t width = 0; // Tamanho do nível 0, em pixels
+    uint32_t height = 0;
+    uint32_t num_levels = 0;
+    std::vector<unsigned char> data; // Todos os níveis em sequência, a partir do nível 0
+};
+
+// Tamanho, em pixels, de uma dimensão do nível "level"
+uint32_t TextureData_LevelDimension(uint32_t size, uint32_t level);
+
+// Tamanho, em bytes, de um nível de "width" x "height" pixels
+size_t TextureData_LevelSize(uint32_t format, uint32_t width, uint32_t height);
+
+// Constrói todos os níveis de mipmap de uma imagem RGB de "width" x "height"
+// pixels no formato "format". Cada nível é a média de blocos de 2x2 pixels
+// do anterior, calculada em espaço linear.
+void TextureData_Build(const unsigned char *pixels, int width, int height, uint32_t format, TextureData *texture);
+
+// Nome do arquivo pré-processado correspondente a uma imagem (mesmo
+// diretório, extensão ".tex").
+std::string TextureCache_Filename(const char *image_filename);
+
+// Lê a textura pré-processada da imagem "image_filename". Retorna false caso
+// o arquivo não exista, seja de outra versão ou de outro formato, ou esteja
+// desatualizado em relação à imagem.
+bool TextureCache_Read(const char *image_filename, uint32_t format, TextureData *texture);
+
+// Grava a textura pré-processada da imagem "image_filename"
+bool TextureCache_Write(const char *image_filename, const TextureData &texture);
+
+#endif
@@ -0,0 +1,307 @@
+#include "assetmanager.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#include <stb_image.h>
+
+// ObjModel, ComputeNormals() e BuildTriangles(): somente trabalho de CPU
+#include "scene.h"
+
+// Lê a malha de um modelo do cache ".mesh", se válido, ou a constrói a
+// partir do OBJ, computando as normais e gravando o cache para as próximas
+// execuções. A leitura do OBJ e as normais usam até "num_threads" threads.
+static void LoadMesh(Asset *asset, int num_threads)
+{
+    asset->from_cache = MeshCache_Open(asset->filename.c_str(), &asset->cache);
+    if (asset->from_cache)
+        return;
+
+    try
+    {
+        ObjModel model(asset->filename.c_str(), NULL, true, num_threads);
+        ComputeNormals(&model, NORMALS_WEIGHT_AREA, num_threads);
+        BuildTriangles(&model, &asset->mesh);
+    }
+    catch (const std::exception &)
+    {
+        asset->failed = true;
+        return;
+    }
+
+    MeshCache_Write(asset->filename.c_str(), MeshData_View(asset->mesh));
+}
+
+// Lê a textura do arquivo ".tex" ou, se ele não existir ou estiver
+// desatualizado, decodifica a imagem, constrói os mipmaps e grava o ".tex".
+static void LoadTexture(Asset *asset, uint32_t format)
+{
+    asset->from_cache = TextureCache_Read(asset->filename.c_str(), format, &asset->texture);
+    if (!asset->from_cache)
+    {
+        int width;
+        int height;
+        int channels;
+        unsigned char *pixels = stbi_load(asset->filename.c_str(), &width, &height, &channels, 3);
+        if (pixels != NULL)
+        {
+            TextureData_Build(pixels, width, height, format, &asset->texture);
+            stbi_image_free(pixels);
+            TextureCache_Write(asset->filename.c_str(), asset->texture);
+        }
+    }
+
+    asset->failed = asset->texture.data.empty();
+}
+
+// Lê o código de um shader. A compilação é feita pela thread do OpenGL.
+static void LoadShaderText(Asset *asset)
+{
+    FILE *f = fopen(asset->filename.c_str(), "rb");
+    if (f == NULL)
+    {
+        asset->failed = true;
+        return;
+    }
+
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0)
+        asset->source.append(buffer, n);
+    asset->failed = ferror(f) != 0;
+    fclose(f);
+}
+
+// Laço de cada thread: pega o próximo recurso ainda não carregado até que
+// não reste nenhum. Os recursos são independentes, portanto basta um
+// contador atômico para distribuí-los entre as threads; como "queue" começa
+// pelos essenciais, eles são os primeiros a ficar prontos.
+static void LoadAssets(AssetManager *manager)
+{
+    for (;;)
+    {
+        size_t i = manager->next_asset.fetch_add(1);
+        if (i >= manager->queue.size())
+            return;
+
+        Asset *asset = manager->queue[i];
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        if (asset->type == ASSET_MESH)
+            LoadMesh(asset, manager->threads_per_asset);
+        else if (asset->type == ASSET_TEXTURE)
+            LoadTexture(asset, manager->texture_format);
+        else
+            LoadShaderText(asset);
+
+        asset->load_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        // "release" garante que a thread do OpenGL veja os dados escritos
+        // acima ao ler o novo estado
+        asset->state.store(ASSET_LOADED, std::memory_order_release);
+    }
+}
+
+bool AssetManager_ReadManifest(AssetManager *manager, const char *filename)
+{
+    FILE *f = fopen(filename, "r");
+    if (f == NULL)
+    {
+        fprintf(stderr, "ERROR: Cannot open asset manifest \"%s\".\n", filename);
+        return false;
+    }
+
+    // Os caminhos do manifesto são relativos ao seu diretório
+    std::string dirname(filename);
+    size_t slash = dirname.find_last_of("/");
+    dirname = (slash != std::string::npos) ? dirname.substr(0, slash + 1) : std::string();
+
+    char line[512];
+    int line_number = 0;
+    while (fgets(line, sizeof(line), f) != NULL)
+    {
+        ++line_number;
+        char *comment = strchr(line, '#');
+        if (comment != NULL)
+            *comment = '\0';
+
+        char type[16], name[64], path[256], flag[16];
+        int n = sscanf(line, "%15s %63s %255s %15s", type, name, path, flag);
+        if (n <= 0)
+            continue; // Linha vazia
+
+        int asset_type = -1;
+        if (strcmp(type, "mesh") == 0)
+            asset_type = ASSET_MESH;
+        else if (strcmp(type, "texture") == 0)
+            asset_type = ASSET_TEXTURE;
+        else if (strcmp(type, "shader") == 0)
+            asset_type = ASSET_SHADER;
+
+        if (n < 3 || asset_type < 0 || (n == 4 && strcmp(flag, "essential") != 0)
+            || AssetManager_Find(manager, name) != NULL)
+        {
+            fprintf(stderr, "ERROR: Invalid asset manifest line %d in \"%s\".\n", line_number, filename);
+            fclose(f);
+            return false;
+        }
+
+        AssetManager_Add(manager, asset_type, name, (dirname + path).c_str(), n == 4);
+    }
+
+    fclose(f);
+    return true;
+}
+
+Asset *AssetManager_Add(AssetManager *manager, int type, const char *name, const char *filename, bool essential)
+{
+    Asset *asset = new Asset;
+    asset->type = type;
+    asset->name = name;
+    asset->filename = filename;
+    asset->essential = essential;
+    asset->from_cache = false;
+    asset->failed = false;
+    asset->load_seconds = 0.0;
+    asset->object_id = -1;
+    asset->texture_unit = 0;
+    asset->texture_id = 0;
+    asset->on_ready = NULL;
+    asset->user = NULL;
+    asset->state.store(ASSET_PENDING);
+    manager->assets.push_back(asset);
+    return asset;
+}
+
+Asset *AssetManager_Find(const AssetManager *manager, const char *name)
+{
+    for (size_t i = 0; i < manager->assets.size(); ++i)
+        if (manager->assets[i]->name == name)
+            return manager->assets[i];
+    return NULL;
+}
+
+bool AssetManager_OnReady(AssetManager *manager, const char *name, AssetCallback callback, void *user)
+{
+    Asset *asset = AssetManager_Find(manager, name);
+    if (asset == NULL)
+        return false;
+
+    asset->on_ready = callback;
+    asset->user = user;
+
+    // O estado só muda para ASSET_READY nesta mesma thread
+    if (asset->state.load(std::memory_order_relaxed) == ASSET_READY && !asset->failed)
+        callback(asset, user);
+    return true;
+}
+
+void AssetManager_Start(AssetManager *manager, uint32_t texture_format, int num_threads)
+{
+    manager->queue.clear();
+    for (int essential = 1; essential >= 0; --essential)
+        for (size_t i = 0; i < manager->assets.size(); ++i)
+            if (manager->assets[i]->essential == (essential != 0))
+                manager->queue.push_back(manager->assets[i]);
+
+    manager->next_asset.store(0);
+    manager->texture_format = texture_format;
+    manager->start = std::chrono::steady_clock::now();
+
+    if (num_threads <= 0)
+        num_threads = (int)std::thread::hardware_concurrency();
+    if (num_threads > (int)manager->queue.size())
+        num_threads = (int)manager->queue.size();
+    if (num_threads < 1)
+        num_threads = 1;
+
+    // Cada thread já carrega um recurso em paralelo com as demais; as
+    // threads criadas pela leitura de um OBJ dividem somente os núcleos que
+    // sobram, para não criar N threads em cada uma das N threads
+    int num_cores = std::max(1, (int)std::thread::hardware_concurrency());
+    manager->threads_per_asset = std::max(1, num_cores / num_threads);
+
+    // A opção de inverter as imagens é global em stb_image; é definida antes
+    // de criar as threads, que somente a leem.
+    stbi_set_flip_vertically_on_load(true);
+
+    for (int t = 0; t < num_threads; ++t)
+        manager->threads.push_back(std::thread(LoadAssets, manager));
+}
+
+Asset *AssetManager_Take(AssetManager *manager, bool wait)
+{
+    for (;;)
+    {
+        bool pending = false;
+        for (size_t i = 0; i < manager->queue.size(); ++i)
+        {
+            Asset *asset = manager->queue[i];
+            int state = asset->state.load(std::memory_order_acquire);
+            if (state == ASSET_LOADED)
+            {
+                asset->state.store(ASSET_TAKEN, std::memory_order_relaxed);
+                return asset;
+            }
+            if (state == ASSET_PENDING)
+                pending = true;
+        }
+
+        if (!wait || !pending)
+            return NULL;
+
+        // Poucos recursos, e somente durante o carregamento: esperar em
+        // intervalos curtos é suficiente
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+// Libera a memória de CPU de um recurso. clear() não devolve a memória dos
+// vetores; a troca com um vetor vazio devolve.
+static void FreeAssetData(Asset *asset)
+{
+    MeshCache_Close(&asset->cache);
+    std::vector<MeshShape>().swap(asset->mesh.shapes);
+    std::vector<MeshVertex>().swap(asset->mesh.vertices);
+    std::vector<unsigned char>().swap(asset->mesh.indices);
+    std::vector<unsigned char>().swap(asset->texture.data);
+    std::string().swap(asset->source);
+}
+
+void AssetManager_MarkReady(AssetManager *manager, Asset *asset)
+{
+    asset->state.store(ASSET_READY, std::memory_order_relaxed);
+
+    if (asset->on_ready != NULL && !asset->failed)
+        asset->on_ready(asset, asset->user);
+
+    FreeAssetData(asset);
+}
+
+bool AssetManager_Ready(const AssetManager *manager, bool essential_only)
+{
+    for (size_t i = 0; i < manager->assets.size(); ++i)
+    {
+        const Asset *asset = manager->assets[i];
+        if ((asset->essential || !essential_only) && asset->state.load(std::memory_order_acquire) != ASSET_READY)
+            return false;
+    }
+    return true;
+}
+
+void AssetManager_Finish(AssetManager *manager)
+{
+    for (size_t t = 0; t < manager->threads.size(); ++t)
+        manager->threads[t].join();
+    manager->threads.clear();
+
+    for (size_t i = 0; i < manager->assets.size(); ++i)
+    {
+        FreeAssetData(manager->assets[i]);
+        delete manager->assets[i];
+    }
+    manager->assets.clear();
+    manager->queue.clear();
+}
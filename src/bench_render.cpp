@@ -0,0 +1,321 @@
+//     Benchmark de renderização sem janela
+//
+// Desenha a cena do jogo (veja "scene.cpp") em um framebuffer fora da tela,
+// com um contexto OpenGL criado através de EGL, sem servidor gráfico. Em
+// máquinas sem GPU o Mesa utiliza o rasterizador em software llvmpipe, o que
+// torna os números reproduzíveis em qualquer máquina. Deve ser executado a
+// partir do diretório "bin/Linux", como o jogo:
+//
+//     bench_render [--frames N] [--warmup N] [--size LxA] [--asteroids N]
+//                  [--software] [--dump DIR] [--dump-every K]
+//
+// A câmera percorre um caminho fixo: a nave avança com a tecla W enquanto a
+// câmera oscila, a 60 quadros por segundo de tempo simulado. Ao final são
+// impressos os tempos mínimo, mediano e p99 de cada quadro (CPU + GPU, até
+// glFinish()), o tempo de GPU de cada passe de renderização (veja
+// "gputimer.h") e o número de chamadas de desenho e de triângulos por quadro.
+// Com "--dump DIR" os quadros são gravados como DIR/frame_NNNNN.ppm, para
+// comparação de imagens entre versões.
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include <glad/glad.h>
+
+#include "scene.h"
+#include "simulation.h"
+#include "gputimer.h"
+
+// Contexto OpenGL 3.3 "core" sem superfície. Utiliza a plataforma
+// "surfaceless" do Mesa se disponível, e o display padrão caso contrário.
+static bool CreateContext(EGLDisplay *display, EGLContext *context)
+{
+    PFNEGLGETPLATFORMDISPLAYEXTPROC eglGetPlatformDisplayEXT =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+
+    *display = EGL_NO_DISPLAY;
+    if (eglGetPlatformDisplayEXT != NULL)
+        *display = eglGetPlatformDisplayEXT(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+    if (*display == EGL_NO_DISPLAY)
+        *display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+    EGLint major, minor;
+    if (*display == EGL_NO_DISPLAY || !eglInitialize(*display, &major, &minor))
+    {
+        fprintf(stderr, "ERROR: eglInitialize() failed.\n");
+        return false;
+    }
+
+    if (!eglBindAPI(EGL_OPENGL_API))
+    {
+        fprintf(stderr, "ERROR: EGL %d.%d does not support desktop OpenGL.\n", major, minor);
+        return false;
+    }
+
+    // Renderizamos somente no framebuffer criado abaixo, portanto não
+    // precisamos de uma configuração de superfície
+    EGLConfig config = EGL_NO_CONFIG_KHR;
+    const EGLint config_attributes[] = {EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE};
+    EGLint num_configs = 0;
+    if (!eglChooseConfig(*display, config_attributes, &config, 1, &num_configs) || num_configs == 0)
+        config = EGL_NO_CONFIG_KHR;
+
+    const EGLint context_attributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE};
+    *context = eglCreateContext(*display, config, EGL_NO_CONTEXT, context_attributes);
+    if (*context == EGL_NO_CONTEXT)
+    {
+        fprintf(stderr, "ERROR: eglCreateContext() failed (0x%x).\n", eglGetError());
+        return false;
+    }
+
+    if (!eglMakeCurrent(*display, EGL_NO_SURFACE, EGL_NO_SURFACE, *context))
+    {
+        fprintf(stderr, "ERROR: eglMakeCurrent() failed (0x%x).\n", eglGetError());
+        return false;
+    }
+
+    return true;
+}
+
+// Framebuffer com cor RGBA8 e Z-buffer de 24 bits, no lugar da janela
+static GLuint CreateFramebuffer(int width, int height)
+{
+    GLuint framebuffer_id, color_id, depth_id;
+    glGenFramebuffers(1, &framebuffer_id);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_id);
+
+    glGenRenderbuffers(1, &color_id);
+    glBindRenderbuffer(GL_RENDERBUFFER, color_id);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color_id);
+
+    glGenRenderbuffers(1, &depth_id);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth_id);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth_id);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        fprintf(stderr, "ERROR: Incomplete framebuffer.\n");
+        return 0;
+    }
+
+    glViewport(0, 0, width, height);
+    return framebuffer_id;
+}
+
+// Grava o framebuffer atual em um arquivo PPM binário. As linhas são
+// invertidas, já que OpenGL as retorna de baixo para cima.
+static bool DumpFrame(const char *filename, int width, int height)
+{
+    std::vector<unsigned char> pixels((size_t)width * height * 3);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+
+    FILE *f = fopen(filename, "wb");
+    if (f == NULL)
+    {
+        fprintf(stderr, "ERROR: Cannot write \"%s\".\n", filename);
+        return false;
+    }
+    fprintf(f, "P6\n%d %d\n255\n", width, height);
+    for (int y = height - 1; y >= 0; --y)
+        fwrite(&pixels[(size_t)y * width * 3], 1, (size_t)width * 3, f);
+    fclose(f);
+    return true;
+}
+
+// Entrada da simulação no quadro "frame" do caminho de câmera
+static SimulationInput CameraPath(int frame)
+{
+    float t = frame / 60.0f;
+
+    SimulationInput input;
+    memset(&input, 0, sizeof(input));
+    input.forward = true;
+    input.roll = (frame / 120) % 2 == 1;
+    input.camera_theta = 0.6f * sinf(2.0f * 3.141592f * t / 8.0f);
+    input.camera_phi = 0.25f * sinf(2.0f * 3.141592f * t / 5.0f);
+    return input;
+}
+
+int main(int argc, char *argv[])
+{
+    int num_frames = 600;
+    int num_warmup = 10;
+    int width = 800;
+    int height = 600;
+    int num_extra_asteroids = 0;
+    int dump_every = 1;
+    const char *dump_dir = NULL;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--frames") == 0 && has_value)
+            num_frames = std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--warmup") == 0 && has_value)
+            num_warmup = std::max(0, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--size") == 0 && has_value && sscanf(argv[i + 1], "%dx%d", &width, &height) == 2)
+            ++i;
+        else if (strcmp(argv[i], "--asteroids") == 0 && has_value)
+            num_extra_asteroids = std::max(0, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--dump") == 0 && has_value)
+            dump_dir = argv[++i];
+        else if (strcmp(argv[i], "--dump-every") == 0 && has_value)
+            dump_every = std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--software") == 0)
+            setenv("LIBGL_ALWAYS_SOFTWARE", "1", 1); // Força o llvmpipe do Mesa
+        else
+        {
+            fprintf(stderr,
+                    "Usage: bench_render [--frames N] [--warmup N] [--size WxH] [--asteroids N]\n"
+                    "                    [--software] [--dump DIR] [--dump-every K]\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (width <= 0 || height <= 0)
+    {
+        fprintf(stderr, "ERROR: Invalid framebuffer size %dx%d.\n", width, height);
+        return EXIT_FAILURE;
+    }
+
+    EGLDisplay display;
+    EGLContext context;
+    if (!CreateContext(&display, &context))
+        return EXIT_FAILURE;
+
+    if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress))
+    {
+        fprintf(stderr, "ERROR: gladLoadGLLoader() failed.\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("GPU: %s, %s, OpenGL %s, GLSL %s\n",
+           glGetString(GL_VENDOR), glGetString(GL_RENDERER),
+           glGetString(GL_VERSION), glGetString(GL_SHADING_LANGUAGE_VERSION));
+
+    if (CreateFramebuffer(width, height) == 0)
+        return EXIT_FAILURE;
+
+    // Mesmos shaders, texturas, modelos e campo de asteroides do jogo
+    Scene_Init();
+    UploadLoadedAssets(true); // Os quadros medidos já devem ter todos os modelos e texturas
+    LoadAsteroids(num_extra_asteroids);
+
+    Simulation sim;
+    Simulation_Init(&sim, g_VirtualScene[g_AsteroidObject].bbox_min, g_VirtualScene[g_AsteroidObject].bbox_max);
+
+    SceneCamera camera;
+    camera.first_person = false;
+    camera.screen_ratio = (float)width / height;
+
+    std::vector<double> frame_times;
+    frame_times.reserve(num_frames);
+    unsigned long total_draws = 0;
+    unsigned long total_triangles = 0;
+
+    // Os primeiros quadros incluem a compilação tardia dos shaders pelo
+    // driver e não são medidos
+    for (int frame = -num_warmup; frame < num_frames; ++frame)
+    {
+        SimulationInput input = CameraPath(std::max(frame, 0));
+        if (frame >= 0)
+            for (int tick = 0; tick < SIMULATION_TICK_RATE / 60; ++tick)
+                Simulation_Tick(&sim, input);
+
+        const SimulationState &state = sim.current;
+        camera.theta = input.camera_theta;
+        camera.phi = input.camera_phi;
+
+        g_DrawCalls = 0;
+        g_DrawTriangles = 0;
+
+        // Os tempos de GPU do aquecimento também são descartados. Os
+        // resultados só são lidos GPU_TIMER_FRAMES quadros depois do envio;
+        // lemos os pendentes antes de limpar o histórico, para que nenhum
+        // quadro do aquecimento entre nas estatísticas.
+        if (frame == 0)
+        {
+            GpuTimer_Flush();
+            Profiler_ClearHistory();
+        }
+        GpuTimer_BeginFrame();
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        Scene_Draw(state, camera, (float)state.time);
+        glFinish();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if (frame < 0)
+            continue;
+
+        frame_times.push_back(seconds);
+        total_draws += g_DrawCalls;
+        total_triangles += g_DrawTriangles;
+
+        if (dump_dir != NULL && frame % dump_every == 0)
+        {
+            char filename[1024];
+            snprintf(filename, sizeof(filename), "%s/frame_%05d.ppm", dump_dir, frame);
+            if (!DumpFrame(filename, width, height))
+                return EXIT_FAILURE;
+        }
+    }
+
+    GLenum error = glGetError();
+    if (error != GL_NO_ERROR)
+    {
+        fprintf(stderr, "ERROR: OpenGL error 0x%x.\n", error);
+        return EXIT_FAILURE;
+    }
+
+    double total = 0.0;
+    for (size_t i = 0; i < frame_times.size(); ++i)
+        total += frame_times[i];
+    std::sort(frame_times.begin(), frame_times.end());
+
+    size_t n = frame_times.size();
+    size_t p99 = (size_t)std::ceil(0.99 * n) - 1;
+    printf("Quadros: %d de %dx%d, asteroides: %d, colisoes: %u\n",
+           (int)n, width, height, (int)g_AsteroidInstances.size(), sim.current.crashes);
+    printf("Tempo por quadro: min %.3f ms, mediana %.3f ms, p99 %.3f ms, max %.3f ms, media %.3f ms (%.1f quadros/s)\n",
+           1e3 * frame_times[0], 1e3 * frame_times[n / 2], 1e3 * frame_times[p99], 1e3 * frame_times[n - 1],
+           1e3 * total / n, n / total);
+    printf("Por quadro: %.1f draws, %.0f triangulos\n",
+           (double)total_draws / n, (double)total_triangles / n);
+
+    // Os resultados dos últimos quadros ainda estão no anel de queries. O
+    // histórico do profiler guarda somente os últimos PROFILER_HISTORY quadros.
+    GpuTimer_Flush();
+    ProfilerStats stats;
+    if (Profiler_GpuPassStats(PROFILER_GPU_NUM_PASSES, &stats))
+    {
+        printf("Tempo de GPU nos ultimos %d quadros:\n", (int)std::min(n, (size_t)PROFILER_HISTORY));
+        for (int pass = 0; pass <= PROFILER_GPU_NUM_PASSES; ++pass)
+        {
+            Profiler_GpuPassStats(pass, &stats);
+            printf("  %s: media %.3f ms, p99 %.3f ms\n", Profiler_GpuPassName(pass), stats.average, stats.p99);
+        }
+    }
+
+    Simulation_Free(&sim);
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroyContext(display, context);
+    eglTerminate(display);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,980 @@
+#include "benchmarks.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/geometric.hpp>
+#include <tiny_obj_loader.h>
+
+#include "collisions.h"
+#include "floatparse.h"
+#include "normals.h"
+#include "objloader.h"
+#include "textrendering.h"
+
+// Tempo decorrido desde "start", em segundos.
+static double SecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Custo das consultas ao mundo de colisões (veja CollisionWorld em
+// "collisions.h") com N corpos estáticos, comparado com o teste de todos os
+// corpos um a um. Os corpos têm o tamanho das HitBoxes dos asteroides e são
+// espalhados com densidade constante; as consultas têm o tamanho da HitBox
+// da nave.
+//
+//     main --bench collisions [N ...]
+static int Benchmark_Collisions(int argc, char *argv[])
+{
+    std::vector<int> counts;
+    for (int i = 0; i < argc; ++i)
+        counts.push_back(atoi(argv[i]));
+    if (counts.empty())
+    {
+        counts.push_back(10000);
+        counts.push_back(25000);
+        counts.push_back(50000);
+        counts.push_back(100000);
+    }
+
+    const float spacing = 8.0f;   // Distância média entre corpos
+    const int num_queries = 200000;
+    const int num_brute_queries = 1000;
+    const int num_moves = 100000;
+
+    printf("%8s %10s %12s %12s %12s %12s %10s %12s\n",
+           "corpos", "build ms", "ampla ns", "grade ns", "linear ns", "candidatos", "colisoes", "move ns");
+
+    for (size_t c = 0; c < counts.size(); ++c)
+    {
+        int N = counts[c];
+        if (N <= 0)
+            continue;
+
+        float side = spacing * cbrtf((float)N);
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<float> position(-0.5f * side, 0.5f * side);
+        std::uniform_real_distribution<float> size(1.0f, 7.0f);
+
+        std::vector<HitBox> boxes(N);
+        for (int i = 0; i < N; ++i)
+        {
+            glm::vec3 center(position(rng), position(rng), position(rng));
+            glm::vec3 half = 0.5f * glm::vec3(size(rng), size(rng), size(rng));
+            boxes[i].minPoint = center - half;
+            boxes[i].maxPoint = center + half;
+        }
+
+        std::vector<HitBox> queries(num_queries);
+        glm::vec3 ship_half = 0.5f * glm::vec3(0.2f, 0.2f, 1.0f);
+        for (int i = 0; i < num_queries; ++i)
+        {
+            glm::vec3 center(position(rng), position(rng), position(rng));
+            queries[i].minPoint = center - ship_half;
+            queries[i].maxPoint = center + ship_half;
+        }
+
+        // Construção do mundo
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        CollisionWorld world;
+        CollisionWorld_Init(&world, spacing);
+        for (int i = 0; i < N; ++i)
+            CollisionWorld_AddBox(&world, boxes[i], 0, i);
+        double build_seconds = SecondsSince(start);
+
+        // Consultas na grade: somente a fase ampla, e a fase ampla seguida
+        // do teste exato
+        std::vector<int> candidates;
+        long long total_candidates = 0;
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < num_queries; ++i)
+        {
+            candidates.clear();
+            CollisionWorld_QueryCandidates(&world, queries[i], &candidates);
+            total_candidates += (long long)candidates.size();
+        }
+        double broad_seconds = SecondsSince(start);
+
+        std::vector<int> hits;
+        long long total_hits = 0;
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < num_queries; ++i)
+        {
+            hits.clear();
+            total_hits += CollisionWorld_Collide(&world, queries[i], &hits);
+        }
+        double grid_seconds = SecondsSince(start);
+
+        // Teste de todos os corpos, para comparação e para conferir o
+        // resultado da grade
+        long long brute_hits = 0;
+        long long grid_hits = 0;
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < num_brute_queries; ++i)
+            for (int j = 0; j < N; ++j)
+                brute_hits += SpaceshipAsteroidCollision(queries[i], boxes[j]) ? 1 : 0;
+        double brute_seconds = SecondsSince(start);
+
+        for (int i = 0; i < num_brute_queries; ++i)
+        {
+            hits.clear();
+            grid_hits += CollisionWorld_Collide(&world, queries[i], &hits);
+        }
+        if (grid_hits != brute_hits)
+        {
+            fprintf(stderr, "ERROR: grid found %lld collisions, brute force found %lld.\n", grid_hits, brute_hits);
+            return EXIT_FAILURE;
+        }
+
+        // Movimentação de corpos dinâmicos, com deslocamentos pequenos como
+        // os de um objeto animado a cada quadro
+        std::uniform_int_distribution<int> body(0, N - 1);
+        std::uniform_real_distribution<float> step(-0.5f, 0.5f);
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < num_moves; ++i)
+        {
+            int id = body(rng);
+            glm::vec3 delta(step(rng), step(rng), step(rng));
+            boxes[id].minPoint += delta;
+            boxes[id].maxPoint += delta;
+            CollisionWorld_MoveBox(&world, id, boxes[id]);
+        }
+        double move_seconds = SecondsSince(start);
+
+        printf("%8d %10.2f %12.1f %12.1f %12.1f %12.2f %10.4f %12.1f\n",
+               N,
+               1e3 * build_seconds,
+               1e9 * broad_seconds / num_queries,
+               1e9 * grid_seconds / num_queries,
+               1e9 * brute_seconds / num_brute_queries,
+               (double)total_candidates / num_queries,
+               (double)total_hits / num_queries,
+               1e9 * move_seconds / num_moves);
+
+        CollisionWorld_Free(&world);
+    }
+
+    return EXIT_SUCCESS;
+}
+
+// Custo dos testes exatos em lote (veja HitBox_OverlapBatch() e
+// HitSphere_OverlapBatch() em "collisions.h") com cada implementação
+// suportada pelo processador, comparado com SpaceshipAsteroidCollision() e
+// SpaceshipMoonCollision() chamadas para cada corpo. As máscaras de todas as
+// implementações são conferidas com a escalar.
+//
+//     main --bench narrowphase [N ...]
+static int Benchmark_NarrowPhase(int argc, char *argv[])
+{
+    std::vector<int> counts;
+    for (int i = 0; i < argc; ++i)
+        counts.push_back(atoi(argv[i]));
+    if (counts.empty())
+    {
+        counts.push_back(1000);
+        counts.push_back(10000);
+        counts.push_back(100000);
+    }
+
+    const int default_kernels = CollisionKernels_Selected();
+    printf("Implementação escolhida: %s\n", CollisionKernels_Name(default_kernels));
+    printf("%8s %10s %14s %14s %10s\n", "corpos", "versão", "caixas ns/c", "esferas ns/c", "colisoes");
+
+    for (size_t c = 0; c < counts.size(); ++c)
+    {
+        int N = counts[c];
+        if (N <= 0)
+            continue;
+
+        // Mesma densidade de Benchmark_Collisions(), mas com consultas do
+        // tamanho de uma célula da grade para que haja colisões
+        float side = 8.0f * cbrtf((float)N);
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<float> position(-0.5f * side, 0.5f * side);
+        std::uniform_real_distribution<float> size(1.0f, 7.0f);
+
+        std::vector<HitBox> boxes(N);
+        std::vector<HitSphere> spheres(N);
+        HitBoxSoA box_soa;
+        HitSphereSoA sphere_soa;
+        HitBoxSoA_Init(&box_soa);
+        HitSphereSoA_Init(&sphere_soa);
+        for (int i = 0; i < N; ++i)
+        {
+            glm::vec3 center(position(rng), position(rng), position(rng));
+            glm::vec3 half = 0.5f * glm::vec3(size(rng), size(rng), size(rng));
+            boxes[i].minPoint = center - half;
+            boxes[i].maxPoint = center + half;
+            spheres[i].center = center;
+            spheres[i].radius = half.x;
+            HitBoxSoA_Push(&box_soa, boxes[i]);
+            HitSphereSoA_Push(&sphere_soa, spheres[i]);
+        }
+
+        const int num_queries = std::max(10, 20000000 / N);
+        std::vector<HitBox> queries(num_queries);
+        for (int i = 0; i < num_queries; ++i)
+        {
+            glm::vec3 center(position(rng), position(rng), position(rng));
+            queries[i].minPoint = center - glm::vec3(4.0f);
+            queries[i].maxPoint = center + glm::vec3(4.0f);
+        }
+
+        // Um corpo por vez, no formato "array of structures"
+        long long hits = 0;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int q = 0; q < num_queries; ++q)
+            for (int i = 0; i < N; ++i)
+                hits += SpaceshipAsteroidCollision(queries[q], boxes[i]) ? 1 : 0;
+        double box_seconds = SecondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        for (int q = 0; q < num_queries; ++q)
+            for (int i = 0; i < N; ++i)
+                hits += SpaceshipMoonCollision(queries[q], spheres[i]) ? 1 : 0;
+        double sphere_seconds = SecondsSince(start);
+
+        double tests = (double)num_queries * N;
+        printf("%8d %10s %14.3f %14.3f %10lld\n", N, "AoS", 1e9 * box_seconds / tests, 1e9 * sphere_seconds / tests, hits);
+
+        // Máscaras de referência, da implementação escalar
+        size_t words = CollisionMask_Words(N);
+        std::vector<uint64_t> box_reference((size_t)num_queries * words);
+        std::vector<uint64_t> sphere_reference((size_t)num_queries * words);
+        std::vector<uint64_t> mask(words);
+        CollisionKernels_Select(COLLISION_KERNELS_SCALAR);
+        for (int q = 0; q < num_queries; ++q)
+        {
+            HitBox_OverlapBatch(&box_soa, queries[q], &box_reference[q * words]);
+            HitSphere_OverlapBatch(&sphere_soa, queries[q], &sphere_reference[q * words]);
+        }
+
+        for (int kernels = COLLISION_KERNELS_SCALAR; kernels <= COLLISION_KERNELS_AVX2; ++kernels)
+        {
+            if (!CollisionKernels_Select(kernels))
+                continue;
+
+            hits = 0;
+            bool matches = true;
+            start = std::chrono::steady_clock::now();
+            for (int q = 0; q < num_queries; ++q)
+            {
+                hits += HitBox_OverlapBatch(&box_soa, queries[q], mask.data());
+                matches = matches && memcmp(mask.data(), &box_reference[q * words], words * sizeof(uint64_t)) == 0;
+            }
+            box_seconds = SecondsSince(start);
+
+            start = std::chrono::steady_clock::now();
+            for (int q = 0; q < num_queries; ++q)
+            {
+                hits += HitSphere_OverlapBatch(&sphere_soa, queries[q], mask.data());
+                matches = matches && memcmp(mask.data(), &sphere_reference[q * words], words * sizeof(uint64_t)) == 0;
+            }
+            sphere_seconds = SecondsSince(start);
+
+            if (!matches)
+            {
+                fprintf(stderr, "ERROR: %s kernels differ from the scalar ones.\n", CollisionKernels_Name(kernels));
+                return EXIT_FAILURE;
+            }
+
+            printf("%8d %10s %14.3f %14.3f %10lld\n", N, CollisionKernels_Name(kernels),
+                   1e9 * box_seconds / tests, 1e9 * sphere_seconds / tests, hits);
+        }
+
+        CollisionKernels_Select(default_kernels);
+        HitBoxSoA_Free(&box_soa);
+        HitSphereSoA_Free(&sphere_soa);
+    }
+
+    return EXIT_SUCCESS;
+}
+
+// Custo de formatar e posicionar um texto de N bytes (10000 por padrão),
+// montado com linhas parecidas com as do texto informativo do jogo, com a
+// busca linear na lista de glifos da fonte e com a tabela construída por
+// TextRendering_BuildGlyphTable(). Nos dois casos o texto é decodificado como
+// UTF-8 e as duas buscas devem encontrar o mesmo número de glifos. Somente a
+// geração dos vértices é medida; nada é desenhado.
+//
+//     main --bench text [N]
+static int Benchmark_Text(int argc, char *argv[])
+{
+    int N = (argc >= 1) ? atoi(argv[0]) : 10000;
+    if (N <= 0)
+        N = 10000;
+
+    const int repetitions = 200;
+    TextRendering_BuildGlyphTable();
+
+    // Formatação
+    std::string text;
+    char buffer[160];
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repetitions; ++r)
+    {
+        text.clear();
+        for (int line = 0; (int)text.size() < N; ++line)
+        {
+            snprintf(buffer, sizeof(buffer), "Nave: (%+.2f, %+.2f, %+.2f)  rotação: %+.2f  colisões: %d  câmera: %s\n",
+                     0.01f * line, -0.02f * line, 0.5f * line, 0.1f * r, line % 7, (line % 2) ? "1a pessoa" : "3a pessoa");
+            text += buffer;
+        }
+        text.resize(N);
+    }
+    double format_seconds = SecondsSince(start);
+
+    printf("Texto de %d bytes, formatação: %.2f ns/byte\n", N, 1e9 * format_seconds / ((double)repetitions * N));
+    printf("%10s %12s %10s\n", "busca", "ns/byte", "glifos");
+
+    // Métricas de uma janela de 800x600, com a escala do jogo
+    TextLayout layout = TextLayout_Create(800, 600, 1.5f);
+
+    std::vector<TextVertex> vertices;
+    vertices.reserve(6 * (size_t)N);
+
+    const int lookups[2] = {TEXT_LOOKUP_LINEAR, TEXT_LOOKUP_TABLE};
+    const char *names[2] = {"linear", "tabela"};
+    for (int l = 0; l < 2; ++l)
+    {
+        start = std::chrono::steady_clock::now();
+        for (int r = 0; r < repetitions; ++r)
+        {
+            vertices.clear();
+            TextRendering_LayoutString(layout, text, -1.0f, 1.0f, 1.0f, &vertices, lookups[l]);
+        }
+        double seconds = SecondsSince(start);
+
+        printf("%10s %12.2f %10d\n", names[l], 1e9 * seconds / ((double)repetitions * N), (int)(vertices.size() / 6));
+    }
+
+    return EXIT_SUCCESS;
+}
+
+// Malha usada por Benchmark_Normals(): posições e índices dos triângulos
+struct BenchmarkMesh
+{
+    std::string name;
+    std::vector<float> positions;
+    std::vector<int> triangles;
+};
+
+// Lê somente as posições e os triângulos de um arquivo OBJ
+static bool LoadBenchmarkMesh(const char *filename, BenchmarkMesh *mesh)
+{
+    tinyobj::attrib_t attrib;
+    std::vector<tinyobj::shape_t> shapes;
+    std::vector<tinyobj::material_t> materials;
+    std::string warn;
+    std::string err;
+    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, filename, NULL, true))
+        return false;
+
+    const char *slash = strrchr(filename, '/');
+    mesh->name = (slash != NULL) ? slash + 1 : filename;
+    mesh->positions = attrib.vertices;
+    for (size_t shape = 0; shape < shapes.size(); ++shape)
+        for (size_t i = 0; i < shapes[shape].mesh.indices.size(); ++i)
+            mesh->triangles.push_back(shapes[shape].mesh.indices[i].vertex_index);
+    return true;
+}
+
+// Superfície ondulada com uma grade de vértices e dois triângulos por
+// célula, com aproximadamente "num_triangles" triângulos
+static void BuildSyntheticMesh(int num_triangles, BenchmarkMesh *mesh)
+{
+    int side = std::max(2, (int)sqrtf(0.5f * num_triangles) + 1);
+    mesh->name = "sintética";
+    mesh->positions.resize(3 * (size_t)side * side);
+    for (int y = 0; y < side; ++y)
+    {
+        for (int x = 0; x < side; ++x)
+        {
+            float *p = &mesh->positions[3 * ((size_t)y * side + x)];
+            p[0] = (float)x;
+            p[1] = 4.0f * sinf(0.05f * x) * cosf(0.07f * y);
+            p[2] = (float)y;
+        }
+    }
+
+    mesh->triangles.reserve(6 * (size_t)(side - 1) * (side - 1));
+    for (int y = 0; y + 1 < side; ++y)
+    {
+        for (int x = 0; x + 1 < side; ++x)
+        {
+            int v = y * side + x;
+            int quad[6] = {v, v + side, v + 1, v + 1, v + side, v + side + 1};
+            mesh->triangles.insert(mesh->triangles.end(), quad, quad + 6);
+        }
+    }
+}
+
+// Implementação de ComputeNormals() anterior a "normals.cpp", com glm::vec4,
+// contagem de faces por vértice e divisões, mantida para comparação
+static void ComputeNormalsGlm(const BenchmarkMesh &mesh, float *normals)
+{
+    size_t num_vertices = mesh.positions.size() / 3;
+    std::vector<int> num_triangles_per_vertex(num_vertices, 0);
+    std::vector<glm::vec4> vertex_normals(num_vertices, glm::vec4(0.0f, 0.0f, 0.0f, 0.0f));
+
+    for (size_t triangle = 0; triangle < mesh.triangles.size() / 3; ++triangle)
+    {
+        glm::vec4 vertices[3];
+        for (size_t vertex = 0; vertex < 3; ++vertex)
+        {
+            const float *p = &mesh.positions[3 * mesh.triangles[3 * triangle + vertex]];
+            vertices[vertex] = glm::vec4(p[0], p[1], p[2], 1.0f);
+        }
+
+        const glm::vec4 n = glm::vec4(glm::cross(glm::vec3(vertices[1] - vertices[0]), glm::vec3(vertices[2] - vertices[0])), 0.0f);
+
+        for (size_t vertex = 0; vertex < 3; ++vertex)
+        {
+            int v = mesh.triangles[3 * triangle + vertex];
+            num_triangles_per_vertex[v] += 1;
+            vertex_normals[v] += n;
+        }
+    }
+
+    for (size_t i = 0; i < num_vertices; ++i)
+    {
+        glm::vec4 n = vertex_normals[i] / (float)num_triangles_per_vertex[i];
+        n /= glm::length(n);
+        normals[3 * i + 0] = n.x;
+        normals[3 * i + 1] = n.y;
+        normals[3 * i + 2] = n.z;
+    }
+}
+
+// Maior diferença, por coeficiente, entre dois conjuntos de normais
+static float MaxNormalDifference(const std::vector<float> &a, const std::vector<float> &b)
+{
+    float max_difference = 0.0f;
+    for (size_t i = 0; i < a.size(); ++i)
+        max_difference = std::max(max_difference, fabsf(a[i] - b[i]));
+    return max_difference;
+}
+
+// Custo de ComputeVertexNormals() (veja "normals.h") com os dois pesos e
+// números crescentes de threads, nos maiores modelos de "data/" e em uma
+// malha sintética de N triângulos (5 milhões por padrão), comparado com a
+// implementação anterior com glm::vec4. A coluna "desvio" é a maior
+// diferença em relação ao resultado com uma thread.
+//
+//     main --bench normals [N ...]
+static int Benchmark_Normals(int argc, char *argv[])
+{
+    std::vector<int> counts;
+    for (int i = 0; i < argc; ++i)
+        counts.push_back(atoi(argv[i]));
+    if (counts.empty())
+        counts.push_back(5000000);
+
+    std::vector<BenchmarkMesh> meshes;
+    const char *filenames[3] = {"../../data/coin.obj", "../../data/Asteroid.obj", "../../data/moon.obj"};
+    for (int i = 0; i < 3; ++i)
+    {
+        BenchmarkMesh mesh;
+        if (LoadBenchmarkMesh(filenames[i], &mesh))
+            meshes.push_back(mesh);
+        else
+            fprintf(stderr, "WARNING: Cannot open \"%s\", skipping.\n", filenames[i]);
+    }
+    for (size_t c = 0; c < counts.size(); ++c)
+    {
+        if (counts[c] <= 0)
+            continue;
+        BenchmarkMesh mesh;
+        BuildSyntheticMesh(counts[c], &mesh);
+        meshes.push_back(mesh);
+    }
+
+    std::vector<int> thread_counts;
+    int max_threads = std::max(1, (int)std::thread::hardware_concurrency());
+    for (int t = 1; t < max_threads; t *= 2)
+        thread_counts.push_back(t);
+    thread_counts.push_back(max_threads);
+
+    printf("Núcleos: %d\n", max_threads);
+    printf("%12s %10s %10s %8s %8s %10s %8s %10s\n",
+           "malha", "triângulos", "vértices", "peso", "threads", "ms", "speedup", "desvio");
+
+    for (size_t m = 0; m < meshes.size(); ++m)
+    {
+        const BenchmarkMesh &mesh = meshes[m];
+        size_t num_vertices = mesh.positions.size() / 3;
+        size_t num_triangles = mesh.triangles.size() / 3;
+
+        // Repetições suficientes para cerca de 2 milhões de triângulos
+        int repetitions = std::max(1, (int)(2000000 / std::max((size_t)1, num_triangles)));
+
+        std::vector<float> normals(3 * num_vertices);
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int r = 0; r < repetitions; ++r)
+            ComputeNormalsGlm(mesh, normals.data());
+        double glm_seconds = SecondsSince(start) / repetitions;
+        printf("%12s %10d %10d %8s %8s %10.3f %8s %10s\n", mesh.name.c_str(), (int)num_triangles, (int)num_vertices,
+               "glm", "1", 1e3 * glm_seconds, "", "");
+
+        const int weightings[2] = {NORMALS_WEIGHT_AREA, NORMALS_WEIGHT_ANGLE};
+        const char *names[2] = {"área", "ângulo"};
+        for (int w = 0; w < 2; ++w)
+        {
+            std::vector<float> reference(3 * num_vertices);
+            double serial_seconds = 0.0;
+            for (size_t t = 0; t < thread_counts.size(); ++t)
+            {
+                start = std::chrono::steady_clock::now();
+                for (int r = 0; r < repetitions; ++r)
+                    ComputeVertexNormals(mesh.positions.data(), num_vertices, mesh.triangles.data(), num_triangles,
+                                         weightings[w], normals.data(), thread_counts[t]);
+                double seconds = SecondsSince(start) / repetitions;
+
+                if (t == 0)
+                {
+                    serial_seconds = seconds;
+                    reference = normals;
+                }
+
+                printf("%12s %10d %10d %8s %8d %10.3f %8.2f %10.2g\n", mesh.name.c_str(), (int)num_triangles,
+                       (int)num_vertices, names[w], thread_counts[t], 1e3 * seconds, serial_seconds / seconds,
+                       MaxNormalDifference(reference, normals));
+            }
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+// Grava em "filename" um arquivo OBJ sintético de aproximadamente
+// "megabytes" MB: grades de 64x64 vértices com posição, coordenadas de
+// textura e normal, uma por objeto ("o"), alternando quadriláteros com
+// índices absolutos e pares de triângulos com índices relativos (negativos)
+static bool WriteSyntheticObj(const char *filename, int megabytes)
+{
+    FILE *file = fopen(filename, "wb");
+    if (file == NULL)
+        return false;
+
+    const int side = 64;
+    const long long target = (long long)megabytes * 1024 * 1024;
+    long long written = 0;
+    int base = 1; // Índice (a partir de 1) do primeiro vértice da grade
+    for (int patch = 0; written < target; ++patch)
+    {
+        written += fprintf(file, "o grade_%d\n", patch);
+        written += fprintf(file, (patch % 2 == 0) ? "s 1\n" : "s off\n");
+        for (int y = 0; y < side; ++y)
+        {
+            for (int x = 0; x < side; ++x)
+            {
+                float px = (float)(patch * side + x);
+                float py = 4.0f * sinf(0.05f * px) * cosf(0.07f * y);
+                written += fprintf(file, "v %f %f %f\n", px, py, (float)y);
+                written += fprintf(file, "vt %f %f\n", x / (float)(side - 1), y / (float)(side - 1));
+                written += fprintf(file, "vn %f %f %f\n", -0.2f * cosf(0.05f * px), 1.0f, 0.3f * sinf(0.07f * y));
+            }
+        }
+
+        int count = base + side * side; // Vértices lidos + 1, para os índices relativos
+        for (int y = 0; y + 1 < side; ++y)
+        {
+            for (int x = 0; x + 1 < side; ++x)
+            {
+                int a = base + y * side + x;
+                int b = a + side;
+                int c = a + 1;
+                int d = b + 1;
+                if ((x + y) % 2 == 0)
+                {
+                    written += fprintf(file, "f %d/%d/%d %d/%d/%d %d/%d/%d %d/%d/%d\n",
+                                       a, a, a, b, b, b, d, d, d, c, c, c);
+                }
+                else
+                {
+                    written += fprintf(file, "f %d/%d/%d %d/%d/%d %d/%d/%d\nf %d//%d %d//%d %d//%d\n",
+                                       a - count, a - count, a - count, b - count, b - count, b - count,
+                                       c - count, c - count, c - count, c - count, c - count, b - count,
+                                       b - count, d - count, d - count);
+                }
+            }
+        }
+        base = count;
+    }
+
+    return fclose(file) == 0;
+}
+
+template <typename T>
+static bool SameVector(const std::vector<T> &a, const std::vector<T> &b)
+{
+    return a.size() == b.size() && (a.empty() || memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0);
+}
+
+// Retorna true se os dois resultados têm os mesmos objetos, faces e
+// números de vértices, normais e coordenadas de textura
+static bool SameObj(const tinyobj::attrib_t &a, const std::vector<tinyobj::shape_t> &a_shapes,
+                    const tinyobj::attrib_t &b, const std::vector<tinyobj::shape_t> &b_shapes)
+{
+    if (a.vertices.size() != b.vertices.size() || a.normals.size() != b.normals.size() ||
+        a.texcoords.size() != b.texcoords.size() || a.colors.size() != b.colors.size() ||
+        a_shapes.size() != b_shapes.size())
+        return false;
+
+    for (size_t s = 0; s < a_shapes.size(); ++s)
+    {
+        const tinyobj::mesh_t &am = a_shapes[s].mesh;
+        const tinyobj::mesh_t &bm = b_shapes[s].mesh;
+        if (a_shapes[s].name != b_shapes[s].name || am.indices.size() != bm.indices.size() ||
+            !SameVector(am.num_face_vertices, bm.num_face_vertices) || !SameVector(am.material_ids, bm.material_ids) ||
+            !SameVector(am.smoothing_group_ids, bm.smoothing_group_ids))
+            return false;
+
+        for (size_t i = 0; i < am.indices.size(); ++i)
+        {
+            if (am.indices[i].vertex_index != bm.indices[i].vertex_index ||
+                am.indices[i].normal_index != bm.indices[i].normal_index ||
+                am.indices[i].texcoord_index != bm.indices[i].texcoord_index)
+                return false;
+        }
+    }
+    return true;
+}
+
+// Maior diferença, em ULPs (floats representáveis entre os dois valores),
+// entre os números de dois resultados de mesmo tamanho
+static int MaxUlpDifference(const tinyobj::attrib_t &a, const tinyobj::attrib_t &b)
+{
+    const std::vector<float> *a_arrays[4] = {&a.vertices, &a.normals, &a.texcoords, &a.colors};
+    const std::vector<float> *b_arrays[4] = {&b.vertices, &b.normals, &b.texcoords, &b.colors};
+    int64_t max_difference = 0;
+    for (int array = 0; array < 4; ++array)
+    {
+        for (size_t i = 0; i < a_arrays[array]->size(); ++i)
+        {
+            int32_t x, y;
+            memcpy(&x, &(*a_arrays[array])[i], sizeof(x));
+            memcpy(&y, &(*b_arrays[array])[i], sizeof(y));
+            // Ordena os negativos abaixo dos positivos
+            int64_t ordered_x = (x < 0) ? (int64_t)INT32_MIN - x : x;
+            int64_t ordered_y = (y < 0) ? (int64_t)INT32_MIN - y : y;
+            max_difference = std::max(max_difference, std::abs(ordered_x - ordered_y));
+        }
+    }
+    return (int)std::min(max_difference, (int64_t)INT32_MAX);
+}
+
+// Tempo de leitura de arquivos OBJ com tinyobj::LoadObj() e com
+// ObjLoader_Load() (veja "objloader.h") com números crescentes de threads,
+// em "coin.obj" e em arquivos sintéticos de N MB (200 por padrão), gravados
+// no diretório atual e apagados ao final. A coluna "igual" indica se os
+// objetos e as faces são idênticos aos de tinyobj, e "ulps" a maior
+// diferença entre os números lidos (veja "floatparse.h").
+//
+//     main --bench obj [N ...]
+static int Benchmark_Obj(int argc, char *argv[])
+{
+    std::vector<int> sizes;
+    for (int i = 0; i < argc; ++i)
+        sizes.push_back(atoi(argv[i]));
+    if (sizes.empty())
+        sizes.push_back(200);
+
+    std::vector<std::string> filenames;
+    std::vector<bool> temporary;
+    filenames.push_back("../../data/coin.obj");
+    temporary.push_back(false);
+    for (size_t i = 0; i < sizes.size(); ++i)
+    {
+        if (sizes[i] <= 0)
+            continue;
+        char filename[64];
+        snprintf(filename, sizeof(filename), "bench_obj_%dmb.obj", sizes[i]);
+        printf("Gravando \"%s\"...\n", filename);
+        if (!WriteSyntheticObj(filename, sizes[i]))
+        {
+            fprintf(stderr, "ERROR: Cannot write \"%s\".\n", filename);
+            remove(filename);
+            continue;
+        }
+        filenames.push_back(filename);
+        temporary.push_back(true);
+    }
+
+    std::vector<int> thread_counts;
+    int max_threads = std::max(1, (int)std::thread::hardware_concurrency());
+    for (int t = 1; t < max_threads; t *= 2)
+        thread_counts.push_back(t);
+    thread_counts.push_back(max_threads);
+
+    printf("Núcleos: %d\n", max_threads);
+    printf("%20s %8s %10s %10s %10s %8s %8s %6s %5s\n",
+           "arquivo", "MB", "triângulos", "leitura", "threads", "ms", "MB/s", "igual", "ulps");
+
+    int result = EXIT_SUCCESS;
+    for (size_t f = 0; f < filenames.size(); ++f)
+    {
+        const char *filename = filenames[f].c_str();
+        const char *slash = strrchr(filename, '/');
+        const char *name = (slash != NULL) ? slash + 1 : filename;
+
+        FILE *file = fopen(filename, "rb");
+        if (file == NULL)
+        {
+            fprintf(stderr, "WARNING: Cannot open \"%s\", skipping.\n", filename);
+            continue;
+        }
+        fseek(file, 0, SEEK_END);
+        double megabytes = ftell(file) / (1024.0 * 1024.0);
+        fclose(file);
+
+        // Repetições suficientes para cerca de 20 MB lidos
+        int repetitions = std::max(1, (int)(20.0 / megabytes));
+
+        tinyobj::attrib_t reference;
+        std::vector<tinyobj::shape_t> reference_shapes;
+        double seconds = 0.0;
+        for (int r = 0; r < repetitions; ++r)
+        {
+            std::vector<tinyobj::material_t> materials;
+            std::string warn, err;
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            bool ok = tinyobj::LoadObj(&reference, &reference_shapes, &materials, &warn, &err, filename,
+                                       "../../data/", true);
+            seconds += SecondsSince(start);
+            if (!ok)
+            {
+                fprintf(stderr, "ERROR: Cannot load \"%s\": %s\n", filename, err.c_str());
+                return EXIT_FAILURE;
+            }
+        }
+        seconds /= repetitions;
+
+        size_t num_triangles = 0;
+        for (size_t s = 0; s < reference_shapes.size(); ++s)
+            num_triangles += reference_shapes[s].mesh.num_face_vertices.size();
+        printf("%20s %8.1f %10d %10s %10s %8.1f %8.1f %6s\n", name, megabytes, (int)num_triangles, "tinyobj", "1",
+               1e3 * seconds, megabytes / seconds, "");
+
+        for (size_t t = 0; t < thread_counts.size(); ++t)
+        {
+            tinyobj::attrib_t attrib;
+            std::vector<tinyobj::shape_t> shapes;
+            seconds = 0.0;
+            for (int r = 0; r < repetitions; ++r)
+            {
+                std::vector<tinyobj::material_t> materials;
+                std::string warn, err;
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                bool ok = ObjLoader_Load(&attrib, &shapes, &materials, &warn, &err, filename, "../../data/", true,
+                                         thread_counts[t]);
+                seconds += SecondsSince(start);
+                if (!ok)
+                {
+                    fprintf(stderr, "ERROR: Cannot load \"%s\": %s\n", filename, err.c_str());
+                    return EXIT_FAILURE;
+                }
+            }
+            seconds /= repetitions;
+
+            bool same = SameObj(reference, reference_shapes, attrib, shapes);
+            if (!same)
+                result = EXIT_FAILURE;
+            printf("%20s %8.1f %10d %10s %10d %8.1f %8.1f %6s %5d\n", name, megabytes, (int)num_triangles,
+                   "objloader", thread_counts[t], 1e3 * seconds, megabytes / seconds, same ? "sim" : "NÃO",
+                   same ? MaxUlpDifference(reference, attrib) : -1);
+        }
+    }
+
+    for (size_t f = 0; f < filenames.size(); ++f)
+        if (temporary[f])
+            remove(filenames[f].c_str());
+
+    return result;
+}
+
+// Compara ParseFloat() com strtof(), que arredonda corretamente, no texto
+// "text". Retorna true se o resultado for idêntico, bit a bit.
+static bool SameAsStrtof(const char *text)
+{
+    float value = 0.0f;
+    if (!ParseFloat(text, text + strlen(text), &value))
+        return false;
+    float expected = strtof(text, NULL);
+    return memcmp(&value, &expected, sizeof(value)) == 0;
+}
+
+// Tempo para converter todos os números de "text", separados por espaços,
+// com o método "method" (0: ParseFloat(), 1: strtof(), 2: strtod()).
+// Retorna a soma dos valores em "checksum", para que nada seja descartado.
+static double TimeFloatParsing(const std::string &text, int method, double *checksum)
+{
+    const char *p = text.c_str();
+    const char *end = p + text.size();
+    double sum = 0.0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    while (p < end)
+    {
+        const char *token_end = (const char *)memchr(p, ' ', end - p);
+        if (token_end == NULL)
+            token_end = end;
+
+        float value = 0.0f;
+        if (method == 0)
+            ParseFloat(p, token_end, &value);
+        else if (method == 1)
+            value = strtof(p, NULL);
+        else
+            value = (float)strtod(p, NULL);
+        sum += value;
+        p = token_end + 1;
+    }
+    double seconds = SecondsSince(start);
+    *checksum = sum;
+    return seconds;
+}
+
+// Validação e velocidade de ParseFloat() (veja "floatparse.h") com N floats
+// aleatórios (1 milhão por padrão). Cada float é:
+//   - escrito com 9 dígitos e lido de volta, devendo resultar no mesmo
+//     float (ida e volta);
+//   - escrito com 1 a 9 dígitos, e como o ponto médio exato entre ele e o
+//     float seguinte, e lido por ParseFloat() e por strtof();
+// e números aleatórios com até 25 dígitos e expoentes em [-65, 45] também
+// são comparados com strtof(). Depois, textos com N números como os dos
+// arquivos OBJ ("%f") e com 9 dígitos são convertidos por ParseFloat(),
+// strtof() e strtod().
+//
+//     main --bench floats [N]
+static int Benchmark_Floats(int argc, char *argv[])
+{
+    int N = (argc >= 1) ? atoi(argv[0]) : 1000000;
+    if (N <= 0)
+        N = 1000000;
+
+    std::mt19937 random(1234);
+    std::uniform_int_distribution<uint32_t> bits_distribution;
+    char buffer[128];
+
+    const char *tests[4] = {"ida e volta", "1 a 9 dígitos", "ponto médio", "aleatórios"};
+    long long num_tests[4] = {0, 0, 0, 0};
+    long long num_failures[4] = {0, 0, 0, 0};
+
+    for (int i = 0; i < N; ++i)
+    {
+        uint32_t bits = bits_distribution(random);
+        float f;
+        memcpy(&f, &bits, sizeof(f));
+        if (!std::isfinite(f))
+            continue;
+
+        snprintf(buffer, sizeof(buffer), "%.9g", f);
+        float value = 0.0f;
+        bool ok = ParseFloat(buffer, buffer + strlen(buffer), &value) && memcmp(&value, &f, sizeof(f)) == 0;
+        num_tests[0] += 1;
+        num_failures[0] += ok ? 0 : 1;
+
+        snprintf(buffer, sizeof(buffer), "%.*g", 1 + (int)(random() % 9), f);
+        num_tests[1] += 1;
+        num_failures[1] += SameAsStrtof(buffer) ? 0 : 1;
+
+        // O ponto médio entre dois floats é exato em double, e é escrito com
+        // todos os seus dígitos: o caso mais difícil de arredondar
+        float next = nextafterf(f, INFINITY);
+        if (std::isfinite(next))
+        {
+            snprintf(buffer, sizeof(buffer), "%.70e", 0.5 * ((double)f + (double)next));
+            num_tests[2] += 1;
+            num_failures[2] += SameAsStrtof(buffer) ? 0 : 1;
+        }
+
+        int num_digits = 1 + (int)(random() % 25);
+        int dot = (int)(random() % (num_digits + 1));
+        std::string text = (random() % 2) ? "-" : "";
+        for (int d = 0; d < num_digits; ++d)
+        {
+            if (d == dot)
+                text += '.';
+            text += (char)('0' + random() % 10);
+        }
+        snprintf(buffer, sizeof(buffer), "e%d", (int)(random() % 111) - 65);
+        text += buffer;
+        num_tests[3] += 1;
+        num_failures[3] += SameAsStrtof(text.c_str()) ? 0 : 1;
+    }
+
+    int result = EXIT_SUCCESS;
+    printf("%16s %10s %8s\n", "validação", "testes", "falhas");
+    for (int t = 0; t < 4; ++t)
+    {
+        printf("%16s %10lld %8lld\n", tests[t], num_tests[t], num_failures[t]);
+        if (num_failures[t] != 0)
+            result = EXIT_FAILURE;
+    }
+
+    // Textos para a medida de velocidade: coordenadas como as dos arquivos
+    // OBJ, e floats aleatórios com 9 dígitos
+    std::string texts[2];
+    const char *text_names[2] = {"OBJ (%f)", "9 dígitos"};
+    std::uniform_real_distribution<float> coordinates(-10.0f, 10.0f);
+    for (int i = 0; i < N; ++i)
+    {
+        snprintf(buffer, sizeof(buffer), "%f ", coordinates(random));
+        texts[0] += buffer;
+
+        uint32_t bits = bits_distribution(random) & 0xBFFFFFFF; // Sem infinitos ou NaNs
+        float f;
+        memcpy(&f, &bits, sizeof(f));
+        snprintf(buffer, sizeof(buffer), "%.9g ", f);
+        texts[1] += buffer;
+    }
+
+    const char *methods[3] = {"ParseFloat", "strtof", "strtod"};
+    printf("%12s %12s %10s %8s %10s\n", "texto", "conversão", "ms", "MB/s", "ns/número");
+    for (int t = 0; t < 2; ++t)
+    {
+        double megabytes = texts[t].size() / (1024.0 * 1024.0);
+        double checksums[3];
+        for (int m = 0; m < 3; ++m)
+        {
+            double seconds = TimeFloatParsing(texts[t], m, &checksums[m]);
+            printf("%12s %12s %10.1f %8.1f %10.1f\n", text_names[t], methods[m], 1e3 * seconds, megabytes / seconds,
+                   1e9 * seconds / N);
+        }
+        if (checksums[0] != checksums[1])
+            result = EXIT_FAILURE;
+    }
+
+    return result;
+}
+
+int Benchmark_Run(int argc, char *argv[])
+{
+    if (argc >= 1 && strcmp(argv[0], "collisions") == 0)
+        return Benchmark_Collisions(argc - 1, argv + 1);
+    if (argc >= 1 && strcmp(argv[0], "narrowphase") == 0)
+        return Benchmark_NarrowPhase(argc - 1, argv + 1);
+    if (argc >= 1 && strcmp(argv[0], "text") == 0)
+        return Benchmark_Text(argc - 1, argv + 1);
+    if (argc >= 1 && strcmp(argv[0], "normals") == 0)
+        return Benchmark_Normals(argc - 1, argv + 1);
+    if (argc >= 1 && strcmp(argv[0], "obj") == 0)
+        return Benchmark_Obj(argc - 1, argv + 1);
+    if (argc >= 1 && strcmp(argv[0], "floats") == 0)
+        return Benchmark_Floats(argc - 1, argv + 1);
+
+    fprintf(stderr, "Usage: main --bench <collisions|narrowphase|text|normals|obj|floats> [N ...]\n");
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,105 @@
+#include "cachefile.h"
+
+#include <cstdio>
+#include <vector>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+uint64_t CacheFile_HashBytes(uint64_t h, const void *data, size_t size)
+{
+    const unsigned char *bytes = (const unsigned char *)data;
+    for (size_t i = 0; i < size; ++i)
+    {
+        h ^= bytes[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+bool CacheFile_Hash(const char *filename, uint64_t *hash)
+{
+    FILE *f = fopen(filename, "rb");
+    if (f == NULL)
+        return false;
+
+    uint64_t h = CACHE_FILE_HASH_SEED;
+    unsigned char buffer[64 * 1024];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0)
+        h = CacheFile_HashBytes(h, buffer, n);
+
+    fclose(f);
+    *hash = h;
+    return true;
+}
+
+bool CacheFile_Stat(const char *filename, uint64_t *size, int64_t *mtime)
+{
+    struct stat st;
+    if (stat(filename, &st) != 0)
+        return false;
+
+    *size = (uint64_t)st.st_size;
+#if defined(__APPLE__)
+    *mtime = (int64_t)st.st_mtimespec.tv_sec * 1000000000 + st.st_mtimespec.tv_nsec;
+#elif defined(__linux__)
+    *mtime = (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+#else
+    *mtime = (int64_t)st.st_mtime;
+#endif
+    return true;
+}
+
+bool CacheFile_SourceUnchanged(const char *filename, uint64_t size, int64_t mtime, uint64_t hash)
+{
+    uint64_t source_size;
+    int64_t source_mtime;
+    if (!CacheFile_Stat(filename, &source_size, &source_mtime) || source_size != size)
+        return false;
+    if (source_mtime == mtime)
+        return true;
+
+    uint64_t source_hash;
+    return CacheFile_Hash(filename, &source_hash) && source_hash == hash;
+}
+
+std::string CacheFile_Filename(const char *source_filename, const char *extension)
+{
+    std::string filename(source_filename);
+    size_t dot = filename.find_last_of('.');
+    size_t slash = filename.find_last_of("/\\");
+    if (dot != std::string::npos && (slash == std::string::npos || dot > slash))
+        filename.erase(dot);
+    return filename + extension;
+}
+
+bool CacheFile_Write(const char *filename, const void *header, size_t header_size,
+                     const CacheFileChunk *chunks, int num_chunks)
+{
+    FILE *f = fopen(filename, "wb");
+    if (f == NULL)
+    {
+        fprintf(stderr, "WARNING: Cannot write cache file \"%s\".\n", filename);
+        return false;
+    }
+
+    std::vector<unsigned char> placeholder(header_size, 0);
+
+    bool ok = fwrite(placeholder.data(), header_size, 1, f) == 1;
+    for (int i = 0; ok && i < num_chunks; ++i)
+        if (chunks[i].size > 0)
+            ok = fwrite(chunks[i].data, 1, chunks[i].size, f) == chunks[i].size;
+    if (ok)
+        ok = fseek(f, 0, SEEK_SET) == 0 && fwrite(header, header_size, 1, f) == 1;
+
+    ok = (fclose(f) == 0) && ok;
+
+    if (!ok)
+    {
+        fprintf(stderr, "WARNING: Cannot write cache file \"%s\".\n", filename);
+        remove(filename);
+    }
+
+    return ok;
+}
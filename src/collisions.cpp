@@ -1,5 +1,27 @@
 #include "collisions.h"
 
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define COLLISIONS_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// Permite compilar funes com instrues SSE/AVX2 sem exigir estas
+// instrues no resto do programa; a funo s  chamada se o processador
+// as suportar (veja CollisionKernels_Supported()).
+#if defined(__GNUC__)
+#define COLLISIONS_TARGET(x) __attribute__((target(x)))
+#else
+#define COLLISIONS_TARGET(x)
+#endif
+
 bool SpaceshipAsteroidCollision(HitBox SpaceshipHitBox, HitBox AsteroidHitBox){
     // Verifica a coliso entre duas caixas delimitadas (hit boxes)
     if (SpaceshipHitBox.maxPoint.x < AsteroidHitBox.minPoint.x ||
@@ -67,3 +89,631 @@ bool SpaceshipUniverseCollision(HitBox SpaceshipHitBox, float limit){
 
 }
 
+// Aloca "size" bytes alinhados em 32 bytes. O ponteiro original retornado
+// por malloc()  guardado imediatamente antes do bloco alinhado.
+static void *AlignedAlloc(size_t size){
+    void *memory = malloc(size + 32 + sizeof(void *));
+    if (memory == NULL)
+        return NULL;
+    uintptr_t aligned = ((uintptr_t)memory + sizeof(void *) + 31) & ~(uintptr_t)31;
+    ((void **)aligned)[-1] = memory;
+    return (void *)aligned;
+}
+
+static void AlignedFree(void *aligned){
+    if (aligned != NULL)
+        free(((void **)aligned)[-1]);
+}
+
+// Realoca "num_arrays" vetores de floats consecutivos em um nico bloco, com
+// "capacity" elementos cada, preservando os "count" primeiros. Os ponteiros
+// de "arrays" so atualizados.
+static void *ResizeArrays(void *memory, float **arrays[], int num_arrays, size_t count, size_t capacity){
+    float *block = (float *)AlignedAlloc(num_arrays * capacity * sizeof(float));
+    if (block == NULL) {
+        fprintf(stderr, "ERROR: Out of memory in collision arrays.\n");
+        std::exit(EXIT_FAILURE);
+    }
+    for (int a = 0; a < num_arrays; ++a) {
+        if (count > 0)
+            memcpy(block + a * capacity, *arrays[a], count * sizeof(float));
+        *arrays[a] = block + a * capacity;
+    }
+    AlignedFree(memory);
+    return block;
+}
+
+// Capacidade mltipla de 8 (um registrador AVX de floats)
+static size_t PaddedCapacity(size_t count, size_t capacity){
+    if (count <= capacity)
+        return capacity;
+    size_t new_capacity = capacity < 64 ? 64 : capacity;
+    while (new_capacity < count)
+        new_capacity *= 2;
+    return (new_capacity + 7) & ~(size_t)7;
+}
+
+void HitBoxSoA_Init(HitBoxSoA *boxes){
+    memset(boxes, 0, sizeof(*boxes));
+}
+
+void HitBoxSoA_Free(HitBoxSoA *boxes){
+    AlignedFree(boxes->memory);
+    HitBoxSoA_Init(boxes);
+}
+
+void HitBoxSoA_SetEmpty(HitBoxSoA *boxes, size_t index){
+    // Uma caixa com mnimo +infinito e mximo -infinito no colide com nada
+    const float inf = std::numeric_limits<float>::infinity();
+    boxes->min_x[index] = boxes->min_y[index] = boxes->min_z[index] = inf;
+    boxes->max_x[index] = boxes->max_y[index] = boxes->max_z[index] = -inf;
+}
+
+void HitBoxSoA_Resize(HitBoxSoA *boxes, size_t count){
+    size_t capacity = PaddedCapacity(count, boxes->capacity);
+    if (capacity != boxes->capacity) {
+        float **arrays[6] = {&boxes->min_x, &boxes->min_y, &boxes->min_z, &boxes->max_x, &boxes->max_y, &boxes->max_z};
+        boxes->memory = ResizeArrays(boxes->memory, arrays, 6, boxes->count < count ? boxes->count : count, capacity);
+        for (size_t i = boxes->count; i < capacity; ++i)
+            HitBoxSoA_SetEmpty(boxes, i);
+        boxes->capacity = capacity;
+    }
+    // As posies alm de "count" so sempre vazias
+    for (size_t i = count; i < boxes->count; ++i)
+        HitBoxSoA_SetEmpty(boxes, i);
+    boxes->count = count;
+}
+
+void HitBoxSoA_Set(HitBoxSoA *boxes, size_t index, HitBox box){
+    boxes->min_x[index] = box.minPoint.x;
+    boxes->min_y[index] = box.minPoint.y;
+    boxes->min_z[index] = box.minPoint.z;
+    boxes->max_x[index] = box.maxPoint.x;
+    boxes->max_y[index] = box.maxPoint.y;
+    boxes->max_z[index] = box.maxPoint.z;
+}
+
+void HitBoxSoA_Push(HitBoxSoA *boxes, HitBox box){
+    HitBoxSoA_Resize(boxes, boxes->count + 1);
+    HitBoxSoA_Set(boxes, boxes->count - 1, box);
+}
+
+void HitSphereSoA_Init(HitSphereSoA *spheres){
+    memset(spheres, 0, sizeof(*spheres));
+}
+
+void HitSphereSoA_Free(HitSphereSoA *spheres){
+    AlignedFree(spheres->memory);
+    HitSphereSoA_Init(spheres);
+}
+
+// Uma esfera de raio zero no infinito no colide com nada
+static void HitSphereSoA_SetEmpty(HitSphereSoA *spheres, size_t index){
+    const float inf = std::numeric_limits<float>::infinity();
+    spheres->center_x[index] = spheres->center_y[index] = spheres->center_z[index] = inf;
+    spheres->radius[index] = 0.0f;
+}
+
+void HitSphereSoA_Resize(HitSphereSoA *spheres, size_t count){
+    size_t capacity = PaddedCapacity(count, spheres->capacity);
+    if (capacity != spheres->capacity) {
+        float **arrays[4] = {&spheres->center_x, &spheres->center_y, &spheres->center_z, &spheres->radius};
+        spheres->memory = ResizeArrays(spheres->memory, arrays, 4, spheres->count < count ? spheres->count : count, capacity);
+        for (size_t i = spheres->count; i < capacity; ++i)
+            HitSphereSoA_SetEmpty(spheres, i);
+        spheres->capacity = capacity;
+    }
+    // As posies alm de "count" so sempre vazias
+    for (size_t i = count; i < spheres->count; ++i)
+        HitSphereSoA_SetEmpty(spheres, i);
+    spheres->count = count;
+}
+
+void HitSphereSoA_Set(HitSphereSoA *spheres, size_t index, HitSphere sphere){
+    spheres->center_x[index] = sphere.center.x;
+    spheres->center_y[index] = sphere.center.y;
+    spheres->center_z[index] = sphere.center.z;
+    spheres->radius[index] = sphere.radius;
+}
+
+void HitSphereSoA_Push(HitSphereSoA *spheres, HitSphere sphere){
+    HitSphereSoA_Resize(spheres, spheres->count + 1);
+    HitSphereSoA_Set(spheres, spheres->count - 1, sphere);
+}
+
+// Nmero de bits 1 de uma palavra
+static int PopCount(uint64_t x){
+#if defined(__GNUC__)
+    return __builtin_popcountll(x);
+#else
+    int n = 0;
+    while (x != 0) {
+        x &= x - 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+// Verses escalares: testam um corpo de cada vez, com a mesma lgica de
+// SpaceshipAsteroidCollision() e SpaceshipMoonCollision().
+static size_t HitBox_OverlapBatch_Scalar(const HitBoxSoA *boxes, HitBox query, uint64_t *mask){
+    size_t hits = 0;
+    memset(mask, 0, CollisionMask_Words(boxes->count) * sizeof(uint64_t));
+    for (size_t i = 0; i < boxes->count; ++i) {
+        if (boxes->min_x[i] <= query.maxPoint.x && boxes->max_x[i] >= query.minPoint.x &&
+            boxes->min_y[i] <= query.maxPoint.y && boxes->max_y[i] >= query.minPoint.y &&
+            boxes->min_z[i] <= query.maxPoint.z && boxes->max_z[i] >= query.minPoint.z) {
+            mask[i / 64] |= (uint64_t)1 << (i % 64);
+            ++hits;
+        }
+    }
+    return hits;
+}
+
+static size_t HitSphere_OverlapBatch_Scalar(const HitSphereSoA *spheres, HitBox query, uint64_t *mask){
+    size_t hits = 0;
+    memset(mask, 0, CollisionMask_Words(spheres->count) * sizeof(uint64_t));
+    for (size_t i = 0; i < spheres->count; ++i) {
+        glm::vec3 center(spheres->center_x[i], spheres->center_y[i], spheres->center_z[i]);
+        glm::vec3 closestPoint = glm::clamp(center, query.minPoint, query.maxPoint);
+        glm::vec3 offset = center - closestPoint;
+        if (glm::dot(offset, offset) <= spheres->radius[i] * spheres->radius[i]) {
+            mask[i / 64] |= (uint64_t)1 << (i % 64);
+            ++hits;
+        }
+    }
+    return hits;
+}
+
+#ifdef COLLISIONS_X86
+
+// Verses SSE: 4 corpos por iterao. As colees tm capacidade mltipla de
+// 8 e as posies alm de "count" so vazias, ento no h resto a tratar.
+COLLISIONS_TARGET("sse2")
+static size_t HitBox_OverlapBatch_SSE(const HitBoxSoA *boxes, HitBox query, uint64_t *mask){
+    const __m128 qmin_x = _mm_set1_ps(query.minPoint.x), qmax_x = _mm_set1_ps(query.maxPoint.x);
+    const __m128 qmin_y = _mm_set1_ps(query.minPoint.y), qmax_y = _mm_set1_ps(query.maxPoint.y);
+    const __m128 qmin_z = _mm_set1_ps(query.minPoint.z), qmax_z = _mm_set1_ps(query.maxPoint.z);
+
+    size_t hits = 0;
+    size_t words = CollisionMask_Words(boxes->count);
+    for (size_t w = 0; w < words; ++w) {
+        uint64_t bits = 0;
+        size_t end = (w + 1) * 64 < boxes->capacity ? (w + 1) * 64 : boxes->capacity;
+        for (size_t i = w * 64; i < end; i += 4) {
+            __m128 overlap = _mm_and_ps(_mm_cmple_ps(_mm_load_ps(boxes->min_x + i), qmax_x),
+                                        _mm_cmpge_ps(_mm_load_ps(boxes->max_x + i), qmin_x));
+            overlap = _mm_and_ps(overlap, _mm_cmple_ps(_mm_load_ps(boxes->min_y + i), qmax_y));
+            overlap = _mm_and_ps(overlap, _mm_cmpge_ps(_mm_load_ps(boxes->max_y + i), qmin_y));
+            overlap = _mm_and_ps(overlap, _mm_cmple_ps(_mm_load_ps(boxes->min_z + i), qmax_z));
+            overlap = _mm_and_ps(overlap, _mm_cmpge_ps(_mm_load_ps(boxes->max_z + i), qmin_z));
+            bits |= (uint64_t)_mm_movemask_ps(overlap) << (i % 64);
+        }
+        mask[w] = bits;
+        hits += PopCount(bits);
+    }
+    return hits;
+}
+
+COLLISIONS_TARGET("sse2")
+static size_t HitSphere_OverlapBatch_SSE(const HitSphereSoA *spheres, HitBox query, uint64_t *mask){
+    const __m128 qmin_x = _mm_set1_ps(query.minPoint.x), qmax_x = _mm_set1_ps(query.maxPoint.x);
+    const __m128 qmin_y = _mm_set1_ps(query.minPoint.y), qmax_y = _mm_set1_ps(query.maxPoint.y);
+    const __m128 qmin_z = _mm_set1_ps(query.minPoint.z), qmax_z = _mm_set1_ps(query.maxPoint.z);
+    const __m128 zero = _mm_setzero_ps();
+
+    size_t hits = 0;
+    size_t words = CollisionMask_Words(spheres->count);
+    for (size_t w = 0; w < words; ++w) {
+        uint64_t bits = 0;
+        size_t end = (w + 1) * 64 < spheres->capacity ? (w + 1) * 64 : spheres->capacity;
+        for (size_t i = w * 64; i < end; i += 4) {
+            // Distncia do centro at a caixa em cada eixo: zero se o centro
+            // est dentro do intervalo da caixa.
+            __m128 cx = _mm_load_ps(spheres->center_x + i);
+            __m128 cy = _mm_load_ps(spheres->center_y + i);
+            __m128 cz = _mm_load_ps(spheres->center_z + i);
+            __m128 dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(qmin_x, cx), _mm_sub_ps(cx, qmax_x)), zero);
+            __m128 dy = _mm_max_ps(_mm_max_ps(_mm_sub_ps(qmin_y, cy), _mm_sub_ps(cy, qmax_y)), zero);
+            __m128 dz = _mm_max_ps(_mm_max_ps(_mm_sub_ps(qmin_z, cz), _mm_sub_ps(cz, qmax_z)), zero);
+            __m128 distance2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+            __m128 r = _mm_load_ps(spheres->radius + i);
+            bits |= (uint64_t)_mm_movemask_ps(_mm_cmple_ps(distance2, _mm_mul_ps(r, r))) << (i % 64);
+        }
+        mask[w] = bits;
+        hits += PopCount(bits);
+    }
+    return hits;
+}
+
+// Verses AVX2: 8 corpos por iterao.
+COLLISIONS_TARGET("avx2")
+static size_t HitBox_OverlapBatch_AVX2(const HitBoxSoA *boxes, HitBox query, uint64_t *mask){
+    const __m256 qmin_x = _mm256_set1_ps(query.minPoint.x), qmax_x = _mm256_set1_ps(query.maxPoint.x);
+    const __m256 qmin_y = _mm256_set1_ps(query.minPoint.y), qmax_y = _mm256_set1_ps(query.maxPoint.y);
+    const __m256 qmin_z = _mm256_set1_ps(query.minPoint.z), qmax_z = _mm256_set1_ps(query.maxPoint.z);
+
+    size_t hits = 0;
+    size_t words = CollisionMask_Words(boxes->count);
+    for (size_t w = 0; w < words; ++w) {
+        uint64_t bits = 0;
+        size_t end = (w + 1) * 64 < boxes->capacity ? (w + 1) * 64 : boxes->capacity;
+        for (size_t i = w * 64; i < end; i += 8) {
+            __m256 overlap = _mm256_and_ps(_mm256_cmp_ps(_mm256_load_ps(boxes->min_x + i), qmax_x, _CMP_LE_OQ),
+                                           _mm256_cmp_ps(_mm256_load_ps(boxes->max_x + i), qmin_x, _CMP_GE_OQ));
+            overlap = _mm256_and_ps(overlap, _mm256_cmp_ps(_mm256_load_ps(boxes->min_y + i), qmax_y, _CMP_LE_OQ));
+            overlap = _mm256_and_ps(overlap, _mm256_cmp_ps(_mm256_load_ps(boxes->max_y + i), qmin_y, _CMP_GE_OQ));
+            overlap = _mm256_and_ps(overlap, _mm256_cmp_ps(_mm256_load_ps(boxes->min_z + i), qmax_z, _CMP_LE_OQ));
+            overlap = _mm256_and_ps(overlap, _mm256_cmp_ps(_mm256_load_ps(boxes->max_z + i), qmin_z, _CMP_GE_OQ));
+            bits |= (uint64_t)_mm256_movemask_ps(overlap) << (i % 64);
+        }
+        mask[w] = bits;
+        hits += PopCount(bits);
+    }
+    return hits;
+}
+
+COLLISIONS_TARGET("avx2")
+static size_t HitSphere_OverlapBatch_AVX2(const HitSphereSoA *spheres, HitBox query, uint64_t *mask){
+    const __m256 qmin_x = _mm256_set1_ps(query.minPoint.x), qmax_x = _mm256_set1_ps(query.maxPoint.x);
+    const __m256 qmin_y = _mm256_set1_ps(query.minPoint.y), qmax_y = _mm256_set1_ps(query.maxPoint.y);
+    const __m256 qmin_z = _mm256_set1_ps(query.minPoint.z), qmax_z = _mm256_set1_ps(query.maxPoint.z);
+    const __m256 zero = _mm256_setzero_ps();
+
+    size_t hits = 0;
+    size_t words = CollisionMask_Words(spheres->count);
+    for (size_t w = 0; w < words; ++w) {
+        uint64_t bits = 0;
+        size_t end = (w + 1) * 64 < spheres->capacity ? (w + 1) * 64 : spheres->capacity;
+        for (size_t i = w * 64; i < end; i += 8) {
+            __m256 cx = _mm256_load_ps(spheres->center_x + i);
+            __m256 cy = _mm256_load_ps(spheres->center_y + i);
+            __m256 cz = _mm256_load_ps(spheres->center_z + i);
+            __m256 dx = _mm256_max_ps(_mm256_max_ps(_mm256_sub_ps(qmin_x, cx), _mm256_sub_ps(cx, qmax_x)), zero);
+            __m256 dy = _mm256_max_ps(_mm256_max_ps(_mm256_sub_ps(qmin_y, cy), _mm256_sub_ps(cy, qmax_y)), zero);
+            __m256 dz = _mm256_max_ps(_mm256_max_ps(_mm256_sub_ps(qmin_z, cz), _mm256_sub_ps(cz, qmax_z)), zero);
+            __m256 distance2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+            __m256 r = _mm256_load_ps(spheres->radius + i);
+            bits |= (uint64_t)_mm256_movemask_ps(_mm256_cmp_ps(distance2, _mm256_mul_ps(r, r), _CMP_LE_OQ)) << (i % 64);
+        }
+        mask[w] = bits;
+        hits += PopCount(bits);
+    }
+    return hits;
+}
+
+#endif // COLLISIONS_X86
+
+bool CollisionKernels_Supported(int kernels){
+    if (kernels == COLLISION_KERNELS_SCALAR)
+        return true;
+#if defined(COLLISIONS_X86) && defined(__GNUC__)
+    __builtin_cpu_init();
+    if (kernels == COLLISION_KERNELS_SSE)
+        return __builtin_cpu_supports("sse2");
+    if (kernels == COLLISION_KERNELS_AVX2)
+        return __builtin_cpu_supports("avx2");
+#elif defined(COLLISIONS_X86) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    if (kernels == COLLISION_KERNELS_SSE)
+        return (info[3] & (1 << 26)) != 0;
+    if (kernels == COLLISION_KERNELS_AVX2) {
+        // AVX exige tambm que o sistema operacional salve os registradores
+        // YMM (OSXSAVE e XCR0).
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        if (!osxsave || (_xgetbv(0) & 6) != 6)
+            return false;
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+    }
+#endif
+    return false;
+}
+
+static int g_CollisionKernels = -1; // -1: ainda no escolhida
+
+bool CollisionKernels_Select(int kernels){
+    if (!CollisionKernels_Supported(kernels))
+        return false;
+    g_CollisionKernels = kernels;
+    return true;
+}
+
+int CollisionKernels_Selected(){
+    if (g_CollisionKernels < 0) {
+        if (CollisionKernels_Supported(COLLISION_KERNELS_AVX2))
+            g_CollisionKernels = COLLISION_KERNELS_AVX2;
+        else if (CollisionKernels_Supported(COLLISION_KERNELS_SSE))
+            g_CollisionKernels = COLLISION_KERNELS_SSE;
+        else
+            g_CollisionKernels = COLLISION_KERNELS_SCALAR;
+    }
+    return g_CollisionKernels;
+}
+
+const char *CollisionKernels_Name(int kernels){
+    switch (kernels) {
+        case COLLISION_KERNELS_SSE: return "SSE";
+        case COLLISION_KERNELS_AVX2: return "AVX2";
+        default: return "escalar";
+    }
+}
+
+size_t HitBox_OverlapBatch(const HitBoxSoA *boxes, HitBox query, uint64_t *mask){
+    switch (CollisionKernels_Selected()) {
+#ifdef COLLISIONS_X86
+        case COLLISION_KERNELS_SSE: return HitBox_OverlapBatch_SSE(boxes, query, mask);
+        case COLLISION_KERNELS_AVX2: return HitBox_OverlapBatch_AVX2(boxes, query, mask);
+#endif
+        default: return HitBox_OverlapBatch_Scalar(boxes, query, mask);
+    }
+}
+
+size_t HitSphere_OverlapBatch(const HitSphereSoA *spheres, HitBox query, uint64_t *mask){
+    switch (CollisionKernels_Selected()) {
+#ifdef COLLISIONS_X86
+        case COLLISION_KERNELS_SSE: return HitSphere_OverlapBatch_SSE(spheres, query, mask);
+        case COLLISION_KERNELS_AVX2: return HitSphere_OverlapBatch_AVX2(spheres, query, mask);
+#endif
+        default: return HitSphere_OverlapBatch_Scalar(spheres, query, mask);
+    }
+}
+
+// Nmero mximo de clulas que um corpo pode ocupar na grade. Corpos maiores
+// (ex: a lua) ficam em CollisionWorld::large_bodies.
+static const long long MAX_BODY_CELLS = 64;
+
+static glm::ivec3 CellOf(const CollisionWorld *world, glm::vec3 point){
+    return glm::ivec3(glm::floor(point / world->cell_size));
+}
+
+// Chave de uma clula na tabela hash, com 21 bits por coordenada.
+static uint64_t CellKey(int x, int y, int z){
+    return ((uint64_t)(x & 0x1FFFFF) << 42) | ((uint64_t)(y & 0x1FFFFF) << 21) | (uint64_t)(z & 0x1FFFFF);
+}
+
+static long long CellCount(glm::ivec3 cell_min, glm::ivec3 cell_max){
+    return (long long)(cell_max.x - cell_min.x + 1) *
+           (long long)(cell_max.y - cell_min.y + 1) *
+           (long long)(cell_max.z - cell_min.z + 1);
+}
+
+// Posio do bit 1 menos significativo de uma palavra no nula
+static int LowestBit(uint64_t x){
+#if defined(__GNUC__)
+    return __builtin_ctzll(x);
+#else
+    int n = 0;
+    while ((x & 1) == 0) {
+        x >>= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+// Remove o ndice "id" de uma lista, sem preservar a ordem.
+static void EraseId(std::vector<int> &ids, int id){
+    for (size_t i = 0; i < ids.size(); ++i) {
+        if (ids[i] == id) {
+            ids[i] = ids.back();
+            ids.pop_back();
+            return;
+        }
+    }
+}
+
+// Insere um corpo nas clulas da grade que sua caixa ocupa.
+static void InsertIntoGrid(CollisionWorld *world, int id){
+    CollisionBody &body = world->bodies[id];
+    body.cell_min = CellOf(world, body.box.minPoint);
+    body.cell_max = CellOf(world, body.box.maxPoint);
+    body.large = CellCount(body.cell_min, body.cell_max) > MAX_BODY_CELLS;
+
+    if (body.large) {
+        HitBoxSoA_SetEmpty(&world->grid_boxes, id);
+        world->large_bodies.push_back(id);
+        return;
+    }
+
+    HitBoxSoA_Set(&world->grid_boxes, id, body.box);
+
+    for (int x = body.cell_min.x; x <= body.cell_max.x; ++x)
+        for (int y = body.cell_min.y; y <= body.cell_max.y; ++y)
+            for (int z = body.cell_min.z; z <= body.cell_max.z; ++z)
+                world->cells[CellKey(x, y, z)].push_back(id);
+}
+
+// Remove um corpo das clulas em que ele foi inserido por InsertIntoGrid().
+// Clulas que ficam vazias so descartadas.
+static void RemoveFromGrid(CollisionWorld *world, int id){
+    const CollisionBody &body = world->bodies[id];
+
+    if (body.large) {
+        EraseId(world->large_bodies, id);
+        return;
+    }
+
+    HitBoxSoA_SetEmpty(&world->grid_boxes, id);
+
+    for (int x = body.cell_min.x; x <= body.cell_max.x; ++x)
+        for (int y = body.cell_min.y; y <= body.cell_max.y; ++y)
+            for (int z = body.cell_min.z; z <= body.cell_max.z; ++z) {
+                std::unordered_map<uint64_t, std::vector<int> >::iterator cell = world->cells.find(CellKey(x, y, z));
+                if (cell == world->cells.end())
+                    continue;
+                EraseId(cell->second, id);
+                if (cell->second.empty())
+                    world->cells.erase(cell);
+            }
+}
+
+static int AddBody(CollisionWorld *world, const CollisionBody &body){
+    int id;
+    if (!world->free_bodies.empty()) {
+        id = world->free_bodies.back();
+        world->free_bodies.pop_back();
+        world->bodies[id] = body;
+    } else {
+        id = (int)world->bodies.size();
+        world->bodies.push_back(body);
+        HitBoxSoA_Resize(&world->grid_boxes, world->bodies.size());
+    }
+
+    InsertIntoGrid(world, id);
+    return id;
+}
+
+// Atualiza a grade aps a caixa de um corpo mudar. Se o corpo continua nas
+// mesmas clulas, nada precisa ser feito.
+static void UpdateBody(CollisionWorld *world, int id){
+    CollisionBody &body = world->bodies[id];
+    glm::ivec3 cell_min = CellOf(world, body.box.minPoint);
+    glm::ivec3 cell_max = CellOf(world, body.box.maxPoint);
+    if (!body.large && cell_min == body.cell_min && cell_max == body.cell_max) {
+        HitBoxSoA_Set(&world->grid_boxes, id, body.box);
+        return;
+    }
+
+    RemoveFromGrid(world, id);
+    InsertIntoGrid(world, id);
+}
+
+void CollisionWorld_Init(CollisionWorld *world, float cell_size){
+    world->cell_size = cell_size;
+    HitBoxSoA_Init(&world->grid_boxes);
+    CollisionWorld_Clear(world);
+}
+
+void CollisionWorld_Free(CollisionWorld *world){
+    CollisionWorld_Clear(world);
+    HitBoxSoA_Free(&world->grid_boxes);
+}
+
+void CollisionWorld_Clear(CollisionWorld *world){
+    world->bodies.clear();
+    world->free_bodies.clear();
+    world->cells.clear();
+    world->large_bodies.clear();
+    world->query_stamp = 0;
+    HitBoxSoA_Resize(&world->grid_boxes, 0);
+}
+
+int CollisionWorld_AddBox(CollisionWorld *world, HitBox box, int kind, int user_data){
+    CollisionBody body;
+    body.shape = COLLISION_BOX;
+    body.box = box;
+    body.sphere.center = (box.minPoint + box.maxPoint) * 0.5f;
+    body.sphere.radius = 0.0f;
+    body.kind = kind;
+    body.user_data = user_data;
+    body.active = true;
+    body.query_stamp = 0;
+    return AddBody(world, body);
+}
+
+int CollisionWorld_AddSphere(CollisionWorld *world, HitSphere sphere, int kind, int user_data){
+    CollisionBody body;
+    body.shape = COLLISION_SPHERE;
+    body.box.minPoint = sphere.center - glm::vec3(sphere.radius);
+    body.box.maxPoint = sphere.center + glm::vec3(sphere.radius);
+    body.sphere = sphere;
+    body.kind = kind;
+    body.user_data = user_data;
+    body.active = true;
+    body.query_stamp = 0;
+    return AddBody(world, body);
+}
+
+void CollisionWorld_Remove(CollisionWorld *world, int body){
+    if (!world->bodies[body].active)
+        return;
+
+    RemoveFromGrid(world, body);
+    world->bodies[body].active = false;
+    world->free_bodies.push_back(body);
+}
+
+void CollisionWorld_MoveBox(CollisionWorld *world, int body, HitBox box){
+    // Um corpo removido no est na grade e no deve ser reinserido
+    if (!world->bodies[body].active)
+        return;
+
+    world->bodies[body].box = box;
+    world->bodies[body].sphere.center = (box.minPoint + box.maxPoint) * 0.5f;
+    UpdateBody(world, body);
+}
+
+void CollisionWorld_MoveSphere(CollisionWorld *world, int body, HitSphere sphere){
+    if (!world->bodies[body].active)
+        return;
+
+    world->bodies[body].sphere = sphere;
+    world->bodies[body].box.minPoint = sphere.center - glm::vec3(sphere.radius);
+    world->bodies[body].box.maxPoint = sphere.center + glm::vec3(sphere.radius);
+    UpdateBody(world, body);
+}
+
+void CollisionWorld_QueryCandidates(CollisionWorld *world, HitBox query, std::vector<int> *candidates){
+    // Cada consulta usa um novo "carimbo", de modo que um corpo presente em
+    // vrias clulas seja retornado somente uma vez.
+    world->query_stamp += 1;
+    if (world->query_stamp == 0) {
+        for (size_t i = 0; i < world->bodies.size(); ++i)
+            world->bodies[i].query_stamp = 0;
+        world->query_stamp = 1;
+    }
+
+    glm::ivec3 cell_min = CellOf(world, query.minPoint);
+    glm::ivec3 cell_max = CellOf(world, query.maxPoint);
+
+    if (CellCount(cell_min, cell_max) > (long long)world->cells.size()) {
+        // A consulta cobre mais clulas do que existem na tabela:  mais
+        // barato testar todos os corpos da grade de uma vez. Corpos removidos
+        // e corpos grandes tm caixas vazias em "grid_boxes".
+        world->grid_mask.resize(CollisionMask_Words(world->grid_boxes.count));
+        HitBox_OverlapBatch(&world->grid_boxes, query, world->grid_mask.data());
+        for (size_t w = 0; w < world->grid_mask.size(); ++w)
+            for (uint64_t bits = world->grid_mask[w]; bits != 0; bits &= bits - 1)
+                candidates->push_back((int)(w * 64 + LowestBit(bits)));
+    } else {
+        for (int x = cell_min.x; x <= cell_max.x; ++x)
+            for (int y = cell_min.y; y <= cell_max.y; ++y)
+                for (int z = cell_min.z; z <= cell_max.z; ++z) {
+                    std::unordered_map<uint64_t, std::vector<int> >::const_iterator cell = world->cells.find(CellKey(x, y, z));
+                    if (cell == world->cells.end())
+                        continue;
+
+                    const std::vector<int> &ids = cell->second;
+                    for (size_t i = 0; i < ids.size(); ++i) {
+                        CollisionBody &body = world->bodies[ids[i]];
+                        if (body.query_stamp != world->query_stamp) {
+                            body.query_stamp = world->query_stamp;
+                            candidates->push_back(ids[i]);
+                        }
+                    }
+                }
+    }
+
+    candidates->insert(candidates->end(), world->large_bodies.begin(), world->large_bodies.end());
+}
+
+int CollisionWorld_Collide(CollisionWorld *world, HitBox query, std::vector<int> *hits){
+    size_t first = hits->size();
+    CollisionWorld_QueryCandidates(world, query, hits);
+
+    // Mantemos somente os candidatos que realmente colidem com a caixa
+    size_t count = first;
+    for (size_t i = first; i < hits->size(); ++i) {
+        const CollisionBody &body = world->bodies[(*hits)[i]];
+        bool collides = (body.shape == COLLISION_SPHERE) ? SpaceshipMoonCollision(query, body.sphere)
+                                                         : SpaceshipAsteroidCollision(query, body.box);
+        if (collides)
+            (*hits)[count++] = (*hits)[i];
+    }
+    hits->resize(count);
+
+    return (int)(count - first);
+}
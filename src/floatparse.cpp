@@ -0,0 +1,391 @@
+#include "floatparse.h"
+
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Limites do formato binary32: abaixo de 10^-65 qualquer número com até 19
+// dígitos arredonda para zero, e acima de 10^38 para infinito
+#define FLOAT_MIN_POWER10 (-65)
+#define FLOAT_MAX_POWER10 38
+
+// 5^q, para q em [FLOAT_MIN_POWER10, FLOAT_MAX_POWER10], com 128 bits
+// (parte alta, parte baixa), normalizado para que o bit mais significativo
+// seja 1. Potências negativas são arredondadas para cima, positivas para
+// baixo, como nas tabelas publicadas com o algoritmo de Eisel-Lemire.
+static const uint64_t g_PowersOfFive[FLOAT_MAX_POWER10 - FLOAT_MIN_POWER10 + 1][2] = {
+    {0x86ccbb52ea94baeaULL, 0x98e947129fc2b4e9ULL}, // 5^-65
+    {0xa87fea27a539e9a5ULL, 0x3f2398d747b36224ULL}, // 5^-64
+    {0xd29fe4b18e88640eULL, 0x8eec7f0d19a03aadULL}, // 5^-63
+    {0x83a3eeeef9153e89ULL, 0x1953cf68300424acULL}, // 5^-62
+    {0xa48ceaaab75a8e2bULL, 0x5fa8c3423c052dd7ULL}, // 5^-61
+    {0xcdb02555653131b6ULL, 0x3792f412cb06794dULL}, // 5^-60
+    {0x808e17555f3ebf11ULL, 0xe2bbd88bbee40bd0ULL}, // 5^-59
+    {0xa0b19d2ab70e6ed6ULL, 0x5b6aceaeae9d0ec4ULL}, // 5^-58
+    {0xc8de047564d20a8bULL, 0xf245825a5a445275ULL}, // 5^-57
+    {0xfb158592be068d2eULL, 0xeed6e2f0f0d56712ULL}, // 5^-56
+    {0x9ced737bb6c4183dULL, 0x55464dd69685606bULL}, // 5^-55
+    {0xc428d05aa4751e4cULL, 0xaa97e14c3c26b886ULL}, // 5^-54
+    {0xf53304714d9265dfULL, 0xd53dd99f4b3066a8ULL}, // 5^-53
+    {0x993fe2c6d07b7fabULL, 0xe546a8038efe4029ULL}, // 5^-52
+    {0xbf8fdb78849a5f96ULL, 0xde98520472bdd033ULL}, // 5^-51
+    {0xef73d256a5c0f77cULL, 0x963e66858f6d4440ULL}, // 5^-50
+    {0x95a8637627989aadULL, 0xdde7001379a44aa8ULL}, // 5^-49
+    {0xbb127c53b17ec159ULL, 0x5560c018580d5d52ULL}, // 5^-48
+    {0xe9d71b689dde71afULL, 0xaab8f01e6e10b4a6ULL}, // 5^-47
+    {0x9226712162ab070dULL, 0xcab3961304ca70e8ULL}, // 5^-46
+    {0xb6b00d69bb55c8d1ULL, 0x3d607b97c5fd0d22ULL}, // 5^-45
+    {0xe45c10c42a2b3b05ULL, 0x8cb89a7db77c506aULL}, // 5^-44
+    {0x8eb98a7a9a5b04e3ULL, 0x77f3608e92adb242ULL}, // 5^-43
+    {0xb267ed1940f1c61cULL, 0x55f038b237591ed3ULL}, // 5^-42
+    {0xdf01e85f912e37a3ULL, 0x6b6c46dec52f6688ULL}, // 5^-41
+    {0x8b61313bbabce2c6ULL, 0x2323ac4b3b3da015ULL}, // 5^-40
+    {0xae397d8aa96c1b77ULL, 0xabec975e0a0d081aULL}, // 5^-39
+    {0xd9c7dced53c72255ULL, 0x96e7bd358c904a21ULL}, // 5^-38
+    {0x881cea14545c7575ULL, 0x7e50d64177da2e54ULL}, // 5^-37
+    {0xaa242499697392d2ULL, 0xdde50bd1d5d0b9e9ULL}, // 5^-36
+    {0xd4ad2dbfc3d07787ULL, 0x955e4ec64b44e864ULL}, // 5^-35
+    {0x84ec3c97da624ab4ULL, 0xbd5af13bef0b113eULL}, // 5^-34
+    {0xa6274bbdd0fadd61ULL, 0xecb1ad8aeacdd58eULL}, // 5^-33
+    {0xcfb11ead453994baULL, 0x67de18eda5814af2ULL}, // 5^-32
+    {0x81ceb32c4b43fcf4ULL, 0x80eacf948770ced7ULL}, // 5^-31
+    {0xa2425ff75e14fc31ULL, 0xa1258379a94d028dULL}, // 5^-30
+    {0xcad2f7f5359a3b3eULL, 0x096ee45813a04330ULL}, // 5^-29
+    {0xfd87b5f28300ca0dULL, 0x8bca9d6e188853fcULL}, // 5^-28
+    {0x9e74d1b791e07e48ULL, 0x775ea264cf55347eULL}, // 5^-27
+    {0xc612062576589ddaULL, 0x95364afe032a819eULL}, // 5^-26
+    {0xf79687aed3eec551ULL, 0x3a83ddbd83f52205ULL}, // 5^-25
+    {0x9abe14cd44753b52ULL, 0xc4926a9672793543ULL}, // 5^-24
+    {0xc16d9a0095928a27ULL, 0x75b7053c0f178294ULL}, // 5^-23
+    {0xf1c90080baf72cb1ULL, 0x5324c68b12dd6339ULL}, // 5^-22
+    {0x971da05074da7beeULL, 0xd3f6fc16ebca5e04ULL}, // 5^-21
+    {0xbce5086492111aeaULL, 0x88f4bb1ca6bcf585ULL}, // 5^-20
+    {0xec1e4a7db69561a5ULL, 0x2b31e9e3d06c32e6ULL}, // 5^-19
+    {0x9392ee8e921d5d07ULL, 0x3aff322e62439fd0ULL}, // 5^-18
+    {0xb877aa3236a4b449ULL, 0x09befeb9fad487c3ULL}, // 5^-17
+    {0xe69594bec44de15bULL, 0x4c2ebe687989a9b4ULL}, // 5^-16
+    {0x901d7cf73ab0acd9ULL, 0x0f9d37014bf60a11ULL}, // 5^-15
+    {0xb424dc35095cd80fULL, 0x538484c19ef38c95ULL}, // 5^-14
+    {0xe12e13424bb40e13ULL, 0x2865a5f206b06fbaULL}, // 5^-13
+    {0x8cbccc096f5088cbULL, 0xf93f87b7442e45d4ULL}, // 5^-12
+    {0xafebff0bcb24aafeULL, 0xf78f69a51539d749ULL}, // 5^-11
+    {0xdbe6fecebdedd5beULL, 0xb573440e5a884d1cULL}, // 5^-10
+    {0x89705f4136b4a597ULL, 0x31680a88f8953031ULL}, // 5^-9
+    {0xabcc77118461cefcULL, 0xfdc20d2b36ba7c3eULL}, // 5^-8
+    {0xd6bf94d5e57a42bcULL, 0x3d32907604691b4dULL}, // 5^-7
+    {0x8637bd05af6c69b5ULL, 0xa63f9a49c2c1b110ULL}, // 5^-6
+    {0xa7c5ac471b478423ULL, 0x0fcf80dc33721d54ULL}, // 5^-5
+    {0xd1b71758e219652bULL, 0xd3c36113404ea4a9ULL}, // 5^-4
+    {0x83126e978d4fdf3bULL, 0x645a1cac083126eaULL}, // 5^-3
+    {0xa3d70a3d70a3d70aULL, 0x3d70a3d70a3d70a4ULL}, // 5^-2
+    {0xccccccccccccccccULL, 0xcccccccccccccccdULL}, // 5^-1
+    {0x8000000000000000ULL, 0x0000000000000000ULL}, // 5^0
+    {0xa000000000000000ULL, 0x0000000000000000ULL}, // 5^1
+    {0xc800000000000000ULL, 0x0000000000000000ULL}, // 5^2
+    {0xfa00000000000000ULL, 0x0000000000000000ULL}, // 5^3
+    {0x9c40000000000000ULL, 0x0000000000000000ULL}, // 5^4
+    {0xc350000000000000ULL, 0x0000000000000000ULL}, // 5^5
+    {0xf424000000000000ULL, 0x0000000000000000ULL}, // 5^6
+    {0x9896800000000000ULL, 0x0000000000000000ULL}, // 5^7
+    {0xbebc200000000000ULL, 0x0000000000000000ULL}, // 5^8
+    {0xee6b280000000000ULL, 0x0000000000000000ULL}, // 5^9
+    {0x9502f90000000000ULL, 0x0000000000000000ULL}, // 5^10
+    {0xba43b74000000000ULL, 0x0000000000000000ULL}, // 5^11
+    {0xe8d4a51000000000ULL, 0x0000000000000000ULL}, // 5^12
+    {0x9184e72a00000000ULL, 0x0000000000000000ULL}, // 5^13
+    {0xb5e620f480000000ULL, 0x0000000000000000ULL}, // 5^14
+    {0xe35fa931a0000000ULL, 0x0000000000000000ULL}, // 5^15
+    {0x8e1bc9bf04000000ULL, 0x0000000000000000ULL}, // 5^16
+    {0xb1a2bc2ec5000000ULL, 0x0000000000000000ULL}, // 5^17
+    {0xde0b6b3a76400000ULL, 0x0000000000000000ULL}, // 5^18
+    {0x8ac7230489e80000ULL, 0x0000000000000000ULL}, // 5^19
+    {0xad78ebc5ac620000ULL, 0x0000000000000000ULL}, // 5^20
+    {0xd8d726b7177a8000ULL, 0x0000000000000000ULL}, // 5^21
+    {0x878678326eac9000ULL, 0x0000000000000000ULL}, // 5^22
+    {0xa968163f0a57b400ULL, 0x0000000000000000ULL}, // 5^23
+    {0xd3c21bcecceda100ULL, 0x0000000000000000ULL}, // 5^24
+    {0x84595161401484a0ULL, 0x0000000000000000ULL}, // 5^25
+    {0xa56fa5b99019a5c8ULL, 0x0000000000000000ULL}, // 5^26
+    {0xcecb8f27f4200f3aULL, 0x0000000000000000ULL}, // 5^27
+    {0x813f3978f8940984ULL, 0x4000000000000000ULL}, // 5^28
+    {0xa18f07d736b90be5ULL, 0x5000000000000000ULL}, // 5^29
+    {0xc9f2c9cd04674edeULL, 0xa400000000000000ULL}, // 5^30
+    {0xfc6f7c4045812296ULL, 0x4d00000000000000ULL}, // 5^31
+    {0x9dc5ada82b70b59dULL, 0xf020000000000000ULL}, // 5^32
+    {0xc5371912364ce305ULL, 0x6c28000000000000ULL}, // 5^33
+    {0xf684df56c3e01bc6ULL, 0xc732000000000000ULL}, // 5^34
+    {0x9a130b963a6c115cULL, 0x3c7f400000000000ULL}, // 5^35
+    {0xc097ce7bc90715b3ULL, 0x4b9f100000000000ULL}, // 5^36
+    {0xf0bdc21abb48db20ULL, 0x1e86d40000000000ULL}, // 5^37
+    {0x96769950b50d88f4ULL, 0x1314448000000000ULL}, // 5^38
+};
+
+// Potências de 10 exatas em float
+static const float g_PowersOfTen[11] = {1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f};
+
+#define IS_DIGIT(c) ((unsigned int)((c) - '0') < 10u)
+
+// Produto completo de dois inteiros de 64 bits
+static inline void Multiply128(uint64_t a, uint64_t b, uint64_t *high, uint64_t *low)
+{
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 product = (unsigned __int128)a * b;
+    *high = (uint64_t)(product >> 64);
+    *low = (uint64_t)product;
+#elif defined(_MSC_VER) && defined(_M_X64)
+    *low = _umul128(a, b, high);
+#else
+    uint64_t a_lo = (uint32_t)a, a_hi = a >> 32;
+    uint64_t b_lo = (uint32_t)b, b_hi = b >> 32;
+    uint64_t lo_lo = a_lo * b_lo;
+    uint64_t hi_lo = a_hi * b_lo;
+    uint64_t lo_hi = a_lo * b_hi;
+    uint64_t hi_hi = a_hi * b_hi;
+    uint64_t cross = (lo_lo >> 32) + (uint32_t)hi_lo + lo_hi;
+    *high = hi_hi + (hi_lo >> 32) + (cross >> 32);
+    *low = (cross << 32) | (uint32_t)lo_lo;
+#endif
+}
+
+// Número de bits zero à esquerda de "x", que não pode ser zero
+static inline int CountLeadingZeros(uint64_t x)
+{
+#if defined(__GNUC__)
+    return __builtin_clzll(x);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanReverse64(&index, x);
+    return 63 - (int)index;
+#else
+    int count = 0;
+    while ((x & 0x8000000000000000ULL) == 0)
+    {
+        x <<= 1;
+        count += 1;
+    }
+    return count;
+#endif
+}
+
+// Bits (sem o sinal) do float mais próximo de w * 10^q, pelo algoritmo de
+// Eisel-Lemire. Exato para qualquer "w" de até 19 dígitos decimais.
+static uint32_t EiselLemire(int64_t q, uint64_t w)
+{
+    if (w == 0 || q < FLOAT_MIN_POWER10)
+        return 0;
+    if (q > FLOAT_MAX_POWER10)
+        return 0x7F800000;
+
+    // Normaliza "w" e multiplica pela aproximação de 5^q. Os 64 bits altos
+    // do primeiro produto bastam, exceto quando os bits abaixo da mantissa
+    // (mais 3 bits de arredondamento) são todos 1 e um vai-um da parte baixa
+    // ainda poderia alterá-la.
+    int leading_zeros = CountLeadingZeros(w);
+    w <<= leading_zeros;
+
+    const uint64_t *power = g_PowersOfFive[q - FLOAT_MIN_POWER10];
+    uint64_t high, low;
+    Multiply128(w, power[0], &high, &low);
+
+    const uint64_t precision_mask = 0xFFFFFFFFFFFFFFFFULL >> (23 + 3);
+    if ((high & precision_mask) == precision_mask)
+    {
+        uint64_t high2, low2;
+        Multiply128(w, power[1], &high2, &low2);
+        low += high2;
+        if (high2 > low)
+            high += 1;
+    }
+
+    // 25 bits (mantissa com o bit implícito, mais um bit de arredondamento).
+    // floor(q * log2(10)) = (217706 * q) >> 16 no intervalo de "q".
+    int upper_bit = (int)(high >> 63);
+    int shift = upper_bit + 64 - 23 - 3;
+    uint64_t mantissa = high >> shift;
+    int power2 = (int)(((217706 * q) >> 16) + 63 + upper_bit - leading_zeros + 127);
+
+    // Subnormais
+    if (power2 <= 0)
+    {
+        if (-power2 + 1 >= 64)
+            return 0;
+        mantissa >>= -power2 + 1;
+        mantissa += (mantissa & 1);
+        mantissa >>= 1;
+        power2 = (mantissa < (1ULL << 23)) ? 0 : 1;
+        return ((uint32_t)power2 << 23) | (uint32_t)mantissa;
+    }
+
+    // Empate exato entre dois floats (somente possível para q em [-17, 10]):
+    // arredonda para o par em vez de para cima
+    if (low <= 1 && q >= -17 && q <= 10 && (mantissa & 3) == 1 && (mantissa << shift) == high)
+        mantissa &= ~1ULL;
+
+    mantissa += (mantissa & 1);
+    mantissa >>= 1;
+    if (mantissa >= (2ULL << 23))
+    {
+        mantissa = 1ULL << 23;
+        power2 += 1;
+    }
+    mantissa &= ~(1ULL << 23);
+
+    if (power2 >= 0xFF)
+        return 0x7F800000;
+    return ((uint32_t)power2 << 23) | (uint32_t)mantissa;
+}
+
+// Dígitos de [begin, end) (parte inteira, ponto opcional e parte
+// fracionária), com mais de 19 dígitos: ignora os zeros à esquerda e mantém
+// os 19 primeiros dígitos significativos. "truncated" indica se algum dígito
+// descartado é diferente de zero.
+static uint64_t ParseLongMantissa(const char *begin, const char *end, int64_t *exponent, bool *truncated)
+{
+    uint64_t w = 0;
+    int num_digits = 0;
+    bool fraction = false;
+    *exponent = 0;
+    *truncated = false;
+    for (const char *p = begin; p < end; ++p)
+    {
+        if (*p == '.')
+        {
+            fraction = true;
+            continue;
+        }
+
+        int digit = *p - '0';
+        if (num_digits < 19)
+        {
+            w = 10 * w + digit;
+            num_digits += (w != 0) ? 1 : 0;
+            *exponent -= fraction ? 1 : 0;
+        }
+        else
+        {
+            *exponent += fraction ? 0 : 1;
+            *truncated = *truncated || digit != 0;
+        }
+    }
+    return w;
+}
+
+bool ParseFloat(const char *begin, const char *end, float *value)
+{
+    const char *p = begin;
+    if (p >= end)
+        return false;
+
+    bool negative = false;
+    bool leading_dot = false;
+    if (*p == '+' || *p == '-')
+    {
+        negative = (*p == '-');
+        ++p;
+        leading_dot = (p < end && *p == '.');
+    }
+    else if (*p == '.')
+    {
+        leading_dot = true;
+    }
+    else if (!IS_DIGIT(*p))
+    {
+        return false;
+    }
+
+    // Dígitos da parte inteira e da parte fracionária, acumulados em "w";
+    // o valor é w * 10^exponent. Com mais de 19 dígitos "w" transborda, e
+    // os dígitos são lidos novamente por ParseLongMantissa().
+    uint64_t w = 0;
+    const char *digits = p;
+    if (!leading_dot)
+    {
+        for (; p < end && IS_DIGIT(*p); ++p)
+            w = 10 * w + (uint64_t)(*p - '0');
+        if (p == digits)
+            return false;
+    }
+    int64_t num_digits = p - digits;
+
+    int64_t exponent = 0;
+    if (p < end && *p == '.')
+    {
+        const char *fraction = ++p;
+        for (; p < end && IS_DIGIT(*p); ++p)
+            w = 10 * w + (uint64_t)(*p - '0');
+        exponent = -(p - fraction);
+        num_digits += p - fraction;
+    }
+
+    bool truncated = false;
+    if (num_digits > 19)
+        w = ParseLongMantissa(digits, p, &exponent, &truncated);
+
+    if (p < end && (*p == 'e' || *p == 'E'))
+    {
+        ++p;
+        bool negative_exponent = false;
+        if (p < end && (*p == '+' || *p == '-'))
+        {
+            negative_exponent = (*p == '-');
+            ++p;
+        }
+        else if (p >= end || !IS_DIGIT(*p))
+        {
+            return false;
+        }
+
+        // Mesmo limite da leitura de tinyobj
+        const char *exponent_digits = p;
+        int64_t explicit_exponent = 0;
+        for (; p < end && IS_DIGIT(*p); ++p)
+        {
+            if (explicit_exponent > INT_MAX / 10)
+                return false;
+            explicit_exponent = 10 * explicit_exponent + (*p - '0');
+        }
+        if (p == exponent_digits)
+            return false;
+
+        exponent += negative_exponent ? -explicit_exponent : explicit_exponent;
+    }
+
+    float result;
+    if (w == 0)
+    {
+        result = 0.0f;
+    }
+    else if (!truncated && w <= (1ULL << 24) && exponent >= -10 && exponent <= 10)
+    {
+        // "w" e 10^|exponent| são exatos em float: uma única operação,
+        // arredondada corretamente
+        result = (float)w;
+        if (exponent < 0)
+            result /= g_PowersOfTen[-exponent];
+        else
+            result *= g_PowersOfTen[exponent];
+    }
+    else
+    {
+        uint32_t bits = EiselLemire(exponent, w);
+
+        // Com dígitos descartados, o valor está entre w e w + 1; se os dois
+        // arredondam para floats diferentes, strtof() decide
+        if (truncated && bits != EiselLemire(exponent, w + 1))
+        {
+            std::string text(begin, p);
+            *value = strtof(text.c_str(), NULL);
+            return true;
+        }
+        memcpy(&result, &bits, sizeof(result));
+    }
+
+    *value = negative ? -result : result;
+    return true;
+}
@@ -0,0 +1,141 @@
+#include "gputimer.h"
+
+#include <cstdio>
+
+#include <glad/glad.h>
+
+// Um conjunto de queries: uma por passe, e o instante de envio de cada passe
+struct GpuTimerFrame
+{
+    GLuint queries[PROFILER_GPU_NUM_PASSES];
+    bool used[PROFILER_GPU_NUM_PASSES];
+    double submit_us[PROFILER_GPU_NUM_PASSES];
+    bool pending; // Alguma query foi enviada e o resultado ainda não foi lido
+};
+
+static GpuTimerFrame g_GpuTimerFrames[GPU_TIMER_FRAMES];
+static bool g_GpuTimerEnabled = false;
+static int g_GpuTimerCurrent = 0;     // Conjunto do quadro atual
+static int g_GpuTimerActivePass = -1; // Passe com query aberta, ou -1
+static unsigned long g_GpuTimerDropped = 0;
+
+void GpuTimer_Init()
+{
+    // Timer queries fazem parte do OpenGL 3.3, mas o contador pode ter zero
+    // bits se o driver não souber medir o tempo da GPU
+    GLint bits = 0;
+    glGetQueryiv(GL_TIME_ELAPSED, GL_QUERY_COUNTER_BITS, &bits);
+    if (bits == 0)
+    {
+        fprintf(stderr, "WARNING: GL_TIME_ELAPSED queries not supported; GPU times will not be measured.\n");
+        return;
+    }
+
+    for (int i = 0; i < GPU_TIMER_FRAMES; ++i)
+    {
+        glGenQueries(PROFILER_GPU_NUM_PASSES, g_GpuTimerFrames[i].queries);
+        for (int pass = 0; pass < PROFILER_GPU_NUM_PASSES; ++pass)
+            g_GpuTimerFrames[i].used[pass] = false;
+        g_GpuTimerFrames[i].pending = false;
+    }
+    g_GpuTimerEnabled = true;
+}
+
+// Lê os resultados do conjunto "frame". Sem "wait", não espera pela GPU e
+// retorna false se algum ainda não estiver disponível; com "wait",
+// GL_QUERY_RESULT espera a GPU terminar o quadro.
+static bool ReadResults(GpuTimerFrame *frame, bool wait)
+{
+    for (int pass = 0; pass < PROFILER_GPU_NUM_PASSES && !wait; ++pass)
+    {
+        GLint available = GL_TRUE;
+        if (frame->used[pass])
+            glGetQueryObjectiv(frame->queries[pass], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            return false;
+    }
+
+    double pass_ms[PROFILER_GPU_NUM_PASSES];
+    for (int pass = 0; pass < PROFILER_GPU_NUM_PASSES; ++pass)
+    {
+        GLuint64 nanoseconds = 0;
+        if (frame->used[pass])
+            glGetQueryObjectui64v(frame->queries[pass], GL_QUERY_RESULT, &nanoseconds);
+        pass_ms[pass] = 1e-6 * nanoseconds;
+    }
+
+    Profiler_GpuFrame(pass_ms, frame->submit_us);
+    return true;
+}
+
+void GpuTimer_BeginFrame()
+{
+    if (!g_GpuTimerEnabled)
+        return;
+
+    GpuTimer_End();
+
+    // O conjunto reutilizado agora foi enviado GPU_TIMER_FRAMES quadros atrás.
+    // Se a GPU ainda não o terminou, descartamos os seus resultados: a query
+    // pode ser reiniciada mesmo com o resultado pendente.
+    g_GpuTimerCurrent = (g_GpuTimerCurrent + 1) % GPU_TIMER_FRAMES;
+    GpuTimerFrame *frame = &g_GpuTimerFrames[g_GpuTimerCurrent];
+    if (frame->pending && !ReadResults(frame, false))
+        ++g_GpuTimerDropped;
+
+    for (int pass = 0; pass < PROFILER_GPU_NUM_PASSES; ++pass)
+    {
+        frame->used[pass] = false;
+        frame->submit_us[pass] = 0.0;
+    }
+    frame->pending = false;
+}
+
+void GpuTimer_Begin(int pass)
+{
+    if (!g_GpuTimerEnabled)
+        return;
+
+    GpuTimer_End();
+
+    GpuTimerFrame *frame = &g_GpuTimerFrames[g_GpuTimerCurrent];
+    if (frame->used[pass])
+        return;
+
+    glBeginQuery(GL_TIME_ELAPSED, frame->queries[pass]);
+    frame->used[pass] = true;
+    frame->submit_us[pass] = Profiler_Time();
+    frame->pending = true;
+    g_GpuTimerActivePass = pass;
+}
+
+void GpuTimer_End()
+{
+    if (g_GpuTimerActivePass < 0)
+        return;
+
+    glEndQuery(GL_TIME_ELAPSED);
+    g_GpuTimerActivePass = -1;
+}
+
+void GpuTimer_Flush()
+{
+    if (!g_GpuTimerEnabled)
+        return;
+
+    GpuTimer_End();
+
+    // O conjunto seguinte ao atual é o mais antigo do anel
+    for (int i = 1; i <= GPU_TIMER_FRAMES; ++i)
+    {
+        GpuTimerFrame *frame = &g_GpuTimerFrames[(g_GpuTimerCurrent + i) % GPU_TIMER_FRAMES];
+        if (frame->pending)
+            ReadResults(frame, true);
+        frame->pending = false;
+    }
+}
+
+unsigned long GpuTimer_DroppedFrames()
+{
+    return g_GpuTimerDropped;
+}
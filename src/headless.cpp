@@ -0,0 +1,275 @@
+#include "headless.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cfloat>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <tiny_obj_loader.h>
+
+#include "assetmanager.h"
+#include "meshcache.h"
+#include "objloader.h"
+#include "simulation.h"
+
+// Uma linha do roteiro: a partir do passo "tick", as teclas indicadas ficam
+// pressionadas e a câmera fica com os ângulos indicados.
+struct ScriptEvent
+{
+    unsigned long tick;
+    SimulationInput input;
+};
+
+// Lê um roteiro no formato
+//
+//     # comentário
+//     # passo  teclas  [theta  phi]
+//     0        W
+//     120      WA      0.3    0.0
+//     240      R
+//     360      -
+//
+// onde "teclas" contém as letras W, A, S, D e Z das teclas pressionadas (ou
+// "-" para nenhuma), e R zera a rotação da nave naquele passo, como a tecla
+// espaço. Os ângulos da câmera, em radianos, são mantidos da linha anterior
+// se omitidos. As linhas devem estar em ordem crescente de passo.
+static bool LoadScript(const char *filename, std::vector<ScriptEvent> *events)
+{
+    FILE *f = fopen(filename, "r");
+    if (f == NULL)
+    {
+        fprintf(stderr, "ERROR: Cannot open script \"%s\".\n", filename);
+        return false;
+    }
+
+    SimulationInput input;
+    memset(&input, 0, sizeof(input));
+
+    char line[256];
+    int line_number = 0;
+    while (fgets(line, sizeof(line), f) != NULL)
+    {
+        ++line_number;
+        char *comment = strchr(line, '#');
+        if (comment != NULL)
+            *comment = '\0';
+
+        unsigned long tick;
+        char keys[64];
+        float theta, phi;
+        int n = sscanf(line, "%lu %63s %f %f", &tick, keys, &theta, &phi);
+        if (n <= 0)
+            continue; // Linha vazia
+        if (n == 1 || n == 3 || (!events->empty() && tick < events->back().tick))
+        {
+            fprintf(stderr, "ERROR: Invalid script line %d in \"%s\".\n", line_number, filename);
+            fclose(f);
+            return false;
+        }
+
+        input.forward = strchr(keys, 'W') != NULL;
+        input.left = strchr(keys, 'A') != NULL;
+        input.backward = strchr(keys, 'S') != NULL;
+        input.right = strchr(keys, 'D') != NULL;
+        input.roll = strchr(keys, 'Z') != NULL;
+        input.reset_roll = strchr(keys, 'R') != NULL;
+        if (n == 4)
+        {
+            input.camera_theta = theta;
+            input.camera_phi = phi;
+        }
+
+        ScriptEvent event;
+        event.tick = tick;
+        event.input = input;
+        events->push_back(event);
+    }
+
+    fclose(f);
+    return true;
+}
+
+// Arquivo do modelo "asteroid" no manifesto dos recursos do jogo, o mesmo
+// carregado por Scene_Init(). A AABB do modelo define a HitBox do asteroide
+// da curva de Bezier.
+static bool FindAsteroidModel(std::string *filename)
+{
+    AssetManager manager;
+    if (!AssetManager_ReadManifest(&manager, ASSET_MANIFEST))
+        return false;
+
+    Asset *asset = AssetManager_Find(&manager, "asteroid");
+    bool found = asset != NULL && asset->type == ASSET_MESH;
+    if (found)
+        *filename = asset->filename;
+    else
+        fprintf(stderr, "ERROR: Model \"asteroid\" not found in \"%s\".\n", ASSET_MANIFEST);
+
+    AssetManager_Finish(&manager);
+    return found;
+}
+
+// AABB do objeto "Asteroid" do modelo "filename", lida do cache ".mesh" se
+// existir e do arquivo OBJ caso contrário.
+static bool LoadAsteroidBoundingBox(const char *filename, glm::vec3 *bbox_min, glm::vec3 *bbox_max)
+{
+    MeshCacheFile cache;
+    if (MeshCache_Open(filename, &cache))
+    {
+        bool found = false;
+        for (uint32_t i = 0; i < cache.view.num_shapes && !found; ++i)
+        {
+            const MeshShape &shape = cache.view.shapes[i];
+            if (strcmp(shape.name, "Asteroid") == 0)
+            {
+                *bbox_min = glm::vec3(shape.bbox_min[0], shape.bbox_min[1], shape.bbox_min[2]);
+                *bbox_max = glm::vec3(shape.bbox_max[0], shape.bbox_max[1], shape.bbox_max[2]);
+                found = true;
+            }
+        }
+        MeshCache_Close(&cache);
+        if (found)
+            return true;
+    }
+
+    tinyobj::attrib_t attrib;
+    std::vector<tinyobj::shape_t> shapes;
+    std::vector<tinyobj::material_t> materials;
+    std::string warn, err;
+    if (!ObjLoader_Load(&attrib, &shapes, &materials, &warn, &err, filename, NULL, true))
+    {
+        fprintf(stderr, "ERROR: Cannot load \"%s\": %s\n", filename, err.c_str());
+        return false;
+    }
+
+    *bbox_min = glm::vec3(FLT_MAX, FLT_MAX, FLT_MAX);
+    *bbox_max = glm::vec3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+    for (size_t s = 0; s < shapes.size(); ++s)
+    {
+        if (shapes[s].name != "Asteroid")
+            continue;
+        for (size_t i = 0; i < shapes[s].mesh.indices.size(); ++i)
+        {
+            int v = shapes[s].mesh.indices[i].vertex_index;
+            glm::vec3 p(attrib.vertices[3 * v + 0], attrib.vertices[3 * v + 1], attrib.vertices[3 * v + 2]);
+            *bbox_min = glm::min(*bbox_min, p);
+            *bbox_max = glm::max(*bbox_max, p);
+        }
+    }
+
+    if (bbox_min->x > bbox_max->x)
+    {
+        fprintf(stderr, "ERROR: Object \"Asteroid\" not found in \"%s\".\n", filename);
+        return false;
+    }
+    return true;
+}
+
+int Headless_Run(int argc, char *argv[])
+{
+    const char *script = NULL;
+    unsigned long num_ticks = 0;
+    bool quiet = false;
+    for (int i = 0; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--quiet") == 0)
+            quiet = true;
+        else if (script == NULL)
+            script = argv[i];
+        else
+            num_ticks = strtoul(argv[i], NULL, 10);
+    }
+
+    if (script == NULL)
+    {
+        fprintf(stderr, "Usage: main --headless <script> [ticks] [--quiet]\n");
+        return EXIT_FAILURE;
+    }
+
+    std::vector<ScriptEvent> events;
+    if (!LoadScript(script, &events))
+        return EXIT_FAILURE;
+
+    // Sem número de passos, executamos até a última linha do roteiro mais um
+    // segundo
+    if (num_ticks == 0)
+        num_ticks = (events.empty() ? 0 : events.back().tick) + SIMULATION_TICK_RATE;
+
+    std::string asteroid_model;
+    glm::vec3 bbox_min, bbox_max;
+    if (!FindAsteroidModel(&asteroid_model) || !LoadAsteroidBoundingBox(asteroid_model.c_str(), &bbox_min, &bbox_max))
+        return EXIT_FAILURE;
+
+    Simulation sim;
+    Simulation_Init(&sim, bbox_min, bbox_max);
+
+    SimulationInput input;
+    memset(&input, 0, sizeof(input));
+
+    if (!quiet)
+        printf("%8s %10s %10s %10s %10s %8s %6s %8s %8s %10s\n",
+               "passo", "tempo", "x", "y", "z", "rotacao", "moedas", "bezier", "colisoes", "us");
+
+    std::vector<double> tick_times;
+    tick_times.reserve(num_ticks);
+    size_t next_event = 0;
+
+    for (unsigned long tick = 0; tick < num_ticks; ++tick)
+    {
+        // A tecla R vale somente no passo da sua linha
+        input.reset_roll = false;
+        while (next_event < events.size() && events[next_event].tick <= tick)
+            input = events[next_event++].input;
+
+        // Após uma colisão a câmera volta para a posição inicial, como no
+        // loop principal do jogo
+        unsigned int crashes = sim.current.crashes;
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        Simulation_Tick(&sim, input);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        tick_times.push_back(seconds);
+
+        if (sim.current.crashes != crashes)
+        {
+            input.camera_theta = 0.0f;
+            input.camera_phi = 0.0f;
+        }
+
+        if (!quiet)
+        {
+            const SimulationState &state = sim.current;
+            int coins = 0;
+            for (int i = 0; i < SIMULATION_NUM_COINS; ++i)
+                coins += state.coin_visible[i] ? 1 : 0;
+
+            printf("%8lu %10.4f %10.4f %10.4f %10.4f %8.3f %6d %8s %8u %10.2f\n",
+                   state.tick, state.time,
+                   state.displacement.x, state.displacement.y, state.displacement.z,
+                   state.angle_z, coins, state.bezier_visible ? "sim" : "nao",
+                   state.crashes, 1e6 * seconds);
+        }
+    }
+
+    double total = 0.0;
+    for (size_t i = 0; i < tick_times.size(); ++i)
+        total += tick_times[i];
+    std::sort(tick_times.begin(), tick_times.end());
+
+    if (!tick_times.empty())
+    {
+        printf("Passos: %lu, colisoes: %u, tempo medio: %.3f us, mediana: %.3f us, maximo: %.3f us, %.0f passos/s\n",
+               num_ticks, sim.current.crashes,
+               1e6 * total / tick_times.size(),
+               1e6 * tick_times[tick_times.size() / 2],
+               1e6 * tick_times.back(),
+               total > 0.0 ? tick_times.size() / total : 0.0);
+    }
+
+    Simulation_Free(&sim);
+    return EXIT_SUCCESS;
+}
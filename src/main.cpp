@@ -18,6 +18,7 @@
 #include <cmath>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 
 // Headers abaixo são específicos de C++
 #include <map>
@@ -37,99 +38,36 @@
 // Headers da biblioteca GLM: criação de matrizes e vetores.
 #include <glm/mat4x4.hpp>
 #include <glm/vec4.hpp>
-#include <glm/gtc/type_ptr.hpp>
-
-// Headers da biblioteca para carregar modelos obj
-#include <tiny_obj_loader.h>
-
-#include <stb_image.h>
 
 // Headers locais, definidos na pasta "include/"
 #include "utils.h"
-#include "matrices.h"
 
 // Header para sistema de colisões
 #include "collisions.h"
 
-// Estrutura que representa um modelo geométrico carregado a partir de um
-// arquivo ".obj". Veja https://en.wikipedia.org/wiki/Wavefront_.obj_file .
-struct ObjModel
-{
-    tinyobj::attrib_t attrib;
-    std::vector<tinyobj::shape_t> shapes;
-    std::vector<tinyobj::material_t> materials;
-
-    // Este construtor lê o modelo de um arquivo utilizando a biblioteca tinyobjloader.
-    // Veja: https://github.com/syoyo/tinyobjloader
-    ObjModel(const char *filename, const char *basepath = NULL, bool triangulate = true)
-    {
-        printf("Carregando objetos do arquivo \"%s\"...\n", filename);
-
-        // Se basepath == NULL, então setamos basepath como o dirname do
-        // filename, para que os arquivos MTL sejam corretamente carregados caso
-        // estejam no mesmo diretório dos arquivos OBJ.
-        std::string fullpath(filename);
-        std::string dirname;
-        if (basepath == NULL)
-        {
-            auto i = fullpath.find_last_of("/");
-            if (i != std::string::npos)
-            {
-                dirname = fullpath.substr(0, i + 1);
-                basepath = dirname.c_str();
-            }
-        }
-
-        std::string warn;
-        std::string err;
-        bool ret = tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, filename, basepath, triangulate);
+// Header para cache binário de malhas (arquivos ".mesh")
+#include "meshcache.h"
+#include "benchmarks.h"
+#include "simulation.h"
+#include "headless.h"
 
-        if (!err.empty())
-            fprintf(stderr, "\n%s\n", err.c_str());
+// Tempo de CPU de cada estágio do quadro (tecla P) e captura de traces (tecla T)
+#include "profiler.h"
+#include "gputimer.h"
 
-        if (!ret)
-            throw std::runtime_error("Erro ao carregar modelo.");
-
-        for (size_t shape = 0; shape < shapes.size(); ++shape)
-        {
-            if (shapes[shape].name.empty())
-            {
-                fprintf(stderr,
-                        "*********************************************\n"
-                        "Erro: Objeto sem nome dentro do arquivo '%s'.\n"
-                        "Veja https://www.inf.ufrgs.br/~eslgastal/fcg-faq-etc.html#Modelos-3D-no-formato-OBJ .\n"
-                        "*********************************************\n",
-                        filename);
-                throw std::runtime_error("Objeto sem nome.");
-            }
-            printf("- Objeto '%s'\n", shapes[shape].name.c_str());
-        }
-
-        printf("OK.\n");
-    }
-};
-
-// Desenha os modelos das moedas e asteroides
-void LoadCoins();
-void LoadAsteroids();
-void LoadBezierAsteroids();
-
-// Declaração de várias funções utilizadas em main().  Essas estão definidas
-// logo após a definição de main() neste arquivo.
-void BuildTrianglesAndAddToVirtualScene(ObjModel *);                         // Constrói representação de um ObjModel como malha de triângulos para renderização
-void ComputeNormals(ObjModel *model);                                        // Computa normais de um ObjModel, caso não existam.
-void LoadShadersFromFiles();                                                 // Carrega os shaders de vértice e fragmento, criando um programa de GPU
-void LoadTextureImage(const char *filename);                                 // Função que carrega imagens de textura
-void DrawVirtualObject(const char *object_name);                             // Desenha um objeto armazenado em g_VirtualScene
-GLuint LoadShader_Vertex(const char *filename);                              // Carrega um vertex shader
-GLuint LoadShader_Fragment(const char *filename);                            // Carrega um fragment shader
-void LoadShader(const char *filename, GLuint shader_id);                     // Função utilizada pelas duas acima
-GLuint CreateGpuProgram(GLuint vertex_shader_id, GLuint fragment_shader_id); // Cria um programa de GPU
+// Cena virtual: shaders, texturas, modelos e desenho de cada quadro
+#include "scene.h"
 
 // Declaração de funções auxiliares para renderizar texto dentro da janela
 // OpenGL. Estas funções estão definidas no arquivo "textrendering.cpp".
-void TextRendering_Init();
+#include "textrendering.h"
+
+// Texto informativo desenhado sobre a cena (tecla H)
+void ShowInfoText(const SimulationState &state, unsigned long frame_draws, double frame_draw_seconds,
+                  unsigned long frame_triangles, unsigned long text_draws);
 
+// Tempos dos estágios do quadro medidos pelo profiler (tecla P)
+void ShowProfilerOverlay();
 
 // Funções callback para comunicação com o sistema operacional e interação do
 // usuário. Veja mais comentários nas definições das mesmas, abaixo.
@@ -139,27 +77,6 @@ void KeyCallback(GLFWwindow *window, int key, int scancode, int action, int mode
 void MouseButtonCallback(GLFWwindow *window, int button, int action, int mods);
 void CursorPosCallback(GLFWwindow *window, double xpos, double ypos);
 
-// Definimos uma estrutura que armazenará dados necessários para renderizar
-// cada objeto da cena virtual.
-struct SceneObject
-{
-    std::string name;              // Nome do objeto
-    size_t first_index;            // Índice do primeiro vértice dentro do vetor indices[] definido em BuildTrianglesAndAddToVirtualScene()
-    size_t num_indices;            // Número de índices do objeto dentro do vetor indices[] definido em BuildTrianglesAndAddToVirtualScene()
-    GLenum rendering_mode;         // Modo de rasterização (GL_TRIANGLES, GL_TRIANGLE_STRIP, etc.)
-    GLuint vertex_array_object_id; // ID do VAO onde estão armazenados os atributos do modelo
-    glm::vec3 bbox_min;            // Axis-Aligned Bounding Box do objeto
-    glm::vec3 bbox_max;
-};
-
-// Abaixo definimos variáveis globais utilizadas em várias funções do código.
-
-// A cena virtual é uma lista de objetos nomeados, guardados em um dicionário
-// (map).  Veja dentro da função BuildTrianglesAndAddToVirtualScene() como que são incluídos
-// objetos dentro da variável g_VirtualScene, e veja na função main() como
-// estes são acessados.
-std::map<std::string, SceneObject> g_VirtualScene;
-
 // Pilha que guardará as matrizes de modelagem.
 std::stack<glm::mat4> g_MatrixStack;
 
@@ -189,19 +106,14 @@ float g_CameraDistance = 3.5f; // Distância da câmera para a origem
 bool g_UseFirstPersonView = false;
 
 // Variável que controla se o texto informativo será mostrado na tela.
-bool g_ShowInfoText = true;
+bool g_ShowInfoText = false;
 
-// Variáveis que definem um programa de GPU (shaders). Veja função LoadShadersFromFiles().
-GLuint g_GpuProgramID = 0;
-GLint g_model_uniform;
-GLint g_view_uniform;
-GLint g_projection_uniform;
-GLint g_object_id_uniform;
-GLint g_bbox_min_uniform;
-GLint g_bbox_max_uniform;
+// Variável que controla se os tempos do profiler serão mostrados na tela.
+bool g_ShowProfiler = false;
 
-// Número de texturas carregadas pela função LoadTextureImage()
-GLuint g_NumLoadedTextures = 0;
+// Arquivo gravado pela captura de trace (tecla T ou opção "--trace N")
+#define TRACE_FILENAME "profiler_trace.json"
+#define TRACE_FRAMES   120
 
 // Definindo variáveis que colocam a câmera em uma posição inicial
 bool tecla_W_pressionada = false;
@@ -211,27 +123,24 @@ bool tecla_D_pressionada = false;
 bool tecla_Z_pressionada = false;
 
 // Definindo variáveis para controle de renderização caso haja colisão
-bool DrawCoin0 = true;
-bool DrawCoin1 = true;
-bool DrawCoin2 = true;
 bool ReturnSpaceshipToOrigin = false;
 
-// Hitbox de moedas e asteroides
-HitBox Coin0HitBox;
-HitBox Coin1HitBox;
-HitBox Coin2HitBox;
-HitBox Asteroid0HitBox;
-HitBox Asteroid1HitBox;
-HitBox Asteroid2HitBox;
-HitBox Asteroid3HitBox;
-HitBox Asteroid4HitBox;
-HitBox Asteroid5HitBox;
+// Lógica do jogo, executada em passos de tempo fixos. Veja "simulation.cpp".
+Simulation g_Simulation;
+bool g_ResetSpaceshipRoll = false; // Tecla espaço pressionada desde o último passo da simulação
 
 // Hitsphere do "universo"
 HitSphere HitSphereUniverse;
 
 int main(int argc, char *argv[])
 {
+    // Modos de benchmark e a simulação sem janela não utilizam GLFW nem
+    // OpenGL. Veja "benchmarks.cpp" e "headless.cpp".
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0)
+        return Benchmark_Run(argc - 2, argv + 2);
+    if (argc > 1 && strcmp(argv[1], "--headless") == 0)
+        return Headless_Run(argc - 2, argv + 2);
+
     // Inicializamos a biblioteca GLFW, utilizada para criar uma janela do
     // sistema operacional, onde poderemos renderizar com OpenGL.
     int success = glfwInit();
@@ -296,304 +205,167 @@ int main(int argc, char *argv[])
 
     printf("GPU: %s, %s, OpenGL %s, GLSL %s\n", vendor, renderer, glversion, glslversion);
 
-    // Carregamos os shaders de vértices e de fragmentos que serão utilizados
-    // para renderização. Veja slides 180-200 do documento Aula_03_Rendering_Pipeline_Grafico.pdf.
-    //
-    LoadShadersFromFiles();
-
-    // Carregamos duas imagens para serem utilizadas como textura
-    LoadTextureImage("../../data/spaceship.png"); // TextureImage0
-    LoadTextureImage("../../data/space.jpg");     // TextureImage1
-    LoadTextureImage("../../data/meteoro.png");   // TextureImage2
-    LoadTextureImage("../../data/gold_2.jpg");    // TextureImage3
-    LoadTextureImage("../../data/normal.jpg");    // TextureImage4
-    LoadTextureImage("../../data/basecolor.jpg"); // TextureImage5
-
-    // Construímos a representação de objetos geométricos através de malhas de triângulos
-    ObjModel spaceshipmodel("../../data/spaceship.obj");
-    ComputeNormals(&spaceshipmodel);
-    BuildTrianglesAndAddToVirtualScene(&spaceshipmodel);
-
-    ObjModel spheremodel("../../data/sphere.obj");
-    ComputeNormals(&spheremodel);
-    BuildTrianglesAndAddToVirtualScene(&spheremodel);
-
-    ObjModel moonmodel("../../data/moon.obj");
-    ComputeNormals(&moonmodel);
-    BuildTrianglesAndAddToVirtualScene(&moonmodel);
-
-    // Construímos a representação de objetos geométricos através de malhas de triângulos
-    ObjModel asteroidmodel("../../data/asteroid.obj");
-    ComputeNormals(&asteroidmodel);
-    BuildTrianglesAndAddToVirtualScene(&asteroidmodel);
-
-    ObjModel planemodel("../../data/plane.obj");
-    ComputeNormals(&planemodel);
-    BuildTrianglesAndAddToVirtualScene(&planemodel);
-
-    ObjModel coinmodel("../../data/coin.obj");
-    ComputeNormals(&coinmodel);
-    BuildTrianglesAndAddToVirtualScene(&coinmodel);
-
-    if (argc > 1)
+    // Argumentos de linha de comando: "--asteroids N" adiciona N asteroides
+    // aleatórios ao campo (teste de desempenho); "--trace N" grava os N
+    // primeiros quadros em TRACE_FILENAME; "--stats" imprime os contadores
+    // de desempenho no terminal a cada 5 segundos; qualquer outro argumento
+    // é interpretado como um modelo OBJ extra.
+    int num_extra_asteroids = 0;
+    bool print_stats = false;
+    std::vector<std::string> extra_models;
+    for (int i = 1; i < argc; ++i)
     {
-        ObjModel model(argv[1]);
-        BuildTrianglesAndAddToVirtualScene(&model);
+        if (strcmp(argv[i], "--asteroids") == 0 && i + 1 < argc)
+            num_extra_asteroids = std::max(0, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+            Profiler_CaptureTrace(TRACE_FILENAME, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--stats") == 0)
+            print_stats = true;
+        else
+            extra_models.push_back(argv[i]);
     }
 
-    // Inicializamos o código para renderização de texto.
-    TextRendering_Init();
+    // Começamos a carregar os shaders, as texturas e os modelos do jogo, e
+    // esperamos somente os essenciais. Veja Scene_Init() em "scene.cpp".
+    Scene_Init(extra_models);
 
-    // Habilitamos o Z-buffer. Veja slides 104-116 do documento Aula_09_Projecoes.pdf.
-    glEnable(GL_DEPTH_TEST);
+    // Construímos o campo de asteroides e inicializamos a simulação, que
+    // contém as HitBoxes do nível.
+    LoadAsteroids(num_extra_asteroids);
+    Simulation_Init(&g_Simulation, g_VirtualScene[g_AsteroidObject].bbox_min, g_VirtualScene[g_AsteroidObject].bbox_max);
 
-    // Habilitamos o Backface Culling. Veja slides 23-34 do documento Aula_13_Clipping_and_Culling.pdf e slides 112-123 do documento Aula_14_Laboratorio_3_Revisao.pdf.
-    glEnable(GL_CULL_FACE);
-    glCullFace(GL_BACK);
-    glFrontFace(GL_CCW);
+    // Inicializamos o código para renderização de texto.
+    TextRendering_Init();
 
-    float speed = 3.5f; // Velocidade da câmera
     // Atualiza delta de tempo
     float prev_time = (float)glfwGetTime();
     float delta_t;
 
-    glm::vec4 camera_position_c = glm::vec4(0.0f, 0.0f, -4.3f, 1.0f); // Ponto "c", centro da câmera
-    glm::vec4 camera_view_vector = glm::vec4(0.0f, 1.0f, 0.0f, 0.0f); // Vetor "view", sentido para onde a câmera está virada
-    glm::vec4 camera_up_vector = glm::vec4(0.0f, 1.0f, 0.0f, 0.0f);   // Vetor "up" fixado para apontar para o "céu" (eito Y global)
-    glm::vec4 spaceship_position = glm::vec4(camera_position_c.x, camera_position_c.y - 0.5f, camera_position_c.z + 3.0f, 1.0f);
-    glm::vec4 displacement = glm::vec4(0.0f, 0.0f, 0.0f, 0.0f); // Vetor que define o deslocamento da nave em relação ao início
-
-    // Variáveis usadas para representar curva de bezier
-    float start_bezier = 0;
-    float t;
-    glm::vec4 p1Bezier;
-    glm::vec4 p2Bezier;
-    glm::vec4 p3Bezier;
-    glm::vec4 p4Bezier;
+    // Instante em que os contadores de desempenho foram zerados pela última
+    // vez, e número de quadros desenhados desde então
+    float stats_time = prev_time;
+    int stats_frames = 0;
 
-    // Variável na rotação da spaceship
-    float delta = 3.141592 / 8;
+    // Chamadas de desenho do texto no quadro anterior, mostradas pelo texto
+    // informativo
+    unsigned long text_draws = 0;
 
-    // Limite que o usuário pode andar em qualquer uma das direções
-    float UniverseLimit = 50.0f;
+    bool first_frame_shown = false;
 
     // Ficamos em um loop infinito, renderizando, até que o usuário feche a janela
     while (!glfwWindowShouldClose(window))
     {
-
-        // Aqui executamos as operações de renderização
-        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-
-        // "Pintamos" todos os pixels do framebuffer com a cor definida acima,
-        // e também resetamos todos os pixels do Z-buffer (depth buffer).
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-        // Pedimos para a GPU utilizar o programa de GPU criado acima (contendo
-        // os shaders de vértice e fragmentos).
-        glUseProgram(g_GpuProgramID);
+        // Cada quadro começa aqui; os estágios são marcados com PROFILE_SCOPE()
+        Profiler_BeginFrame();
+        GpuTimer_BeginFrame();
 
         // Atualiza delta de tempo
         float current_time = (float)glfwGetTime();
         delta_t = current_time - prev_time;
         prev_time = current_time;
 
-        if (tecla_W_pressionada)
+        // Executamos os passos da simulação correspondentes ao tempo
+        // decorrido desde o último quadro
+        SimulationInput input;
         {
-            // Movimenta spaceship para FRENTE
-            displacement += (camera_view_vector / norm(camera_view_vector)) * speed * delta_t;
+            PROFILE_SCOPE(PROFILER_INPUT);
+            input.forward = tecla_W_pressionada;
+            input.left = tecla_A_pressionada;
+            input.backward = tecla_S_pressionada;
+            input.right = tecla_D_pressionada;
+            input.roll = tecla_Z_pressionada;
+            input.reset_roll = g_ResetSpaceshipRoll;
+            input.camera_theta = g_CameraTheta;
+            input.camera_phi = g_CameraPhi;
         }
 
-        if (tecla_A_pressionada)
         {
-            // Movimenta spaceship para ESQUERDA
-            displacement -= -(crossproduct(camera_up_vector, camera_view_vector / norm(camera_view_vector)) / norm(crossproduct(camera_up_vector, (camera_view_vector / norm(camera_view_vector))))) * speed * delta_t;
-        }
+            PROFILE_SCOPE(PROFILER_SIMULATION);
+            unsigned int crashes = g_Simulation.current.crashes;
+            if (Simulation_Advance(&g_Simulation, delta_t, input) > 0)
+                g_ResetSpaceshipRoll = false;
 
-        if (tecla_S_pressionada)
-        {
-            // Movimenta spaceship para TRÁS
-            displacement -= (camera_view_vector / norm(camera_view_vector)) * speed * delta_t;
+            // Após uma colisão a câmera volta para a posição inicial
+            if (g_Simulation.current.crashes != crashes)
+            {
+                g_CameraTheta = 0;
+                g_CameraPhi = 0;
+            }
         }
 
-        if (tecla_D_pressionada)
-        {
-            // Movimenta spaceship para DIREITA
-            displacement += -(crossproduct(camera_up_vector, camera_view_vector / norm(camera_view_vector)) / norm(crossproduct(camera_up_vector, (camera_view_vector / norm(camera_view_vector))))) * speed * delta_t;
-        }
-        if (tecla_Z_pressionada)
+        // Desenhamos o estado interpolado entre os dois últimos passos
+        SimulationState state = Simulation_Interpolate(&g_Simulation);
+        g_AngleZ = state.angle_z;
+
+        SceneCamera camera;
+        camera.theta = g_CameraTheta;
+        camera.phi = g_CameraPhi;
+        camera.first_person = g_UseFirstPersonView;
+        camera.screen_ratio = g_ScreenRatio;
+        unsigned long draws = g_DrawCalls;
+        unsigned long triangles = g_DrawTriangles;
+        double draw_seconds = g_DrawCpuSeconds;
         {
-            // Rotaciona spaceship
-            g_AngleZ += delta * delta_t * 40;
+            PROFILE_SCOPE(PROFILER_SCENE);
+            Scene_Draw(state, camera, current_time);
         }
 
-        // Recalcula posição da nave com base no deslocamento calculado
-        spaceship_position = glm::vec4(displacement.x, displacement.y, displacement.z, 1.0f);
-
-        // Calcula a distância necessária da câmera para incluir todo o objeto no campo de visão
-        float distance_to_object = 3.5f;
-
-        float x = cos(g_CameraPhi) * sin(g_CameraTheta);
-        float y = -(sin(g_CameraPhi));
-        float z = cos(g_CameraPhi) * cos(g_CameraTheta);
-
-        // 1a pessoa (câmera livre)
-        if (g_UseFirstPersonView)
+        // Todo o texto do quadro é desenhado de uma só vez, por TextRendering_Flush()
+        if (g_ShowInfoText || g_ShowProfiler)
         {
-            camera_position_c = glm::vec4(displacement.x, displacement.y, displacement.z - 0.5f, 1.0f);
-            camera_view_vector = glm::vec4(-x, y, -z, 0.0f);
-        }
-        // 3a pessoa (câmera look-at na direção da nave)
-        else
-        {
-            // Recalcula a posição da câmera conforme a posição da nave
-            camera_position_c = glm::vec4(spaceship_position.x + x * distance_to_object, spaceship_position.y + -y * distance_to_object, spaceship_position.z + z * distance_to_object, 1.0f);
-            camera_view_vector = spaceship_position - camera_position_c;
+            PROFILE_SCOPE(PROFILER_TEXT);
+            if (g_ShowInfoText)
+                ShowInfoText(state, g_DrawCalls - draws, g_DrawCpuSeconds - draw_seconds,
+                             g_DrawTriangles - triangles, text_draws);
+            if (g_ShowProfiler)
+                ShowProfilerOverlay();
+            unsigned long text_draws_before = g_TextDrawCalls;
+            GpuTimer_Begin(PROFILER_GPU_HUD);
+            TextRendering_Flush();
+            GpuTimer_End();
+            text_draws = g_TextDrawCalls - text_draws_before;
         }
 
-        // Computamos a matriz "View" utilizando os parâmetros da câmera para
-        // definir o sistema de coordenadas da câmera.  Veja slides 2-14, 184-190 e 236-242 do documento Aula_08_Sistemas_de_Coordenadas.pdf.
-        glm::mat4 view = Matrix_Camera_View(camera_position_c, camera_view_vector, camera_up_vector);
-
-        // Agora computamos a matriz de Projeção.
-        glm::mat4 projection;
-
-        // Note que, no sistema de coordenadas da câmera, os planos near e far
-        // estão no sentido negativo! Veja slides 176-204 do documento Aula_09_Projecoes.pdf.
-        float nearplane = -0.1f;  // Posição do "near plane"
-        float farplane = -500.0f; // Posição do "far plane"
-
-        // Projeção Perspectiva.
-        float field_of_view = 3.141592 / 3.0f;
-        projection = Matrix_Perspective(field_of_view, g_ScreenRatio, nearplane, farplane);
-
-        glm::mat4 model = Matrix_Identity(); // Transformação identidade de modelagem
-
-        // Enviamos as matrizes "view" e "projection" para a placa de vídeo
-        // (GPU). Veja o arquivo "shader_vertex.glsl", onde estas são
-        // efetivamente aplicadas em todos os pontos.
-        glUniformMatrix4fv(g_view_uniform, 1, GL_FALSE, glm::value_ptr(view));
-        glUniformMatrix4fv(g_projection_uniform, 1, GL_FALSE, glm::value_ptr(projection));
-
-        #define ASTEROID 0
-        #define SPACESHIP 1
-        #define SPHERE 2
-        #define COIN 3
-        #define MOON 4
-
-        glCullFace(GL_FRONT);
-        // Desenhamos o modelo da esfera
-        model = Matrix_Translate(-10.0f, -10.0f, 1.0f) * Matrix_Scale(500.0f, 500.0f, 500.0f);
-        glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(model));
-        glUniform1i(g_object_id_uniform, SPHERE);
-        DrawVirtualObject("the_sphere");
-        glCullFace(GL_BACK);
-
-        // Desenhamos o modelo da lua
-        model = Matrix_Translate(10.0f, 10.0f, -10.0f) * Matrix_Scale(4.0f, 4.0f, 4.0f);
-        glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(model));
-        glUniform1i(g_object_id_uniform, MOON);
-        DrawVirtualObject("moon");
-
-        // Definimos HitSphere da lua
-        HitSphere MoonHitSphere = {glm::vec3(20.0f, 20.0f, -20.0f), 8.0};
-
-        // Desenhamos o modelo da nave
-        model = Matrix_Translate(spaceship_position.x, spaceship_position.y, spaceship_position.z)
-                * Matrix_Scale(0.5f, 0.5f, 0.5f)
-                * Matrix_Rotate_Y(3.1415 + g_CameraTheta)
-                * Matrix_Rotate_X(g_CameraPhi)
-                * Matrix_Rotate_Z(g_AngleZ * 0.1f);
-
-        glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(model));
-        glUniform1i(g_object_id_uniform, SPACESHIP);
-        DrawVirtualObject("Cube");
-
-        // Desenhamos os modelos das moedas
-        LoadCoins();
-
-        // Desenhamos os modelos dos asteroides
-        LoadAsteroids();
-
-        // pontos da curva de Bezier
-        p1Bezier = glm::vec4(-200, -100, -100, 1);
-        p2Bezier = glm::vec4(-100, 100, -80, 1);
-        p3Bezier = glm::vec4(80, 80, -80, 1);
-        p4Bezier = glm::vec4(150, -120, -60, 1);
-
-        // Desenha asteroides em relação ao seu ponto atual na curva de Bezier
-        float asteroid_time = current_time - start_bezier;
-        // t precisa estar em um intervalo entre 0 e 1
-        if (start_bezier == 0)
-        {
-            // cria os pontos de bezier (4)
-            start_bezier = current_time;
-        }
-        else if (asteroid_time >= 10)
+        // A cada 5 segundos zeramos os contadores de DrawVirtualObject() e,
+        // com a opção "--stats", imprimimos o tempo médio por quadro e o
+        // custo médio de CPU por chamada.
+        stats_frames += 1;
+        if (current_time - stats_time >= 5.0f)
         {
-            start_bezier = 0;
-        }
-        else
-        {
-            t = asteroid_time / 10;
-            // Seguimos formula
-            glm::vec4 bezier_place = (float)(pow(1 - t, 3)) * p1Bezier + (float)(3 * t * pow(1 - t, 2)) * p2Bezier + (float)(3 * pow(t, 2) * (1 - t)) * p3Bezier + (float)(pow(t, 3)) * p4Bezier;
-            // Desenhamos o modelo da esfera
-            model = Matrix_Translate(bezier_place.x, bezier_place.y, bezier_place.z) * Matrix_Scale(4.6f, 6.4f, 7.0f);
-            glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(model));
-            glUniform1i(g_object_id_uniform, ASTEROID);
-            DrawVirtualObject("Asteroid");
+            if (print_stats && g_DrawCalls > 0)
+                printf("Asteroides: %d, %.2f ms por quadro, draws: %lu, %.2f us de CPU por draw\n",
+                       (int)g_AsteroidInstances.size(), 1e3f * (current_time - stats_time) / stats_frames,
+                       g_DrawCalls, 1e6 * g_DrawCpuSeconds / g_DrawCalls);
+            g_DrawCalls = 0;
+            g_DrawCpuSeconds = 0.0;
+            stats_time = current_time;
+            stats_frames = 0;
         }
 
-        // Variáveis para utilizar no sistema de colisões da nave
-        glm::vec3 SpaceshipDimensions = glm::vec3(0.2f, 0.2f, 1.0);
-        glm::vec3 BackLeft = glm::vec3(spaceship_position.x, spaceship_position.y, spaceship_position.z) - SpaceshipDimensions * 0.5f + glm::vec3(displacement.x, displacement.y, displacement.z);
-        glm::vec3 FrontRight = glm::vec3(spaceship_position.x, spaceship_position.y, spaceship_position.z) + SpaceshipDimensions * 0.5f + glm::vec3(displacement.x, displacement.y, displacement.z);
-
-        HitBox SpaceshipHitBox = {BackLeft, FrontRight};
-
-        if (SpaceshipCoinCollision(SpaceshipHitBox, Coin0HitBox))
         {
-            DrawCoin0 = false;
+            PROFILE_SCOPE(PROFILER_SWAP);
+            glfwSwapBuffers(window);
         }
 
-        if (SpaceshipCoinCollision(SpaceshipHitBox, Coin1HitBox))
+        // Tempo desde glfwInit() até o primeiro quadro, que não espera os
+        // recursos não essenciais
+        if (!first_frame_shown)
         {
-            DrawCoin1 = false;
+            printf("Primeiro quadro em %.1f ms.\n", 1e3 * glfwGetTime());
+            first_frame_shown = true;
         }
 
-        if (SpaceshipCoinCollision(SpaceshipHitBox, Coin2HitBox))
         {
-            DrawCoin2 = false;
+            PROFILE_SCOPE(PROFILER_INPUT);
+            glfwPollEvents();
         }
-
-        // Se houver colisão com algum asteróide, lua ou com o "universo"
-        if (SpaceshipAsteroidCollision(SpaceshipHitBox, Asteroid0HitBox) ||
-            SpaceshipAsteroidCollision(SpaceshipHitBox, Asteroid1HitBox) ||
-            SpaceshipAsteroidCollision(SpaceshipHitBox, Asteroid2HitBox) ||
-            SpaceshipAsteroidCollision(SpaceshipHitBox, Asteroid3HitBox) ||
-            SpaceshipAsteroidCollision(SpaceshipHitBox, Asteroid4HitBox) ||
-            SpaceshipAsteroidCollision(SpaceshipHitBox, Asteroid5HitBox) ||
-            SpaceshipMoonCollision(SpaceshipHitBox, MoonHitSphere) ||
-            SpaceshipUniverseCollision(SpaceshipHitBox, UniverseLimit))
-        {
-            // Spaceship retorna para origem
-            displacement = glm::vec4(0.0f, 0.0f, 0.0f, 0.0f);
-
-            // Colocamos coins novamente no mapa
-            DrawCoin0 = true;
-            DrawCoin1 = true;
-            DrawCoin2 = true;
-
-            g_CameraTheta = 0;
-            g_CameraPhi = 0;
-        }
-
-
-        glfwSwapBuffers(window);
-
-        glfwPollEvents();
     }
 
+    // Se a janela for fechada antes de todos os recursos serem carregados,
+    // esperamos as threads de carregamento terminarem (e gravarem os seus
+    // arquivos ".mesh" e ".tex") antes de destruí-las
+    UploadLoadedAssets(true);
+
     // Finalizamos o uso dos recursos do sistema operacional
     glfwTerminate();
 
@@ -601,589 +373,134 @@ int main(int argc, char *argv[])
     return 0;
 }
 
-void LoadAsteroids()
-{
-    glm::mat4 model = Matrix_Identity();
-
-    // Desenhamos os modelos de asteroides
-    model = Matrix_Translate(0.0f, -2.5f, -6.0f);
-    glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(model));
-    glUniform1i(g_object_id_uniform, ASTEROID);
-    DrawVirtualObject("Asteroid");
-
-    // Definimos HitBox do Asteroide0
-    glm::vec3 AsteroidDimensions = glm::vec3(4.0f, 4.0f, 3.0f);
-    glm::vec3 BackLeft = glm::vec3(0.0f, -5.0f, -12.5f) - AsteroidDimensions * 0.5f;
-    glm::vec3 FrontRight = glm::vec3(0.0f, -5.0f, -12.5f) + AsteroidDimensions * 0.5f;
-    Asteroid0HitBox = {BackLeft, FrontRight};
-
-    // Asteroid1
-    model = Matrix_Translate(6.0f, -1.5f, -14.5f) * Matrix_Scale(1.75, 1.5, 1.0);
-    glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(model));
-    glUniform1i(g_object_id_uniform, ASTEROID);
-    DrawVirtualObject("Asteroid");
-
-    AsteroidDimensions = glm::vec3(7.0f, 3.5f, 3.0f);
-    BackLeft = glm::vec3(10.5f, -3.0f, -30.f) - AsteroidDimensions * 0.5f;
-    FrontRight = glm::vec3(10.5f, -2.25f, -30.0f) + AsteroidDimensions * 0.5f;
-    Asteroid1HitBox = {BackLeft, FrontRight};
-
-    // Asteroid2
-    model = Matrix_Translate(1.0f, -0.5f, -10.5f) * Matrix_Rotate_Z(4.0);
-    glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(model));
-    glUniform1i(g_object_id_uniform, ASTEROID);
-    DrawVirtualObject("Asteroid");
-
-    AsteroidDimensions = glm::vec3(4.0f, 2.0f, 3.0f);
-    BackLeft = glm::vec3(1.0f, -0.80f, -22.0) - AsteroidDimensions * 0.5f;
-    FrontRight = glm::vec3(1.0f, -0.80f, -22.0) + AsteroidDimensions * 0.5f;
-    Asteroid2HitBox = {BackLeft, FrontRight};
-
-    // Asteroid3
-    model = Matrix_Translate(0.5f, 2.5f, -10.0f) * Matrix_Rotate_X(3.0) * Matrix_Scale(1.0, 0.9, 1.45);
-    glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(model));
-    glUniform1i(g_object_id_uniform, ASTEROID);
-    DrawVirtualObject("Asteroid");
-
-    AsteroidDimensions = glm::vec3(4.0f, 2.0f, 3.0f);
-    BackLeft = glm::vec3(1.5f, 5.0f, -20.0) - AsteroidDimensions * 0.5f;
-    FrontRight = glm::vec3(1.5f, 5.0f, -20.0) + AsteroidDimensions * 0.5f;
-    Asteroid3HitBox = {BackLeft, FrontRight};
-
-    // Asteroid4
-    model = Matrix_Translate(-2.5f, 1.0f, -7.5f) * Matrix_Rotate_Y(2.0) * Matrix_Scale(0.6, 1.2, 1.25);
-    glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(model));
-    glUniform1i(g_object_id_uniform, ASTEROID);
-    DrawVirtualObject("Asteroid");
-
-    AsteroidDimensions = glm::vec3(4.0f, 5.0f, 3.0f);
-    BackLeft = glm::vec3(-4.5f, 2.0f, -15.0) - AsteroidDimensions * 0.5f;
-    FrontRight = glm::vec3(-4.5f, 2.0f, -15.0) + AsteroidDimensions * 0.5f;
-    Asteroid4HitBox = {BackLeft, FrontRight};
-
-    // Asteroid5
-    model = Matrix_Translate(-3.5f, -1.5f, -13.5f) * Matrix_Rotate_Z(1.0) * Matrix_Scale(0.95, 1.0, 1.4);
-    glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(model));
-    glUniform1i(g_object_id_uniform, ASTEROID);
-    DrawVirtualObject("Asteroid");
-
-    AsteroidDimensions = glm::vec3(7.0f, 1.5f, 3.5f);
-    BackLeft = glm::vec3(-7.0f, -3.9f, -27.0) - AsteroidDimensions * 0.5f;
-    FrontRight = glm::vec3(-7.0f, -1.5f, -27.0) + AsteroidDimensions * 0.5f;
-    Asteroid5HitBox = {BackLeft, FrontRight};
-}
-
-void LoadCoins()
+// Escrevemos na tela o número de quadros por segundo, os contadores de
+// desempenho do último quadro e o estado da simulação.
+void ShowInfoText(const SimulationState &state, unsigned long frame_draws, double frame_draw_seconds,
+                  unsigned long frame_triangles, unsigned long text_draws)
 {
-    glm::mat4 model = Matrix_Identity();
-    glm::vec3 CoinDimensions = glm::vec3(3.5f, 1.5f, 2.0f);
-
-    if (DrawCoin0)
-    {
-        // Desenhamos os modelos das moedas
-        model = Matrix_Translate(0.0f, -1.75f, -7.5f) * Matrix_Scale(0.5f, 0.5f, 0.5f) * Matrix_Rotate_Y((float)glfwGetTime());
-        glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(model));
-        glUniform1i(g_object_id_uniform, COIN);
-        DrawVirtualObject("Coin");
-
-        // Definimos HitBox da moeda
-        glm::vec3 BackLeft = glm::vec3(0.0f, -1.75f, -14.5f) - CoinDimensions;
-        glm::vec3 FrontRight = glm::vec3(0.0f, -1.75f, -14.5f) + CoinDimensions;
-        Coin0HitBox = {BackLeft, FrontRight};
-    }
-
-    if (DrawCoin1)
-    {
-        model = Matrix_Translate(0.0f, 0.0f, -14.5f) * Matrix_Scale(0.5f, 0.5f, 0.5f) * Matrix_Rotate_Y((float)glfwGetTime());
-        glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(model));
-        glUniform1i(g_object_id_uniform, COIN);
-        DrawVirtualObject("Coin");
-
-        glm::vec3 BackLeft = glm::vec3(0.0f, 2.0f, -29.0f) - CoinDimensions;
-        glm::vec3 FrontRight = glm::vec3(0.0f, 2.0f, -29.0f) + CoinDimensions;
-        Coin1HitBox = {BackLeft, FrontRight};
-    }
+    // Variáveis estáticas (static) mantém seus valores entre chamadas
+    // subsequentes da função!
+    static float old_seconds = (float)glfwGetTime();
+    static int ellapsed_frames = 0;
+    static char fps_buffer[40] = "?? fps";
 
-    if (DrawCoin2)
-    {
-        model = Matrix_Translate(3.0f, -4.0f, -18.5f) * Matrix_Scale(0.5f, 0.5f, 0.5f) * Matrix_Rotate_Y((float)glfwGetTime());
-        glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(model));
-        glUniform1i(g_object_id_uniform, COIN);
-        DrawVirtualObject("Coin");
-
-        glm::vec3 BackLeft = glm::vec3(5.0f, -6.0f, -36.5f) - CoinDimensions;
-        glm::vec3 FrontRight = glm::vec3(5.0f, -6.0f, -36.5f) + CoinDimensions;
-        Coin2HitBox = {BackLeft, FrontRight};
-    }
-}
+    ellapsed_frames += 1;
 
-// Função que carrega uma imagem para ser utilizada como textura
-void LoadTextureImage(const char *filename)
-{
-    printf("Carregando imagem \"%s\"... ", filename);
+    // Recuperamos o número de segundos que passou desde a execução do programa
+    float seconds = (float)glfwGetTime();
 
-    // Primeiro fazemos a leitura da imagem do disco
-    stbi_set_flip_vertically_on_load(true);
-    int width;
-    int height;
-    int channels;
-    unsigned char *data = stbi_load(filename, &width, &height, &channels, 3);
+    // Número de segundos desde o último cálculo do fps
+    float ellapsed_seconds = seconds - old_seconds;
 
-    if (data == NULL)
+    if (ellapsed_seconds > 1.0f)
     {
-        fprintf(stderr, "ERROR: Cannot open image file \"%s\".\n", filename);
-        std::exit(EXIT_FAILURE);
+        snprintf(fps_buffer, sizeof(fps_buffer), "%.2f fps, %.2f ms por quadro",
+                 ellapsed_frames / ellapsed_seconds, 1e3f * ellapsed_seconds / ellapsed_frames);
+        old_seconds = seconds;
+        ellapsed_frames = 0;
     }
 
-    printf("OK (%dx%d).\n", width, height);
+    int coins = 0;
+    for (int i = 0; i < SIMULATION_NUM_COINS; ++i)
+        coins += state.coin_visible[i] ? 0 : 1;
 
-    // Agora criamos objetos na GPU com OpenGL para armazenar a textura
-    GLuint texture_id;
-    GLuint sampler_id;
-    glGenTextures(1, &texture_id);
-    glGenSamplers(1, &sampler_id);
+    float lineheight = TextRendering_LineHeight();
+    float x = -1.0f + lineheight / 4.0f;
+    float y = 1.0f - lineheight;
+    char buffer[160];
 
-    // Veja slides 95-96 do documento Aula_20_Mapeamento_de_Texturas.pdf
-    glSamplerParameteri(sampler_id, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glSamplerParameteri(sampler_id, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    TextRendering_PrintString(fps_buffer, x, y);
+    y -= lineheight;
 
-    // Parâmetros de amostragem da textura.
-    glSamplerParameteri(sampler_id, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glSamplerParameteri(sampler_id, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    snprintf(buffer, sizeof(buffer), "Asteroides: %d  draws: %lu (%.2f us de CPU cada)  triângulos: %lu  texto: %lu draws",
+             (int)g_AsteroidInstances.size(), frame_draws, (frame_draws > 0) ? 1e6 * frame_draw_seconds / frame_draws : 0.0,
+             frame_triangles, text_draws);
+    TextRendering_PrintString(buffer, x, y);
+    y -= lineheight;
 
-    // Agora enviamos a imagem lida do disco para a GPU
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
-    glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
-    glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+    snprintf(buffer, sizeof(buffer), "Nave: (%+.2f, %+.2f, %+.2f)  rotação: %+.2f",
+             state.displacement.x, state.displacement.y, state.displacement.z, state.angle_z);
+    TextRendering_PrintString(buffer, x, y);
+    y -= lineheight;
 
-    GLuint textureunit = g_NumLoadedTextures;
-    glActiveTexture(GL_TEXTURE0 + textureunit);
-    glBindTexture(GL_TEXTURE_2D, texture_id);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_SRGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
-    glBindSampler(textureunit, sampler_id);
+    snprintf(buffer, sizeof(buffer), "Câmera: theta %+.2f  phi %+.2f  (%s pessoa)",
+             g_CameraTheta, g_CameraPhi, g_UseFirstPersonView ? "1a" : "3a");
+    TextRendering_PrintString(buffer, x, y);
+    y -= lineheight;
 
-    stbi_image_free(data);
-
-    g_NumLoadedTextures += 1;
-}
-
-// Função que desenha um objeto armazenado em g_VirtualScene. Veja definição
-// dos objetos na função BuildTrianglesAndAddToVirtualScene().
-void DrawVirtualObject(const char *object_name)
-{
-    // "Ligamos" o VAO. Informamos que queremos utilizar os atributos de
-    // vértices apontados pelo VAO criado pela função BuildTrianglesAndAddToVirtualScene(). Veja
-    // comentários detalhados dentro da definição de BuildTrianglesAndAddToVirtualScene().
-    glBindVertexArray(g_VirtualScene[object_name].vertex_array_object_id);
-
-    // Setamos as variáveis "bbox_min" e "bbox_max" do fragment shader
-    // com os parâmetros da axis-aligned bounding box (AABB) do modelo.
-    glm::vec3 bbox_min = g_VirtualScene[object_name].bbox_min;
-    glm::vec3 bbox_max = g_VirtualScene[object_name].bbox_max;
-    glUniform4f(g_bbox_min_uniform, bbox_min.x, bbox_min.y, bbox_min.z, 1.0f);
-    glUniform4f(g_bbox_max_uniform, bbox_max.x, bbox_max.y, bbox_max.z, 1.0f);
-
-    // Pedimos para a GPU rasterizar os vértices dos eixos XYZ
-    // apontados pelo VAO como linhas. Veja a definição de
-    // g_VirtualScene[""] dentro da função BuildTrianglesAndAddToVirtualScene(), e veja
-    // a documentação da função glDrawElements() em
-    // http://docs.gl/gl3/glDrawElements.
-    glDrawElements(
-        g_VirtualScene[object_name].rendering_mode,
-        g_VirtualScene[object_name].num_indices,
-        GL_UNSIGNED_INT,
-        (void *)(g_VirtualScene[object_name].first_index * sizeof(GLuint)));
-
-    // "Desligamos" o VAO, evitando assim que operações posteriores venham a
-    // alterar o mesmo. Isso evita bugs.
-    glBindVertexArray(0);
-}
+    snprintf(buffer, sizeof(buffer), "Moedas: %d de %d  colisões: %u  passo: %lu",
+             coins, SIMULATION_NUM_COINS, state.crashes, state.tick);
+    TextRendering_PrintString(buffer, x, y);
+    y -= lineheight;
 
-// Função que carrega os shaders de vértices e de fragmentos que serão
-// utilizados para renderização. Veja slides 180-200 do documento Aula_03_Rendering_Pipeline_Grafico.pdf.
-//
-void LoadShadersFromFiles()
-{
-    GLuint vertex_shader_id = LoadShader_Vertex("../../src/shader_vertex.glsl");
-    GLuint fragment_shader_id = LoadShader_Fragment("../../src/shader_fragment.glsl");
-
-    // Deletamos o programa de GPU anterior, caso ele exista.
-    if (g_GpuProgramID != 0)
-        glDeleteProgram(g_GpuProgramID);
-
-    // Criamos um programa de GPU utilizando os shaders carregados acima.
-    g_GpuProgramID = CreateGpuProgram(vertex_shader_id, fragment_shader_id);
-
-    // Buscamos o endereço das variáveis definidas dentro do Vertex Shader.
-    // Utilizaremos estas variáveis para enviar dados para a placa de vídeo
-    // (GPU)! Veja arquivo "shader_vertex.glsl" e "shader_fragment.glsl".
-    g_model_uniform = glGetUniformLocation(g_GpuProgramID, "model");           // Variável da matriz "model"
-    g_view_uniform = glGetUniformLocation(g_GpuProgramID, "view");             // Variável da matriz "view" em shader_vertex.glsl
-    g_projection_uniform = glGetUniformLocation(g_GpuProgramID, "projection"); // Variável da matriz "projection" em shader_vertex.glsl
-    g_object_id_uniform = glGetUniformLocation(g_GpuProgramID, "object_id");   // Variável "object_id" em shader_fragment.glsl
-    g_bbox_min_uniform = glGetUniformLocation(g_GpuProgramID, "bbox_min");
-    g_bbox_max_uniform = glGetUniformLocation(g_GpuProgramID, "bbox_max");
-
-    // Variáveis em "shader_fragment.glsl" para acesso das imagens de textura
-    glUseProgram(g_GpuProgramID);
-    glUniform1i(glGetUniformLocation(g_GpuProgramID, "TextureImage0"), 0);
-    glUniform1i(glGetUniformLocation(g_GpuProgramID, "TextureImage1"), 1);
-    glUniform1i(glGetUniformLocation(g_GpuProgramID, "TextureImage2"), 2);
-    glUniform1i(glGetUniformLocation(g_GpuProgramID, "TextureImage3"), 3);
-    glUniform1i(glGetUniformLocation(g_GpuProgramID, "TextureImage4"), 4);
-    glUniform1i(glGetUniformLocation(g_GpuProgramID, "TextureImage5"), 5);
-    glUseProgram(0);
+    TextRendering_PrintString("W/A/S/D: mover  Z: girar  espaço: zerar rotação  V: câmera  R: shaders  H: texto  P: profiler  T: trace", x, y);
 }
 
-// Função que computa as normais de um ObjModel, caso elas não tenham sido
-// especificadas dentro do arquivo ".obj"
-void ComputeNormals(ObjModel *model)
+// Escrevemos no canto inferior esquerdo da tela a média, o percentil 99 e o
+// último valor do tempo de CPU de cada estágio nos últimos PROFILER_HISTORY
+// quadros (veja "profiler.h"). "outros" é o tempo do quadro fora dos estágios
+// medidos. Abaixo, os tempos de GPU de cada passe de renderização, se o
+// driver os mede (veja "gputimer.h").
+void ShowProfilerOverlay()
 {
-    if (!model->attrib.normals.empty())
+    ProfilerStats frame;
+    if (!Profiler_FrameStats(&frame))
         return;
 
-    // Primeiro computamos as normais para todos os TRIÂNGULOS.
-    // Segundo, computamos as normais dos VÉRTICES através do método proposto
-    // por Gouraud, onde a normal de cada vértice vai ser a média das normais de
-    // todas as faces que compartilham este vértice.
-
-    size_t num_vertices = model->attrib.vertices.size() / 3;
-
-    std::vector<int> num_triangles_per_vertex(num_vertices, 0);
-    std::vector<glm::vec4> vertex_normals(num_vertices, glm::vec4(0.0f, 0.0f, 0.0f, 0.0f));
-
-    for (size_t shape = 0; shape < model->shapes.size(); ++shape)
-    {
-        size_t num_triangles = model->shapes[shape].mesh.num_face_vertices.size();
-
-        for (size_t triangle = 0; triangle < num_triangles; ++triangle)
-        {
-            assert(model->shapes[shape].mesh.num_face_vertices[triangle] == 3);
-
-            glm::vec4 vertices[3];
-            for (size_t vertex = 0; vertex < 3; ++vertex)
-            {
-                tinyobj::index_t idx = model->shapes[shape].mesh.indices[3 * triangle + vertex];
-                const float vx = model->attrib.vertices[3 * idx.vertex_index + 0];
-                const float vy = model->attrib.vertices[3 * idx.vertex_index + 1];
-                const float vz = model->attrib.vertices[3 * idx.vertex_index + 2];
-                vertices[vertex] = glm::vec4(vx, vy, vz, 1.0);
-            }
-
-            const glm::vec4 a = vertices[0];
-            const glm::vec4 b = vertices[1];
-            const glm::vec4 c = vertices[2];
-
-            const glm::vec4 n = crossproduct(b - a, c - a);
-
-            for (size_t vertex = 0; vertex < 3; ++vertex)
-            {
-                tinyobj::index_t idx = model->shapes[shape].mesh.indices[3 * triangle + vertex];
-                num_triangles_per_vertex[idx.vertex_index] += 1;
-                vertex_normals[idx.vertex_index] += n;
-                model->shapes[shape].mesh.indices[3 * triangle + vertex].normal_index = idx.vertex_index;
-            }
-        }
-    }
-
-    model->attrib.normals.resize(3 * num_vertices);
-
-    for (size_t i = 0; i < vertex_normals.size(); ++i)
+    float lineheight = TextRendering_LineHeight();
+    float charwidth = TextRendering_CharWidth();
+    float x = -1.0f + lineheight / 4.0f;
+    float values_x = x + 14 * charwidth; // Coluna dos números, após o nome
+    ProfilerStats gpu;
+    bool has_gpu = Profiler_GpuPassStats(PROFILER_GPU_NUM_PASSES, &gpu);
+    int rows = PROFILER_NUM_STAGES + 3 + (has_gpu ? PROFILER_GPU_NUM_PASSES + 1 : 0);
+    float y = -1.0f + lineheight / 4.0f + rows * lineheight;
+    char buffer[80];
+
+    TextRendering_PrintString("ms", x, y);
+    TextRendering_PrintString("  média     p99  último", values_x, y);
+    y -= lineheight;
+
+    snprintf(buffer, sizeof(buffer), "%7.2f %7.2f %7.2f", frame.average, frame.p99, frame.last);
+    TextRendering_PrintString(Profiler_StageName(PROFILER_NUM_STAGES), x, y);
+    TextRendering_PrintString(buffer, values_x, y);
+    y -= lineheight;
+
+    // A colisão é medida dentro da simulação; não entra na soma
+    ProfilerStats others = frame;
+    for (int stage = 0; stage < PROFILER_NUM_STAGES; ++stage)
     {
-        glm::vec4 n = vertex_normals[i] / (float)num_triangles_per_vertex[i];
-        n /= norm(n);
-        model->attrib.normals[3 * i + 0] = n.x;
-        model->attrib.normals[3 * i + 1] = n.y;
-        model->attrib.normals[3 * i + 2] = n.z;
-    }
-}
-
-// Constrói triângulos para futura renderização a partir de um ObjModel.
-void BuildTrianglesAndAddToVirtualScene(ObjModel *model)
-{
-    GLuint vertex_array_object_id;
-    glGenVertexArrays(1, &vertex_array_object_id);
-    glBindVertexArray(vertex_array_object_id);
-
-    std::vector<GLuint> indices;
-    std::vector<float> model_coefficients;
-    std::vector<float> normal_coefficients;
-    std::vector<float> texture_coefficients;
-
-    for (size_t shape = 0; shape < model->shapes.size(); ++shape)
-    {
-        size_t first_index = indices.size();
-        size_t num_triangles = model->shapes[shape].mesh.num_face_vertices.size();
-
-        const float minval = std::numeric_limits<float>::min();
-        const float maxval = std::numeric_limits<float>::max();
-
-        glm::vec3 bbox_min = glm::vec3(maxval, maxval, maxval);
-        glm::vec3 bbox_max = glm::vec3(minval, minval, minval);
-
-        for (size_t triangle = 0; triangle < num_triangles; ++triangle)
+        ProfilerStats stats;
+        Profiler_StageStats(stage, &stats);
+        if (stage != PROFILER_COLLISION)
         {
-            assert(model->shapes[shape].mesh.num_face_vertices[triangle] == 3);
-
-            for (size_t vertex = 0; vertex < 3; ++vertex)
-            {
-                tinyobj::index_t idx = model->shapes[shape].mesh.indices[3 * triangle + vertex];
-
-                indices.push_back(first_index + 3 * triangle + vertex);
-
-                const float vx = model->attrib.vertices[3 * idx.vertex_index + 0];
-                const float vy = model->attrib.vertices[3 * idx.vertex_index + 1];
-                const float vz = model->attrib.vertices[3 * idx.vertex_index + 2];
-                // printf("tri %d vert %d = (%.2f, %.2f, %.2f)\n", (int)triangle, (int)vertex, vx, vy, vz);
-                model_coefficients.push_back(vx);   // X
-                model_coefficients.push_back(vy);   // Y
-                model_coefficients.push_back(vz);   // Z
-                model_coefficients.push_back(1.0f); // W
-
-                bbox_min.x = std::min(bbox_min.x, vx);
-                bbox_min.y = std::min(bbox_min.y, vy);
-                bbox_min.z = std::min(bbox_min.z, vz);
-                bbox_max.x = std::max(bbox_max.x, vx);
-                bbox_max.y = std::max(bbox_max.y, vy);
-                bbox_max.z = std::max(bbox_max.z, vz);
-
-                if (idx.normal_index != -1)
-                {
-                    const float nx = model->attrib.normals[3 * idx.normal_index + 0];
-                    const float ny = model->attrib.normals[3 * idx.normal_index + 1];
-                    const float nz = model->attrib.normals[3 * idx.normal_index + 2];
-                    normal_coefficients.push_back(nx);   // X
-                    normal_coefficients.push_back(ny);   // Y
-                    normal_coefficients.push_back(nz);   // Z
-                    normal_coefficients.push_back(0.0f); // W
-                }
-
-                if (idx.texcoord_index != -1)
-                {
-                    const float u = model->attrib.texcoords[2 * idx.texcoord_index + 0];
-                    const float v = model->attrib.texcoords[2 * idx.texcoord_index + 1];
-                    texture_coefficients.push_back(u);
-                    texture_coefficients.push_back(v);
-                }
-            }
+            others.average -= stats.average;
+            others.last -= stats.last;
         }
 
-        size_t last_index = indices.size() - 1;
-
-        SceneObject theobject;
-        theobject.name = model->shapes[shape].name;
-        theobject.first_index = first_index;                  // Primeiro índice
-        theobject.num_indices = last_index - first_index + 1; // Número de indices
-        theobject.rendering_mode = GL_TRIANGLES;              // Índices correspondem ao tipo de rasterização GL_TRIANGLES.
-        theobject.vertex_array_object_id = vertex_array_object_id;
-
-        theobject.bbox_min = bbox_min;
-        theobject.bbox_max = bbox_max;
-
-        g_VirtualScene[model->shapes[shape].name] = theobject;
+        snprintf(buffer, sizeof(buffer), "%7.2f %7.2f %7.2f", stats.average, stats.p99, stats.last);
+        TextRendering_PrintString(stage == PROFILER_COLLISION ? "  colisão" : Profiler_StageName(stage), x, y);
+        TextRendering_PrintString(buffer, values_x, y);
+        y -= lineheight;
     }
 
-    GLuint VBO_model_coefficients_id;
-    glGenBuffers(1, &VBO_model_coefficients_id);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO_model_coefficients_id);
-    glBufferData(GL_ARRAY_BUFFER, model_coefficients.size() * sizeof(float), NULL, GL_STATIC_DRAW);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, model_coefficients.size() * sizeof(float), model_coefficients.data());
-    GLuint location = 0;            // "(location = 0)" em "shader_vertex.glsl"
-    GLint number_of_dimensions = 4; // vec4 em "shader_vertex.glsl"
-    glVertexAttribPointer(location, number_of_dimensions, GL_FLOAT, GL_FALSE, 0, 0);
-    glEnableVertexAttribArray(location);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-    if (!normal_coefficients.empty())
-    {
-        GLuint VBO_normal_coefficients_id;
-        glGenBuffers(1, &VBO_normal_coefficients_id);
-        glBindBuffer(GL_ARRAY_BUFFER, VBO_normal_coefficients_id);
-        glBufferData(GL_ARRAY_BUFFER, normal_coefficients.size() * sizeof(float), NULL, GL_STATIC_DRAW);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, normal_coefficients.size() * sizeof(float), normal_coefficients.data());
-        location = 1;             // "(location = 1)" em "shader_vertex.glsl"
-        number_of_dimensions = 4; // vec4 em "shader_vertex.glsl"
-        glVertexAttribPointer(location, number_of_dimensions, GL_FLOAT, GL_FALSE, 0, 0);
-        glEnableVertexAttribArray(location);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-    }
+    // O percentil 99 de uma diferença não é a diferença dos percentis
+    snprintf(buffer, sizeof(buffer), "%7.2f       - %7.2f", std::max(0.0, others.average), std::max(0.0, others.last));
+    TextRendering_PrintString("outros", x, y);
+    TextRendering_PrintString(buffer, values_x, y);
+    y -= lineheight;
 
-    if (!texture_coefficients.empty())
+    for (int pass = 0; has_gpu && pass <= PROFILER_GPU_NUM_PASSES; ++pass)
     {
-        GLuint VBO_texture_coefficients_id;
-        glGenBuffers(1, &VBO_texture_coefficients_id);
-        glBindBuffer(GL_ARRAY_BUFFER, VBO_texture_coefficients_id);
-        glBufferData(GL_ARRAY_BUFFER, texture_coefficients.size() * sizeof(float), NULL, GL_STATIC_DRAW);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, texture_coefficients.size() * sizeof(float), texture_coefficients.data());
-        location = 2;             // "(location = 1)" em "shader_vertex.glsl"
-        number_of_dimensions = 2; // vec2 em "shader_vertex.glsl"
-        glVertexAttribPointer(location, number_of_dimensions, GL_FLOAT, GL_FALSE, 0, 0);
-        glEnableVertexAttribArray(location);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        ProfilerStats stats;
+        Profiler_GpuPassStats(pass, &stats);
+        snprintf(buffer, sizeof(buffer), "%7.2f %7.2f %7.2f", stats.average, stats.p99, stats.last);
+        TextRendering_PrintString(Profiler_GpuPassName(pass), x, y);
+        TextRendering_PrintString(buffer, values_x, y);
+        y -= lineheight;
     }
 
-    GLuint indices_id;
-    glGenBuffers(1, &indices_id);
-
-    // "Ligamos" o buffer. Note que o tipo agora é GL_ELEMENT_ARRAY_BUFFER.
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indices_id);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), NULL, GL_STATIC_DRAW);
-    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indices.size() * sizeof(GLuint), indices.data());
-    glBindVertexArray(0);
-}
-
-// Carrega um Vertex Shader de um arquivo GLSL. Veja definição de LoadShader() abaixo.
-GLuint LoadShader_Vertex(const char *filename)
-{
-    // Criamos um identificador (ID) para este shader, informando que o mesmo
-    // será aplicado nos vértices.
-    GLuint vertex_shader_id = glCreateShader(GL_VERTEX_SHADER);
-
-    // Carregamos e compilamos o shader
-    LoadShader(filename, vertex_shader_id);
-
-    // Retorna o ID gerado acima
-    return vertex_shader_id;
-}
-
-// Carrega um Fragment Shader de um arquivo GLSL . Veja definição de LoadShader() abaixo.
-GLuint LoadShader_Fragment(const char *filename)
-{
-    // Criamos um identificador (ID) para este shader, informando que o mesmo
-    // será aplicado nos fragmentos.
-    GLuint fragment_shader_id = glCreateShader(GL_FRAGMENT_SHADER);
-
-    // Carregamos e compilamos o shader
-    LoadShader(filename, fragment_shader_id);
-
-    // Retorna o ID gerado acima
-    return fragment_shader_id;
-}
-
-// Função auxilar, utilizada pelas duas funções acima. Carrega código de GPU de
-// um arquivo GLSL e faz sua compilação.
-void LoadShader(const char *filename, GLuint shader_id)
-{
-    // Lemos o arquivo de texto indicado pela variável "filename"
-    // e colocamos seu conteúdo em memória, apontado pela variável
-    // "shader_string".
-    std::ifstream file;
-    try
-    {
-        file.exceptions(std::ifstream::failbit);
-        file.open(filename);
-    }
-    catch (std::exception &e)
-    {
-        fprintf(stderr, "ERROR: Cannot open file \"%s\".\n", filename);
-        std::exit(EXIT_FAILURE);
-    }
-    std::stringstream shader;
-    shader << file.rdbuf();
-    std::string str = shader.str();
-    const GLchar *shader_string = str.c_str();
-    const GLint shader_string_length = static_cast<GLint>(str.length());
-
-    // Define o código do shader GLSL, contido na string "shader_string"
-    glShaderSource(shader_id, 1, &shader_string, &shader_string_length);
-
-    // Compila o código do shader GLSL (em tempo de execução)
-    glCompileShader(shader_id);
-
-    // Verificamos se ocorreu algum erro ou "warning" durante a compilação
-    GLint compiled_ok;
-    glGetShaderiv(shader_id, GL_COMPILE_STATUS, &compiled_ok);
-
-    GLint log_length = 0;
-    glGetShaderiv(shader_id, GL_INFO_LOG_LENGTH, &log_length);
-
-    // Alocamos memória para guardar o log de compilação.
-    // A chamada "new" em C++ é equivalente ao "malloc()" do C.
-    GLchar *log = new GLchar[log_length];
-    glGetShaderInfoLog(shader_id, log_length, &log_length, log);
-
-    // Imprime no terminal qualquer erro ou "warning" de compilação
-    if (log_length != 0)
-    {
-        std::string output;
-
-        if (!compiled_ok)
-        {
-            output += "ERROR: OpenGL compilation of \"";
-            output += filename;
-            output += "\" failed.\n";
-            output += "== Start of compilation log\n";
-            output += log;
-            output += "== End of compilation log\n";
-        }
-        else
-        {
-            output += "WARNING: OpenGL compilation of \"";
-            output += filename;
-            output += "\".\n";
-            output += "== Start of compilation log\n";
-            output += log;
-            output += "== End of compilation log\n";
-        }
-
-        fprintf(stderr, "%s", output.c_str());
-    }
-
-    // A chamada "delete" em C++ é equivalente ao "free()" do C
-    delete[] log;
-}
-
-// Esta função cria um programa de GPU, o qual contém obrigatoriamente um
-// Vertex Shader e um Fragment Shader.
-GLuint CreateGpuProgram(GLuint vertex_shader_id, GLuint fragment_shader_id)
-{
-    // Criamos um identificador (ID) para este programa de GPU
-    GLuint program_id = glCreateProgram();
-
-    // Definição dos dois shaders GLSL que devem ser executados pelo programa
-    glAttachShader(program_id, vertex_shader_id);
-    glAttachShader(program_id, fragment_shader_id);
-
-    // Linkagem dos shaders acima ao programa
-    glLinkProgram(program_id);
-
-    // Verificamos se ocorreu algum erro durante a linkagem
-    GLint linked_ok = GL_FALSE;
-    glGetProgramiv(program_id, GL_LINK_STATUS, &linked_ok);
-
-    // Imprime no terminal qualquer erro de linkagem
-    if (linked_ok == GL_FALSE)
-    {
-        GLint log_length = 0;
-        glGetProgramiv(program_id, GL_INFO_LOG_LENGTH, &log_length);
-
-        // Alocamos memória para guardar o log de compilação.
-        // A chamada "new" em C++ é equivalente ao "malloc()" do C.
-        GLchar *log = new GLchar[log_length];
-
-        glGetProgramInfoLog(program_id, log_length, &log_length, log);
-
-        std::string output;
-
-        output += "ERROR: OpenGL linking of program failed.\n";
-        output += "== Start of link log\n";
-        output += log;
-        output += "\n== End of link log\n";
-
-        // A chamada "delete" em C++ é equivalente ao "free()" do C
-        delete[] log;
-
-        fprintf(stderr, "%s", output.c_str());
-    }
-
-    // Os "Shader Objects" podem ser marcados para deleção após serem linkados
-    glDeleteShader(vertex_shader_id);
-    glDeleteShader(fragment_shader_id);
-
-    // Retornamos o ID gerado acima
-    return program_id;
+    TextRendering_PrintString(Profiler_Capturing() ? "Gravando trace em " TRACE_FILENAME "..." : "T: gravar trace", x, y);
 }
 
 // Definição da função que será chamada sempre que a janela do sistema
@@ -1205,6 +522,13 @@ void FramebufferSizeCallback(GLFWwindow *window, int width, int height)
     // O cast para float é necessário pois números inteiros são arredondados ao
     // serem divididos!
     g_ScreenRatio = (float)width / height;
+
+    // O texto é posicionado em relação ao tamanho da janela, que pode diferir
+    // do framebuffer em telas de alta densidade. Consultamos a janela somente
+    // aqui; as funções de texto usam as métricas guardadas em g_TextLayout.
+    int window_width, window_height;
+    glfwGetWindowSize(window, &window_width, &window_height);
+    TextRendering_SetWindowSize(window_width, window_height);
 }
 
 // Variáveis globais que armazenam a última posição do cursor do mouse, para
@@ -1301,7 +625,7 @@ void KeyCallback(GLFWwindow *window, int key, int scancode, int action, int mod)
     {
         g_AngleX = 0.0f;
         g_AngleY = 0.0f;
-        g_AngleZ = 0.0f;
+        g_ResetSpaceshipRoll = true; // g_AngleZ é controlado pela simulação
     }
 
     if (key == GLFW_KEY_V && action == GLFW_PRESS)
@@ -1309,6 +633,25 @@ void KeyCallback(GLFWwindow *window, int key, int scancode, int action, int mod)
         g_UseFirstPersonView = !g_UseFirstPersonView;
     }
 
+    // Se o usuário apertar a tecla H, fazemos um "toggle" do texto informativo mostrado na tela.
+    if (key == GLFW_KEY_H && action == GLFW_PRESS)
+    {
+        g_ShowInfoText = !g_ShowInfoText;
+    }
+
+    // Se o usuário apertar a tecla P, mostramos ou escondemos os tempos do profiler.
+    if (key == GLFW_KEY_P && action == GLFW_PRESS)
+    {
+        g_ShowProfiler = !g_ShowProfiler;
+    }
+
+    // Se o usuário apertar a tecla T, gravamos os próximos TRACE_FRAMES
+    // quadros em um arquivo de trace, que pode ser aberto em chrome://tracing.
+    if (key == GLFW_KEY_T && action == GLFW_PRESS)
+    {
+        Profiler_CaptureTrace(TRACE_FILENAME, TRACE_FRAMES);
+    }
+
     // Se o usuário apertar a tecla R, recarregamos os shaders dos arquivos "shader_fragment.glsl" e "shader_vertex.glsl".
     if (key == GLFW_KEY_R && action == GLFW_PRESS)
     {
@@ -0,0 +1,237 @@
+#include "meshcache.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "cachefile.h"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+// Cabeçalho de um arquivo ".mesh". Logo após o cabeçalho vêm, em ordem:
+//   num_shapes   x MeshShape
+//   num_vertices x MeshVertex
+//   index_bytes  bytes de índices (16 ou 32 bits, veja MeshShape)
+struct MeshCacheHeader
+{
+    char magic[4];          // "SEMC"
+    uint32_t version;       // MESH_CACHE_VERSION
+    uint64_t source_size;   // Tamanho em bytes do arquivo OBJ de origem
+    int64_t source_mtime;   // Data de modificação do arquivo OBJ de origem (veja CacheFile_Stat())
+    uint64_t source_hash;   // Hash FNV-1a do conteúdo do arquivo OBJ
+    uint32_t num_shapes;
+    uint32_t num_vertices;
+    uint32_t index_bytes;
+    uint32_t flags;
+};
+
+static const char MESH_CACHE_MAGIC[4] = {'S', 'E', 'M', 'C'};
+
+MeshView MeshData_View(const MeshData &mesh)
+{
+    MeshView view;
+    view.shapes = mesh.shapes.data();
+    view.num_shapes = (uint32_t)mesh.shapes.size();
+    view.vertices = mesh.vertices.data();
+    view.num_vertices = (uint32_t)mesh.vertices.size();
+    view.indices = mesh.indices.data();
+    view.index_bytes = (uint32_t)mesh.indices.size();
+    view.flags = mesh.flags;
+    return view;
+}
+
+std::string MeshCache_Filename(const char *obj_filename)
+{
+    return CacheFile_Filename(obj_filename, ".mesh");
+}
+
+void *MeshCache_MapFile(const char *filename, size_t *size)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return NULL;
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return NULL;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (mapping == NULL)
+        return NULL;
+
+    void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (data == NULL)
+        return NULL;
+
+    *size = (size_t)file_size.QuadPart;
+    return data;
+#else
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        close(fd);
+        return NULL;
+    }
+
+    void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return NULL;
+
+    *size = (size_t)st.st_size;
+    return data;
+#endif
+}
+
+void MeshCache_UnmapFile(void *data, size_t size)
+{
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+#else
+    munmap(data, size);
+#endif
+}
+
+// Confere se cada objeto do cache referencia somente dados dentro dos
+// buffers mapeados. Um cache corrompido com tamanho total correto poderia,
+// caso contrário, levar a leituras fora do arquivo ao enviar a malha à GPU.
+static bool MeshCache_ShapesValid(const MeshCacheHeader *header, const MeshShape *shapes,
+                                  const unsigned char *indices)
+{
+    for (uint32_t i = 0; i < header->num_shapes; ++i)
+    {
+        const MeshShape &shape = shapes[i];
+
+        if (memchr(shape.name, '\0', sizeof(shape.name)) == NULL)
+            return false;
+        if (shape.index_size != 2 && shape.index_size != 4)
+            return false;
+        if (shape.index_offset % shape.index_size != 0)
+            return false;
+        if ((uint64_t)shape.index_offset + (uint64_t)shape.num_indices * shape.index_size > header->index_bytes)
+            return false;
+        if ((uint64_t)shape.base_vertex + shape.num_vertices > header->num_vertices)
+            return false;
+
+        // Os índices são relativos a "base_vertex"
+        const unsigned char *p = indices + shape.index_offset;
+        for (uint32_t j = 0; j < shape.num_indices; ++j)
+        {
+            uint32_t index = (shape.index_size == 2) ? ((const uint16_t *)p)[j] : ((const uint32_t *)p)[j];
+            if (index >= shape.num_vertices)
+                return false;
+        }
+    }
+    return true;
+}
+
+bool MeshCache_Open(const char *obj_filename, MeshCacheFile *file)
+{
+    std::string cache_filename = MeshCache_Filename(obj_filename);
+
+    size_t size = 0;
+    void *data = MeshCache_MapFile(cache_filename.c_str(), &size);
+    if (data == NULL)
+        return false;
+
+    const MeshCacheHeader *header = (const MeshCacheHeader *)data;
+
+    bool valid = size >= sizeof(MeshCacheHeader) &&
+                 memcmp(header->magic, MESH_CACHE_MAGIC, 4) == 0 &&
+                 header->version == MESH_CACHE_VERSION;
+
+    if (valid)
+    {
+        size_t expected = sizeof(MeshCacheHeader) +
+                          (size_t)header->num_shapes * sizeof(MeshShape) +
+                          (size_t)header->num_vertices * sizeof(MeshVertex) +
+                          (size_t)header->index_bytes;
+        valid = (size == expected);
+    }
+
+    if (valid)
+    {
+        const unsigned char *shapes = (const unsigned char *)data + sizeof(MeshCacheHeader);
+        const unsigned char *indices = shapes +
+                                       (size_t)header->num_shapes * sizeof(MeshShape) +
+                                       (size_t)header->num_vertices * sizeof(MeshVertex);
+        valid = MeshCache_ShapesValid(header, (const MeshShape *)shapes, indices);
+    }
+
+    // O cache só é válido se o OBJ de origem não mudou
+    if (valid)
+        valid = CacheFile_SourceUnchanged(obj_filename, header->source_size, header->source_mtime, header->source_hash);
+
+    if (!valid)
+    {
+        MeshCache_UnmapFile(data, size);
+        return false;
+    }
+
+    const char *p = (const char *)data + sizeof(MeshCacheHeader);
+
+    file->mapping = data;
+    file->size = size;
+    file->view.shapes = (const MeshShape *)p;
+    file->view.num_shapes = header->num_shapes;
+    p += header->num_shapes * sizeof(MeshShape);
+    file->view.vertices = (const MeshVertex *)p;
+    file->view.num_vertices = header->num_vertices;
+    p += (size_t)header->num_vertices * sizeof(MeshVertex);
+    file->view.indices = p;
+    file->view.index_bytes = header->index_bytes;
+    file->view.flags = header->flags;
+
+    return true;
+}
+
+void MeshCache_Close(MeshCacheFile *file)
+{
+    if (file->mapping != NULL)
+        MeshCache_UnmapFile(file->mapping, file->size);
+
+    file->mapping = NULL;
+    file->size = 0;
+}
+
+bool MeshCache_Write(const char *obj_filename, const MeshView &mesh)
+{
+    MeshCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MESH_CACHE_MAGIC, 4);
+    header.version = MESH_CACHE_VERSION;
+    header.num_shapes = mesh.num_shapes;
+    header.num_vertices = mesh.num_vertices;
+    header.index_bytes = mesh.index_bytes;
+    header.flags = mesh.flags;
+
+    if (!CacheFile_Stat(obj_filename, &header.source_size, &header.source_mtime) ||
+        !CacheFile_Hash(obj_filename, &header.source_hash))
+        return false;
+
+    CacheFileChunk chunks[3] = {
+        {mesh.shapes, (size_t)mesh.num_shapes * sizeof(MeshShape)},
+        {mesh.vertices, (size_t)mesh.num_vertices * sizeof(MeshVertex)},
+        {mesh.indices, (size_t)mesh.index_bytes},
+    };
+    std::string cache_filename = MeshCache_Filename(obj_filename);
+    return CacheFile_Write(cache_filename.c_str(), &header, sizeof(header), chunks, 3);
+}
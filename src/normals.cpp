@@ -0,0 +1,146 @@
+#include "normals.h"
+
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include <vector>
+
+// Número de triângulos a partir do qual vale a pena criar mais uma thread
+#define NORMALS_TRIANGLES_PER_THREAD 65536
+
+// Acumula em "accum" (X, Y, Z por vértice) as normais ponderadas dos
+// triângulos [begin, end). "accum" deve estar zerado.
+static void AccumulateNormals(const float *positions, const int *triangles, size_t begin, size_t end,
+                              int weighting, float *accum)
+{
+    for (size_t t = begin; t < end; ++t)
+    {
+        const int *v = &triangles[3 * t];
+        const float *a = &positions[3 * v[0]];
+        const float *b = &positions[3 * v[1]];
+        const float *c = &positions[3 * v[2]];
+
+        const float ab[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+        const float ac[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+
+        // Produto vetorial: direção da face, com norma igual ao dobro da área
+        const float n[3] = {ab[1] * ac[2] - ab[2] * ac[1],
+                            ab[2] * ac[0] - ab[0] * ac[2],
+                            ab[0] * ac[1] - ab[1] * ac[0]};
+
+        if (weighting == NORMALS_WEIGHT_AREA)
+        {
+            for (int i = 0; i < 3; ++i)
+            {
+                float *out = &accum[3 * v[i]];
+                out[0] += n[0];
+                out[1] += n[1];
+                out[2] += n[2];
+            }
+            continue;
+        }
+
+        float length = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        if (length == 0.0f)
+            continue;
+
+        // Em qualquer vértice do triângulo, a norma do produto vetorial das
+        // duas arestas é "length"; o ângulo é atan2(|e1 x e2|, e1 . e2), mais
+        // preciso que acos() para ângulos muito pequenos ou muito abertos.
+        const float bc[3] = {c[0] - b[0], c[1] - b[1], c[2] - b[2]};
+        float angles[3];
+        angles[0] = atan2f(length, ab[0] * ac[0] + ab[1] * ac[1] + ab[2] * ac[2]);
+        angles[1] = atan2f(length, -(ab[0] * bc[0] + ab[1] * bc[1] + ab[2] * bc[2]));
+        angles[2] = atan2f(length, ac[0] * bc[0] + ac[1] * bc[1] + ac[2] * bc[2]);
+
+        float inv_length = 1.0f / length;
+        for (int i = 0; i < 3; ++i)
+        {
+            float w = angles[i] * inv_length;
+            float *out = &accum[3 * v[i]];
+            out[0] += w * n[0];
+            out[1] += w * n[1];
+            out[2] += w * n[2];
+        }
+    }
+}
+
+// Soma as normais parciais dos vértices [begin, end) em "normals" (que já
+// contém as normais acumuladas pela primeira thread) e as normaliza
+static void ReduceNormals(const std::vector<std::vector<float> > &partials, size_t begin, size_t end, float *normals)
+{
+    for (size_t i = begin; i < end; ++i)
+    {
+        float x = normals[3 * i + 0];
+        float y = normals[3 * i + 1];
+        float z = normals[3 * i + 2];
+        for (size_t p = 0; p < partials.size(); ++p)
+        {
+            x += partials[p][3 * i + 0];
+            y += partials[p][3 * i + 1];
+            z += partials[p][3 * i + 2];
+        }
+
+        float length = sqrtf(x * x + y * y + z * z);
+        float inv_length = (length > 0.0f) ? 1.0f / length : 0.0f;
+        normals[3 * i + 0] = x * inv_length;
+        normals[3 * i + 1] = y * inv_length;
+        normals[3 * i + 2] = z * inv_length;
+    }
+}
+
+void ComputeVertexNormals(const float *positions, size_t num_vertices, const int *triangles, size_t num_triangles,
+                          int weighting, float *normals, int num_threads)
+{
+    if (num_threads <= 0)
+    {
+        num_threads = (int)std::thread::hardware_concurrency();
+        int useful = (int)(num_triangles / NORMALS_TRIANGLES_PER_THREAD) + 1;
+        if (num_threads > useful)
+            num_threads = useful;
+    }
+    if (num_threads < 1)
+        num_threads = 1;
+
+    memset(normals, 0, 3 * num_vertices * sizeof(float));
+
+    if (num_threads == 1)
+    {
+        AccumulateNormals(positions, triangles, 0, num_triangles, weighting, normals);
+        std::vector<std::vector<float> > no_partials;
+        ReduceNormals(no_partials, 0, num_vertices, normals);
+        return;
+    }
+
+    // A primeira thread acumula diretamente em "normals"; as outras, em
+    // vetores próprios, zerados pela própria thread que os utiliza
+    std::vector<std::vector<float> > partials(num_threads - 1);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t)
+    {
+        size_t begin = num_triangles * t / num_threads;
+        size_t end = num_triangles * (t + 1) / num_threads;
+        threads.push_back(std::thread([=, &partials]() {
+            float *accum = normals;
+            if (t > 0)
+            {
+                partials[t - 1].assign(3 * num_vertices, 0.0f);
+                accum = partials[t - 1].data();
+            }
+            AccumulateNormals(positions, triangles, begin, end, weighting, accum);
+        }));
+    }
+    for (size_t t = 0; t < threads.size(); ++t)
+        threads[t].join();
+    threads.clear();
+
+    for (int t = 0; t < num_threads; ++t)
+    {
+        size_t begin = num_vertices * t / num_threads;
+        size_t end = num_vertices * (t + 1) / num_threads;
+        threads.push_back(std::thread(ReduceNormals, std::cref(partials), begin, end, normals));
+    }
+    for (size_t t = 0; t < threads.size(); ++t)
+        threads[t].join();
+}
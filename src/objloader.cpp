@@ -0,0 +1,916 @@
+#include "objloader.h"
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstring>
+#include <map>
+#include <set>
+#include <sstream>
+#include <thread>
+
+#include "floatparse.h"
+#include "meshcache.h"
+
+// Tamanho mínimo de um trecho, e número de bytes a partir do qual vale a
+// pena criar mais uma thread
+#define OBJ_CHUNK_MIN_BYTES  (256 * 1024)
+#define OBJ_BYTES_PER_THREAD (1024 * 1024)
+
+// Trechos por thread: com mais trechos do que threads o trabalho fica
+// equilibrado mesmo quando partes do arquivo são mais caras que outras (ex:
+// muitas faces e poucos vértices)
+#define OBJ_CHUNKS_PER_THREAD 4
+
+// Comandos que alteram o estado da leitura, repetidos em ordem por
+// MergeChunks() (campo "type" de ObjEvent)
+#define OBJ_EVENT_USEMTL    0
+#define OBJ_EVENT_MTLLIB    1
+#define OBJ_EVENT_GROUP     2
+#define OBJ_EVENT_OBJECT    3
+#define OBJ_EVENT_SMOOTHING 4
+#define OBJ_EVENT_WARNING   5 // Aviso da leitura, mantido na ordem do arquivo
+
+#define OBJ_IS_SPACE(x) (((x) == ' ') || ((x) == '\t'))
+#define OBJ_IS_DIGIT(x) ((unsigned int)((x) - '0') < 10u)
+
+struct ObjEvent
+{
+    int type;
+    size_t raw_face; // Faces lidas no trecho antes do comando
+    size_t face;     // Faces do trecho antes do comando, após a triangulação
+    size_t corner;   // Índices (tinyobj::index_t) do trecho antes do comando, após a triangulação
+    size_t line;     // Número da linha no arquivo, para as mensagens de aviso
+    unsigned int smoothing;
+    std::vector<std::string> names; // Material, arquivos MTL, nomes do grupo, nome do objeto ou aviso
+};
+
+// Um trecho do arquivo, terminado em fim de linha
+struct ObjChunk
+{
+    const char *begin = NULL;
+    const char *end = NULL;
+
+    // Passo 1: contagens do trecho, e índices globais da primeira linha e do
+    // primeiro elemento de cada tipo
+    size_t num_lines = 0, num_v = 0, num_vn = 0, num_vt = 0;
+    size_t first_line = 0, first_v = 0, first_vn = 0, first_vt = 0;
+
+    // Passo 2 (e passo 3, se o trecho tiver quadriláteros)
+    std::vector<tinyobj::index_t> indices;
+    std::vector<unsigned char> face_sizes;
+    std::vector<ObjEvent> events;
+    size_t num_faces = 0; // Faces lidas, antes da triangulação
+    bool has_quads = false;
+    int greatest_v = -1, greatest_vn = -1, greatest_vt = -1;
+
+    bool unsupported = false; // Contém elementos lidos somente por tinyobj::LoadObj()
+    std::string error;
+};
+
+// Executa "function(i)" para i em [0, count), distribuindo os índices entre
+// "num_threads" threads com um contador atômico
+template <typename Function>
+static void ParallelFor(size_t count, int num_threads, Function function)
+{
+    if (num_threads <= 1 || count <= 1)
+    {
+        for (size_t i = 0; i < count; ++i)
+            function(i);
+        return;
+    }
+
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads && t < (int)count; ++t)
+    {
+        threads.push_back(std::thread([&]() {
+            for (size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1))
+                function(i);
+        }));
+    }
+    for (size_t t = 0; t < threads.size(); ++t)
+        threads[t].join();
+}
+
+// Próxima linha a partir de "*p": retorna o seu fim (sem o '\n' ou "\r\n"
+// final) e avança "*p" para o início da linha seguinte
+static inline const char *NextLine(const char **p, const char *end)
+{
+    const char *begin = *p;
+    const char *newline = (const char *)memchr(begin, '\n', end - begin);
+    const char *e = (newline != NULL) ? newline : end;
+    *p = (newline != NULL) ? newline + 1 : end;
+    if (e > begin && e[-1] == '\r')
+        --e;
+    return e;
+}
+
+// As funções abaixo repetem as de "tiny_obj_loader.h" (parseString(),
+// atoi(), parseReal(), fixIndex() e parseTriple()), mas com o fim da linha
+// "e" explícito, já que as linhas não são copiadas para strings terminadas
+// em '\0'. Os números são convertidos por ParseFloat() (veja
+// "floatparse.h").
+
+static inline const char *SkipSpaces(const char *p, const char *e)
+{
+    while (p < e && OBJ_IS_SPACE(*p))
+        ++p;
+    return p;
+}
+
+// Fim do token que começa em "p": primeiro ' ', '\t' ou '\r'
+static inline const char *TokenEnd(const char *p, const char *e)
+{
+    while (p < e && *p != ' ' && *p != '\t' && *p != '\r')
+        ++p;
+    return p;
+}
+
+// Pula os separadores entre os elementos de uma face ou de um grupo
+static inline const char *SkipSeparators(const char *p, const char *e)
+{
+    while (p < e && (*p == ' ' || *p == '\t' || *p == '\r'))
+        ++p;
+    return p;
+}
+
+static inline bool IsNewLine(const char *p, const char *e)
+{
+    return p >= e || *p == '\r' || *p == '\n' || *p == '\0';
+}
+
+static std::string ParseString(const char **token, const char *e)
+{
+    const char *p = SkipSpaces(*token, e);
+    const char *end = TokenEnd(p, e);
+    *token = end;
+    return std::string(p, end);
+}
+
+// Equivalente a atoi()
+static int ParseInt(const char *p, const char *e)
+{
+    while (p < e && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\v' || *p == '\f' || *p == '\r'))
+        ++p;
+
+    bool negative = false;
+    if (p < e && (*p == '+' || *p == '-'))
+    {
+        negative = (*p == '-');
+        ++p;
+    }
+
+    long long value = 0;
+    while (p < e && OBJ_IS_DIGIT(*p))
+    {
+        if (value <= INT_MAX)
+            value = 10 * value + (*p - '0');
+        ++p;
+    }
+    if (value > INT_MAX)
+        value = INT_MAX;
+
+    return negative ? -(int)value : (int)value;
+}
+
+static inline float ParseReal(const char **token, const char *e)
+{
+    const char *p = SkipSpaces(*token, e);
+    const char *end = TokenEnd(p, e);
+    float value = 0.0f;
+    ParseFloat(p, end, &value);
+    *token = end;
+    return value;
+}
+
+static inline bool ParseReal(const char **token, const char *e, float *out)
+{
+    const char *p = SkipSpaces(*token, e);
+    const char *end = TokenEnd(p, e);
+    bool ok = ParseFloat(p, end, out);
+    *token = end;
+    return ok;
+}
+
+// Fim de um índice de uma face: primeiro '/', ' ', '\t' ou '\r'
+static inline const char *IndexEnd(const char *p, const char *e)
+{
+    while (p < e && *p != '/' && *p != ' ' && *p != '\t' && *p != '\r')
+        ++p;
+    return p;
+}
+
+// Converte um índice do arquivo (a partir de 1, ou negativo e relativo ao
+// número "n" de elementos lidos até a linha atual) para um índice a partir
+// de 0
+static inline bool FixIndex(int idx, size_t n, int *ret, bool allow_zero, size_t line, std::string *warn)
+{
+    if (idx > 0)
+    {
+        *ret = idx - 1;
+        return true;
+    }
+
+    if (idx == 0)
+    {
+        std::stringstream ss;
+        ss << "A zero value index found (will have a value of -1 for normal and tex indices. Line " << line << ").\n";
+        *warn += ss.str();
+        *ret = -1;
+        return allow_zero;
+    }
+
+    *ret = (int)n + idx;
+    return *ret >= 0;
+}
+
+// Lê um vértice de uma face: "v", "v/vt", "v//vn" ou "v/vt/vn"
+static bool ParseTriple(const char **token, const char *e, size_t v, size_t vn, size_t vt, size_t line,
+                        tinyobj::index_t *ret, std::string *warn)
+{
+    const char *p = *token;
+    ret->vertex_index = -1;
+    ret->normal_index = -1;
+    ret->texcoord_index = -1;
+
+    bool ok = FixIndex(ParseInt(p, e), v, &ret->vertex_index, false, line, warn);
+    p = IndexEnd(p, e);
+
+    if (ok && p < e && *p == '/')
+    {
+        ++p;
+        if (p < e && *p == '/')
+        {
+            ++p;
+            ok = FixIndex(ParseInt(p, e), vn, &ret->normal_index, true, line, warn);
+            p = IndexEnd(p, e);
+        }
+        else
+        {
+            ok = FixIndex(ParseInt(p, e), vt, &ret->texcoord_index, true, line, warn);
+            p = IndexEnd(p, e);
+            if (ok && p < e && *p == '/')
+            {
+                ++p;
+                ok = FixIndex(ParseInt(p, e), vn, &ret->normal_index, true, line, warn);
+                p = IndexEnd(p, e);
+            }
+        }
+    }
+
+    *token = p;
+    return ok;
+}
+
+// Retorna true se a linha [t, e) começa com o comando "cmd" seguido de
+// espaço
+static inline bool IsCommand(const char *t, const char *e, const char *cmd, size_t length)
+{
+    return (size_t)(e - t) > length && memcmp(t, cmd, length) == 0 && OBJ_IS_SPACE(t[length]);
+}
+
+// Divide [data, data + size) em trechos terminados em fim de linha
+static void SplitChunks(const char *data, size_t size, int num_threads, std::vector<ObjChunk> *chunks)
+{
+    size_t num_chunks = (num_threads > 1) ? (size_t)num_threads * OBJ_CHUNKS_PER_THREAD : 1;
+    size_t max_chunks = size / OBJ_CHUNK_MIN_BYTES + 1;
+    if (num_chunks > max_chunks)
+        num_chunks = max_chunks;
+
+    const char *end = data + size;
+    const char *begin = data;
+    for (size_t i = 1; i <= num_chunks && begin < end; ++i)
+    {
+        const char *split = end;
+        if (i < num_chunks)
+        {
+            split = std::max(begin, data + size * i / num_chunks);
+            const char *newline = (const char *)memchr(split, '\n', end - split);
+            split = (newline != NULL) ? newline + 1 : end;
+        }
+
+        chunks->push_back(ObjChunk());
+        chunks->back().begin = begin;
+        chunks->back().end = split;
+        begin = split;
+    }
+}
+
+// Passo 1: conta as linhas e os elementos do trecho
+static void CountChunk(ObjChunk *chunk)
+{
+    size_t num_lines = 0, num_v = 0, num_vn = 0, num_vt = 0;
+    bool unsupported = false;
+
+    for (const char *p = chunk->begin; p < chunk->end;)
+    {
+        const char *line = p;
+        const char *e = NextLine(&p, chunk->end);
+        num_lines += 1;
+
+        // Um '\r' isolado também termina uma linha para tinyobj
+        if (e > line && memchr(line, '\r', e - line) != NULL)
+            unsupported = true;
+
+        const char *t = SkipSpaces(line, e);
+        if (e - t < 2)
+            continue;
+
+        if (t[0] == 'v')
+        {
+            if (OBJ_IS_SPACE(t[1]))
+                num_v += 1;
+            else if (IsCommand(t, e, "vn", 2))
+                num_vn += 1;
+            else if (IsCommand(t, e, "vt", 2))
+                num_vt += 1;
+            else if (IsCommand(t, e, "vw", 2))
+                unsupported = true;
+        }
+        else if ((t[0] == 'l' || t[0] == 'p' || t[0] == 't') && OBJ_IS_SPACE(t[1]))
+        {
+            unsupported = true;
+        }
+    }
+
+    chunk->num_lines = num_lines;
+    chunk->num_v = num_v;
+    chunk->num_vn = num_vn;
+    chunk->num_vt = num_vt;
+    chunk->unsupported = unsupported;
+}
+
+// Passo 2: lê os elementos do trecho. Posições, normais, coordenadas de
+// textura e cores são gravadas diretamente em "attrib", que já tem o
+// tamanho final; faces e comandos ficam no próprio trecho.
+static void ParseChunk(ObjChunk *chunk, tinyobj::attrib_t *attrib, bool triangulate)
+{
+    size_t line = chunk->first_line;
+    size_t v = chunk->first_v;
+    size_t vn = chunk->first_vn;
+    size_t vt = chunk->first_vt;
+
+    for (const char *p = chunk->begin; p < chunk->end && chunk->error.empty() && !chunk->unsupported;)
+    {
+        const char *t = p;
+        const char *e = NextLine(&p, chunk->end);
+        t = SkipSpaces(t, e);
+        line += 1;
+
+        if (t >= e || t[0] == '#')
+            continue;
+
+        // Vértice, com cor opcional
+        if (t[0] == 'v' && e - t >= 2 && OBJ_IS_SPACE(t[1]))
+        {
+            t += 2;
+            float *position = &attrib->vertices[3 * v];
+            position[0] = ParseReal(&t, e);
+            position[1] = ParseReal(&t, e);
+            position[2] = ParseReal(&t, e);
+
+            float *color = &attrib->colors[3 * v];
+            if (!(ParseReal(&t, e, &color[0]) && ParseReal(&t, e, &color[1]) && ParseReal(&t, e, &color[2])))
+                color[0] = color[1] = color[2] = 1.0f;
+
+            v += 1;
+            continue;
+        }
+
+        if (IsCommand(t, e, "vn", 2))
+        {
+            t += 3;
+            float *normal = &attrib->normals[3 * vn];
+            normal[0] = ParseReal(&t, e);
+            normal[1] = ParseReal(&t, e);
+            normal[2] = ParseReal(&t, e);
+            vn += 1;
+            continue;
+        }
+
+        if (IsCommand(t, e, "vt", 2))
+        {
+            t += 3;
+            float *texcoord = &attrib->texcoords[2 * vt];
+            texcoord[0] = ParseReal(&t, e);
+            texcoord[1] = ParseReal(&t, e);
+            vt += 1;
+            continue;
+        }
+
+        ObjEvent event;
+        event.type = -1;
+        event.raw_face = chunk->num_faces;
+        event.face = chunk->num_faces;
+        event.corner = chunk->indices.size();
+        event.line = line;
+        event.smoothing = 0;
+
+        if (t[0] == 'f' && e - t >= 2 && OBJ_IS_SPACE(t[1]))
+        {
+            t = SkipSpaces(t + 2, e);
+
+            std::string warn;
+            size_t first_corner = chunk->indices.size();
+            while (!IsNewLine(t, e))
+            {
+                tinyobj::index_t idx;
+                if (!ParseTriple(&t, e, v, vn, vt, line, &idx, &warn))
+                {
+                    std::stringstream ss;
+                    ss << "Failed to parse `f' line (e.g. a zero value for vertex index or invalid relative vertex index). Line "
+                       << line << ").\n";
+                    chunk->error = ss.str();
+                    break;
+                }
+
+                chunk->greatest_v = std::max(chunk->greatest_v, idx.vertex_index);
+                chunk->greatest_vn = std::max(chunk->greatest_vn, idx.normal_index);
+                chunk->greatest_vt = std::max(chunk->greatest_vt, idx.texcoord_index);
+
+                chunk->indices.push_back(idx);
+                t = SkipSeparators(t, e);
+            }
+
+            if (!warn.empty())
+            {
+                event.type = OBJ_EVENT_WARNING;
+                event.names.push_back(warn);
+                chunk->events.push_back(event);
+            }
+
+            size_t n = chunk->indices.size() - first_corner;
+            if (n < 3 || n > 255 || (triangulate && n > 4))
+                chunk->unsupported = true;
+
+            // tinyobj divide os quadriláteros somente quando exporta as faces
+            // para um objeto, e descarta os que usam vértices ainda não lidos
+            // nesse momento. Referências a vértices posteriores à face são
+            // raras, e ficam com tinyobj.
+            if (triangulate && n == 4)
+            {
+                chunk->has_quads = true;
+                for (size_t i = first_corner; i < first_corner + 4; ++i)
+                {
+                    if ((size_t)chunk->indices[i].vertex_index >= v)
+                        chunk->unsupported = true;
+                }
+            }
+
+            chunk->face_sizes.push_back((unsigned char)n);
+            chunk->num_faces += 1;
+            continue;
+        }
+
+        if (e - t >= 6 && strncmp(t, "usemtl", 6) == 0)
+        {
+            t += 6;
+            event.type = OBJ_EVENT_USEMTL;
+            event.names.push_back(ParseString(&t, e));
+        }
+        else if (IsCommand(t, e, "mtllib", 6))
+        {
+            // Nomes separados por espaços, com '\' para espaços dentro de um
+            // nome (como SplitString() em "tiny_obj_loader.h")
+            event.type = OBJ_EVENT_MTLLIB;
+            std::string name;
+            bool escaping = false;
+            for (const char *c = t + 7; c < e; ++c)
+            {
+                if (escaping)
+                {
+                    escaping = false;
+                }
+                else if (*c == '\\')
+                {
+                    escaping = true;
+                    continue;
+                }
+                else if (*c == ' ')
+                {
+                    if (!name.empty())
+                        event.names.push_back(name);
+                    name.clear();
+                    continue;
+                }
+                name += *c;
+            }
+            event.names.push_back(name);
+        }
+        else if (t[0] == 'g' && e - t >= 2 && OBJ_IS_SPACE(t[1]))
+        {
+            // O primeiro nome é o próprio "g", como em tinyobj
+            event.type = OBJ_EVENT_GROUP;
+            while (!IsNewLine(t, e))
+            {
+                event.names.push_back(ParseString(&t, e));
+                t = SkipSeparators(t, e);
+            }
+        }
+        else if (t[0] == 'o' && e - t >= 2 && OBJ_IS_SPACE(t[1]))
+        {
+            event.type = OBJ_EVENT_OBJECT;
+            event.names.push_back(std::string(t + 2, e));
+        }
+        else if (t[0] == 's' && e - t >= 2 && OBJ_IS_SPACE(t[1]))
+        {
+            t = SkipSpaces(t + 2, e);
+            if (t < e && t[0] != '\r')
+            {
+                event.type = OBJ_EVENT_SMOOTHING;
+                if (e - t >= 3 && t[0] == 'o' && t[1] == 'f' && t[2] == 'f')
+                {
+                    event.smoothing = 0;
+                }
+                else
+                {
+                    int id = ParseInt(t, e);
+                    event.smoothing = (id < 0) ? 0 : (unsigned int)id;
+                }
+            }
+        }
+
+        // Outros comandos são ignorados, como em tinyobj
+        if (event.type >= 0)
+            chunk->events.push_back(event);
+    }
+}
+
+// Passo 3: divide os quadriláteros do trecho em dois triângulos pela menor
+// diagonal, como em tinyobj, e atualiza a posição dos comandos. Feito depois
+// do passo 2 porque os vértices podem estar em outros trechos.
+static void TriangulateChunk(ObjChunk *chunk, const std::vector<float> &v)
+{
+    if (!chunk->has_quads)
+        return;
+
+    std::vector<tinyobj::index_t> indices;
+    std::vector<unsigned char> face_sizes;
+    indices.reserve(chunk->indices.size() + chunk->indices.size() / 2);
+    face_sizes.reserve(2 * chunk->face_sizes.size());
+
+    size_t next_event = 0;
+    size_t corner = 0;
+    for (size_t face = 0; face <= chunk->face_sizes.size(); ++face)
+    {
+        while (next_event < chunk->events.size() && chunk->events[next_event].raw_face == face)
+        {
+            chunk->events[next_event].face = face_sizes.size();
+            chunk->events[next_event].corner = indices.size();
+            next_event += 1;
+        }
+        if (face == chunk->face_sizes.size())
+            break;
+
+        size_t n = chunk->face_sizes[face];
+        const tinyobj::index_t *idx = &chunk->indices[corner];
+        corner += n;
+
+        if (n != 4)
+        {
+            indices.insert(indices.end(), idx, idx + n);
+            face_sizes.push_back((unsigned char)n);
+            continue;
+        }
+
+        // Os índices já foram verificados por ParseChunk()
+        const float *v0 = &v[3 * idx[0].vertex_index];
+        const float *v1 = &v[3 * idx[1].vertex_index];
+        const float *v2 = &v[3 * idx[2].vertex_index];
+        const float *v3 = &v[3 * idx[3].vertex_index];
+
+        float e02x = v2[0] - v0[0];
+        float e02y = v2[1] - v0[1];
+        float e02z = v2[2] - v0[2];
+        float e13x = v3[0] - v1[0];
+        float e13y = v3[1] - v1[1];
+        float e13z = v3[2] - v1[2];
+        float sqr02 = e02x * e02x + e02y * e02y + e02z * e02z;
+        float sqr13 = e13x * e13x + e13y * e13y + e13z * e13z;
+
+        if (sqr02 < sqr13)
+        {
+            const tinyobj::index_t triangles[6] = {idx[0], idx[1], idx[2], idx[0], idx[2], idx[3]};
+            indices.insert(indices.end(), triangles, triangles + 6);
+        }
+        else
+        {
+            const tinyobj::index_t triangles[6] = {idx[0], idx[1], idx[3], idx[1], idx[2], idx[3]};
+            indices.insert(indices.end(), triangles, triangles + 6);
+        }
+        face_sizes.push_back(3);
+        face_sizes.push_back(3);
+    }
+
+    chunk->indices.swap(indices);
+    chunk->face_sizes.swap(face_sizes);
+}
+
+// Faces de um trecho ainda não adicionadas a um objeto ("prim_group" em
+// tinyobj::LoadObj())
+struct ObjFaceRange
+{
+    const ObjChunk *chunk;
+    size_t face_begin, face_end;
+    size_t corner_begin, corner_end;
+    unsigned int smoothing;
+};
+
+// Estado da leitura, ao repetir os comandos de todos os trechos
+struct ObjMergeState
+{
+    tinyobj::shape_t shape;
+    std::vector<ObjFaceRange> pending;
+    std::string name;
+    int material = -1;
+    unsigned int smoothing = 0;
+    std::map<std::string, int> material_map;
+    std::set<std::string> material_filenames;
+};
+
+// Adiciona as faces pendentes ao objeto atual, como exportGroupsToShape()
+static bool ExportFaces(ObjMergeState *state)
+{
+    if (state->pending.empty())
+        return false;
+
+    state->shape.name = state->name;
+    tinyobj::mesh_t &mesh = state->shape.mesh;
+    for (size_t r = 0; r < state->pending.size(); ++r)
+    {
+        const ObjFaceRange &range = state->pending[r];
+        const ObjChunk *chunk = range.chunk;
+        size_t num_faces = range.face_end - range.face_begin;
+        mesh.indices.insert(mesh.indices.end(), chunk->indices.begin() + range.corner_begin,
+                            chunk->indices.begin() + range.corner_end);
+        mesh.num_face_vertices.insert(mesh.num_face_vertices.end(), chunk->face_sizes.begin() + range.face_begin,
+                                      chunk->face_sizes.begin() + range.face_end);
+        mesh.material_ids.insert(mesh.material_ids.end(), num_faces, state->material);
+        mesh.smoothing_group_ids.insert(mesh.smoothing_group_ids.end(), num_faces, range.smoothing);
+    }
+    state->pending.clear();
+    return true;
+}
+
+// Termina o objeto atual (comandos "g" e "o")
+static void FinishShape(ObjMergeState *state, std::vector<tinyobj::shape_t> *shapes)
+{
+    ExportFaces(state);
+    if (!state->shape.mesh.indices.empty())
+        shapes->push_back(state->shape);
+    state->shape = tinyobj::shape_t();
+}
+
+static void ApplyEvent(ObjMergeState *state, const ObjEvent &event, std::vector<tinyobj::shape_t> *shapes,
+                       std::vector<tinyobj::material_t> *materials, std::string *warn, std::string *err,
+                       tinyobj::MaterialReader *material_reader)
+{
+    switch (event.type)
+    {
+    case OBJ_EVENT_USEMTL:
+    {
+        int material = -1;
+        std::map<std::string, int>::const_iterator it = state->material_map.find(event.names[0]);
+        if (it != state->material_map.end())
+            material = it->second;
+        else if (warn)
+            *warn += "material [ '" + event.names[0] + "' ] not found in .mtl\n";
+
+        // Faces com materiais diferentes podem estar no mesmo objeto
+        if (material != state->material)
+        {
+            ExportFaces(state);
+            state->material = material;
+        }
+        break;
+    }
+
+    case OBJ_EVENT_MTLLIB:
+    {
+        bool found = false;
+        for (size_t i = 0; i < event.names.size(); ++i)
+        {
+            if (state->material_filenames.count(event.names[i]) > 0)
+            {
+                found = true;
+                continue;
+            }
+
+            std::string warn_mtl, err_mtl;
+            bool ok = (*material_reader)(event.names[i], materials, &state->material_map, &warn_mtl, &err_mtl);
+            if (warn)
+                *warn += warn_mtl;
+            if (err)
+                *err += err_mtl;
+
+            if (ok)
+            {
+                found = true;
+                state->material_filenames.insert(event.names[i]);
+                break;
+            }
+        }
+
+        if (!found && warn)
+            *warn += "Failed to load material file(s). Use default material.\n";
+        break;
+    }
+
+    case OBJ_EVENT_GROUP:
+        FinishShape(state, shapes);
+        if (event.names.size() < 2)
+        {
+            if (warn)
+            {
+                std::stringstream ss;
+                ss << "Empty group name. line: " << event.line << "\n";
+                *warn += ss.str();
+                state->name = "";
+            }
+        }
+        else
+        {
+            // Vários nomes são concatenados com espaços
+            state->name = event.names[1];
+            for (size_t i = 2; i < event.names.size(); ++i)
+                state->name += " " + event.names[i];
+        }
+        break;
+
+    case OBJ_EVENT_OBJECT:
+        FinishShape(state, shapes);
+        state->name = event.names[0];
+        break;
+
+    case OBJ_EVENT_SMOOTHING:
+        state->smoothing = event.smoothing;
+        break;
+
+    case OBJ_EVENT_WARNING:
+        if (warn)
+            *warn += event.names[0];
+        break;
+    }
+}
+
+// Reúne, em ordem, as faces de todos os trechos em objetos, repetindo os
+// comandos de cada trecho
+static void MergeChunks(const std::vector<ObjChunk> &chunks, const tinyobj::attrib_t &attrib, size_t num_lines,
+                        std::vector<tinyobj::shape_t> *shapes, std::vector<tinyobj::material_t> *materials,
+                        std::string *warn, std::string *err, tinyobj::MaterialReader *material_reader)
+{
+    ObjMergeState state;
+    int greatest_v = -1, greatest_vn = -1, greatest_vt = -1;
+
+    for (size_t c = 0; c < chunks.size(); ++c)
+    {
+        const ObjChunk &chunk = chunks[c];
+
+        greatest_v = std::max(greatest_v, chunk.greatest_v);
+        greatest_vn = std::max(greatest_vn, chunk.greatest_vn);
+        greatest_vt = std::max(greatest_vt, chunk.greatest_vt);
+
+        // Faces entre dois comandos consecutivos
+        size_t raw_face = 0, face = 0, corner = 0;
+        for (size_t i = 0; i <= chunk.events.size(); ++i)
+        {
+            const ObjEvent *event = (i < chunk.events.size()) ? &chunk.events[i] : NULL;
+            size_t raw_end = event ? event->raw_face : chunk.num_faces;
+            size_t face_end = event ? event->face : chunk.face_sizes.size();
+            size_t corner_end = event ? event->corner : chunk.indices.size();
+
+            if (raw_end > raw_face)
+            {
+                ObjFaceRange range = {&chunk, face, face_end, corner, corner_end, state.smoothing};
+                state.pending.push_back(range);
+            }
+            raw_face = raw_end;
+            face = face_end;
+            corner = corner_end;
+
+            if (event)
+                ApplyEvent(&state, *event, shapes, materials, warn, err, material_reader);
+        }
+    }
+
+    if (warn)
+    {
+        std::stringstream ss;
+        if (greatest_v >= (int)(attrib.vertices.size() / 3))
+            ss << "Vertex indices out of bounds (line " << num_lines << ".)\n\n";
+        if (greatest_vn >= (int)(attrib.normals.size() / 3))
+            ss << "Vertex normal indices out of bounds (line " << num_lines << ".)\n\n";
+        if (greatest_vt >= (int)(attrib.texcoords.size() / 2))
+            ss << "Vertex texcoord indices out of bounds (line " << num_lines << ".)\n\n";
+        *warn += ss.str();
+    }
+
+    if (ExportFaces(&state) || !state.shape.mesh.indices.empty())
+        shapes->push_back(state.shape);
+}
+
+bool ObjLoader_Load(tinyobj::attrib_t *attrib, std::vector<tinyobj::shape_t> *shapes,
+                    std::vector<tinyobj::material_t> *materials, std::string *warn, std::string *err,
+                    const char *filename, const char *basepath, bool triangulate, int num_threads)
+{
+    size_t size = 0;
+    const char *data = (const char *)MeshCache_MapFile(filename, &size);
+    if (data == NULL)
+        return tinyobj::LoadObj(attrib, shapes, materials, warn, err, filename, basepath, triangulate);
+
+    if (num_threads <= 0)
+    {
+        num_threads = (int)std::thread::hardware_concurrency();
+        int useful = (int)(size / OBJ_BYTES_PER_THREAD) + 1;
+        if (num_threads > useful)
+            num_threads = useful;
+    }
+    if (num_threads < 1)
+        num_threads = 1;
+
+    std::vector<ObjChunk> chunks;
+    SplitChunks(data, size, num_threads, &chunks);
+
+    // Passo 1, e posição de cada trecho no arquivo
+    ParallelFor(chunks.size(), num_threads, [&](size_t i) { CountChunk(&chunks[i]); });
+
+    size_t num_lines = 0, num_v = 0, num_vn = 0, num_vt = 0;
+    bool unsupported = false;
+    for (size_t c = 0; c < chunks.size(); ++c)
+    {
+        ObjChunk &chunk = chunks[c];
+        chunk.first_line = num_lines;
+        chunk.first_v = num_v;
+        chunk.first_vn = num_vn;
+        chunk.first_vt = num_vt;
+        num_lines += chunk.num_lines;
+        num_v += chunk.num_v;
+        num_vn += chunk.num_vn;
+        num_vt += chunk.num_vt;
+        unsupported = unsupported || chunk.unsupported;
+    }
+
+    if (unsupported)
+    {
+        MeshCache_UnmapFile((void *)data, size);
+        return tinyobj::LoadObj(attrib, shapes, materials, warn, err, filename, basepath, triangulate);
+    }
+
+    // Como em tinyobj, todos os vértices têm cor (branca, se não informada)
+    attrib->vertices.assign(3 * num_v, 0.0f);
+    attrib->colors.assign(3 * num_v, 0.0f);
+    attrib->normals.assign(3 * num_vn, 0.0f);
+    attrib->texcoords.assign(2 * num_vt, 0.0f);
+    attrib->vertex_weights.clear();
+    attrib->texcoord_ws.clear();
+    attrib->skin_weights.clear();
+    shapes->clear();
+
+    // Passo 2
+    ParallelFor(chunks.size(), num_threads, [&](size_t i) { ParseChunk(&chunks[i], attrib, triangulate); });
+    MeshCache_UnmapFile((void *)data, size);
+
+    // O primeiro erro ou elemento não tratado, na ordem do arquivo, decide
+    // o resultado
+    for (size_t c = 0; c < chunks.size(); ++c)
+    {
+        if (chunks[c].unsupported)
+            return tinyobj::LoadObj(attrib, shapes, materials, warn, err, filename, basepath, triangulate);
+
+        if (!chunks[c].error.empty())
+        {
+            for (size_t i = 0; i <= c && warn; ++i)
+            {
+                for (size_t j = 0; j < chunks[i].events.size(); ++j)
+                    if (chunks[i].events[j].type == OBJ_EVENT_WARNING)
+                        *warn += chunks[i].events[j].names[0];
+            }
+            if (err)
+                *err += chunks[c].error;
+
+            attrib->vertices.clear();
+            attrib->colors.clear();
+            attrib->normals.clear();
+            attrib->texcoords.clear();
+            return false;
+        }
+    }
+
+    // Passo 3
+    if (triangulate)
+        ParallelFor(chunks.size(), num_threads, [&](size_t i) { TriangulateChunk(&chunks[i], attrib->vertices); });
+
+    std::string base_dir = (basepath != NULL) ? basepath : "";
+#ifdef _WIN32
+    if (!base_dir.empty() && base_dir[base_dir.size() - 1] != '\\')
+        base_dir += '\\';
+#else
+    if (!base_dir.empty() && base_dir[base_dir.size() - 1] != '/')
+        base_dir += '/';
+#endif
+    tinyobj::MaterialFileReader material_reader(base_dir);
+
+    MergeChunks(chunks, *attrib, num_lines, shapes, materials, warn, err, &material_reader);
+    return true;
+}
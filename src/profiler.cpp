@@ -0,0 +1,267 @@
+#include "profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+typedef std::chrono::steady_clock ProfilerClock;
+
+static const char *g_ProfilerStageNames[PROFILER_NUM_STAGES] = {
+    "entrada", "simulação", "colisão", "cena", "texto", "apresentação",
+};
+
+static const char *g_ProfilerGpuPassNames[PROFILER_GPU_NUM_PASSES] = {
+    "gpu mundo", "gpu nave", "gpu céu", "gpu HUD",
+};
+
+// Origem dos tempos do arquivo de trace
+static ProfilerClock::time_point g_ProfilerEpoch = ProfilerClock::now();
+
+// Quadro atual: início do quadro e de cada estágio, e o tempo acumulado de
+// cada estágio, em segundos
+static bool g_FrameStarted = false;
+static ProfilerClock::time_point g_FrameStart;
+static ProfilerClock::time_point g_StageStart[PROFILER_NUM_STAGES];
+static double g_StageSeconds[PROFILER_NUM_STAGES];
+
+// Tempos, em milissegundos, dos últimos PROFILER_HISTORY quadros, em um
+// buffer circular
+static double g_StageHistory[PROFILER_NUM_STAGES][PROFILER_HISTORY];
+static double g_FrameHistory[PROFILER_HISTORY];
+static int g_HistorySize = 0; // Quadros válidos no histórico
+static int g_HistoryNext = 0; // Próxima posição a ser escrita
+
+// Tempos de GPU de cada passe, e a sua soma na última posição, em outro
+// buffer circular: os resultados chegam com atraso e podem ser descartados
+// (veja GpuTimer_BeginFrame()), então não seguem o histórico da CPU
+static double g_GpuHistory[PROFILER_GPU_NUM_PASSES + 1][PROFILER_HISTORY];
+static int g_GpuHistorySize = 0;
+static int g_GpuHistoryNext = 0;
+
+// Um trecho medido durante a captura. "stage" igual a PROFILER_NUM_STAGES
+// representa o quadro inteiro; "gpu" indica um passe de GPU, com o seu
+// número em "stage".
+struct ProfilerEvent
+{
+    int stage;
+    bool gpu;
+    double start_us;    // Em microssegundos desde g_ProfilerEpoch
+    double duration_us;
+};
+
+// Captura do trace: pedida por Profiler_CaptureTrace(), começa no próximo
+// quadro e dura g_TraceFramesLeft quadros
+static std::vector<ProfilerEvent> g_TraceEvents;
+static std::string g_TraceFilename;
+static int g_TraceFrames = 0;
+static int g_TraceFramesLeft = 0;
+static bool g_TracePending = false;
+static double g_TraceStart = 0.0;  // Início da captura, em microssegundos
+static double g_TraceGpuEnd = 0.0; // Fim do último evento de GPU gravado
+
+static double Microseconds(ProfilerClock::time_point t)
+{
+    return std::chrono::duration<double, std::micro>(t - g_ProfilerEpoch).count();
+}
+
+const char *Profiler_StageName(int stage)
+{
+    return (stage >= 0 && stage < PROFILER_NUM_STAGES) ? g_ProfilerStageNames[stage] : "quadro";
+}
+
+const char *Profiler_GpuPassName(int pass)
+{
+    return (pass >= 0 && pass < PROFILER_GPU_NUM_PASSES) ? g_ProfilerGpuPassNames[pass] : "gpu total";
+}
+
+double Profiler_Time()
+{
+    return Microseconds(ProfilerClock::now());
+}
+
+// Grava os eventos capturados. Eventos do tipo "X" (duração completa) na
+// mesma thread são aninhados pelo visualizador conforme os seus tempos. Os
+// passes de GPU ficam em uma segunda linha ("tid" 2).
+static void WriteTrace()
+{
+    FILE *f = fopen(g_TraceFilename.c_str(), "w");
+    if (f == NULL)
+    {
+        fprintf(stderr, "ERROR: Cannot write trace file \"%s\".\n", g_TraceFilename.c_str());
+        return;
+    }
+
+    fprintf(f, "{\"traceEvents\":[\n");
+    fprintf(f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}},\n");
+    fprintf(f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}%s\n",
+            g_TraceEvents.empty() ? "" : ",");
+    for (size_t i = 0; i < g_TraceEvents.size(); ++i)
+    {
+        const ProfilerEvent &event = g_TraceEvents[i];
+        const char *name = event.gpu ? Profiler_GpuPassName(event.stage) : Profiler_StageName(event.stage);
+        const char *category = event.gpu ? "gpu" : (event.stage == PROFILER_NUM_STAGES ? "frame" : "cpu");
+        fprintf(f, "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d}%s\n",
+                name, category, event.start_us, event.duration_us, event.gpu ? 2 : 1,
+                i + 1 < g_TraceEvents.size() ? "," : "");
+    }
+    fprintf(f, "],\"displayTimeUnit\":\"ms\"}\n");
+    fclose(f);
+
+    printf("Trace de %d quadros gravado em \"%s\".\n", g_TraceFrames, g_TraceFilename.c_str());
+}
+
+void Profiler_BeginFrame()
+{
+    ProfilerClock::time_point now = ProfilerClock::now();
+
+    if (g_FrameStarted)
+    {
+        for (int stage = 0; stage < PROFILER_NUM_STAGES; ++stage)
+            g_StageHistory[stage][g_HistoryNext] = 1e3 * g_StageSeconds[stage];
+        g_FrameHistory[g_HistoryNext] = std::chrono::duration<double, std::milli>(now - g_FrameStart).count();
+        g_HistoryNext = (g_HistoryNext + 1) % PROFILER_HISTORY;
+        g_HistorySize = std::min(g_HistorySize + 1, PROFILER_HISTORY);
+
+        if (g_TraceFramesLeft > 0)
+        {
+            ProfilerEvent event;
+            event.stage = PROFILER_NUM_STAGES;
+            event.gpu = false;
+            event.start_us = Microseconds(g_FrameStart);
+            event.duration_us = Microseconds(now) - event.start_us;
+            g_TraceEvents.push_back(event);
+
+            if (--g_TraceFramesLeft == 0)
+            {
+                WriteTrace();
+                std::vector<ProfilerEvent>().swap(g_TraceEvents);
+            }
+        }
+    }
+
+    if (g_TracePending)
+    {
+        g_TraceFramesLeft = g_TraceFrames;
+        g_TracePending = false;
+        g_TraceStart = Microseconds(now);
+        g_TraceGpuEnd = g_TraceStart;
+    }
+
+    for (int stage = 0; stage < PROFILER_NUM_STAGES; ++stage)
+        g_StageSeconds[stage] = 0.0;
+    g_FrameStart = now;
+    g_FrameStarted = true;
+}
+
+void Profiler_Begin(int stage)
+{
+    g_StageStart[stage] = ProfilerClock::now();
+}
+
+void Profiler_End(int stage)
+{
+    ProfilerClock::time_point now = ProfilerClock::now();
+    g_StageSeconds[stage] += std::chrono::duration<double>(now - g_StageStart[stage]).count();
+
+    if (g_TraceFramesLeft > 0)
+    {
+        ProfilerEvent event;
+        event.stage = stage;
+        event.gpu = false;
+        event.start_us = Microseconds(g_StageStart[stage]);
+        event.duration_us = Microseconds(now) - event.start_us;
+        g_TraceEvents.push_back(event);
+    }
+}
+
+// Média, percentil 99 e último valor de um histórico circular com "size"
+// valores, cuja próxima posição a ser escrita é "next"
+static bool ComputeStats(const double *history, int size, int next, ProfilerStats *stats)
+{
+    if (size == 0)
+        return false;
+
+    std::vector<double> values(history, history + size);
+    double sum = 0.0;
+    for (size_t i = 0; i < values.size(); ++i)
+        sum += values[i];
+
+    // Menor valor que é maior ou igual a 99% dos valores
+    size_t p99 = (size_t)std::ceil(0.99 * values.size()) - 1;
+    std::nth_element(values.begin(), values.begin() + p99, values.end());
+
+    stats->average = sum / size;
+    stats->p99 = values[p99];
+    stats->last = history[(next + PROFILER_HISTORY - 1) % PROFILER_HISTORY];
+    return true;
+}
+
+bool Profiler_StageStats(int stage, ProfilerStats *stats)
+{
+    return ComputeStats(g_StageHistory[stage], g_HistorySize, g_HistoryNext, stats);
+}
+
+bool Profiler_FrameStats(ProfilerStats *stats)
+{
+    return ComputeStats(g_FrameHistory, g_HistorySize, g_HistoryNext, stats);
+}
+
+// O arquivo de trace precisa de instantes de início, mas GL_TIME_ELAPSED só
+// mede durações. Cada passe é posicionado no instante do seu envio ou, se a
+// GPU ainda estava ocupada com o passe anterior, logo após ele.
+void Profiler_GpuFrame(const double *pass_ms, const double *submit_us)
+{
+    double total = 0.0;
+    for (int pass = 0; pass < PROFILER_GPU_NUM_PASSES; ++pass)
+    {
+        g_GpuHistory[pass][g_GpuHistoryNext] = pass_ms[pass];
+        total += pass_ms[pass];
+
+        if (g_TraceFramesLeft > 0 && pass_ms[pass] > 0.0 && submit_us[pass] >= g_TraceStart)
+        {
+            ProfilerEvent event;
+            event.stage = pass;
+            event.gpu = true;
+            event.start_us = std::max(submit_us[pass], g_TraceGpuEnd);
+            event.duration_us = 1e3 * pass_ms[pass];
+            g_TraceEvents.push_back(event);
+            g_TraceGpuEnd = event.start_us + event.duration_us;
+        }
+    }
+    g_GpuHistory[PROFILER_GPU_NUM_PASSES][g_GpuHistoryNext] = total;
+
+    g_GpuHistoryNext = (g_GpuHistoryNext + 1) % PROFILER_HISTORY;
+    g_GpuHistorySize = std::min(g_GpuHistorySize + 1, PROFILER_HISTORY);
+}
+
+bool Profiler_GpuPassStats(int pass, ProfilerStats *stats)
+{
+    return ComputeStats(g_GpuHistory[pass], g_GpuHistorySize, g_GpuHistoryNext, stats);
+}
+
+void Profiler_ClearHistory()
+{
+    g_HistorySize = 0;
+    g_HistoryNext = 0;
+    g_GpuHistorySize = 0;
+    g_GpuHistoryNext = 0;
+}
+
+void Profiler_CaptureTrace(const char *filename, int num_frames)
+{
+    if (Profiler_Capturing() || num_frames <= 0)
+        return;
+
+    g_TraceFilename = filename;
+    g_TraceFrames = num_frames;
+    g_TracePending = true;
+    g_TraceEvents.reserve((size_t)num_frames * 20);
+}
+
+bool Profiler_Capturing()
+{
+    return g_TracePending || g_TraceFramesLeft > 0;
+}
@@ -0,0 +1,122 @@
+#include "programcache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "cachefile.h"
+
+// Cabeçalho de um arquivo de cache de programa. Logo após o cabeçalho vêm
+// os "binary_length" bytes devolvidos por glGetProgramBinary().
+struct ProgramCacheHeader
+{
+    char magic[4];          // "SEPC"
+    uint32_t version;       // PROGRAM_CACHE_VERSION
+    uint64_t key;           // Veja ProgramCache_Key()
+    uint32_t binary_format; // Formato devolvido por glGetProgramBinary()
+    uint32_t binary_length;
+};
+
+static const char PROGRAM_CACHE_MAGIC[4] = {'S', 'E', 'P', 'C'};
+
+// Acumula uma string no hash, incluindo o '\0', para que "ab" + "c" e
+// "a" + "bc" tenham hashes diferentes
+static uint64_t HashString(uint64_t h, const char *str)
+{
+    if (str == NULL)
+        str = "";
+    return CacheFile_HashBytes(h, str, strlen(str) + 1);
+}
+
+bool ProgramCache_Supported()
+{
+    if (!GLAD_GL_ARB_get_program_binary || glGetProgramBinary == NULL || glProgramBinary == NULL)
+        return false;
+
+    GLint num_formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &num_formats);
+    return num_formats > 0;
+}
+
+uint64_t ProgramCache_Key(const std::string &vertex_source, const std::string &fragment_source)
+{
+    uint64_t h = CACHE_FILE_HASH_SEED;
+    h = HashString(h, vertex_source.c_str());
+    h = HashString(h, fragment_source.c_str());
+    h = HashString(h, (const char *)glGetString(GL_VENDOR));
+    h = HashString(h, (const char *)glGetString(GL_RENDERER));
+    h = HashString(h, (const char *)glGetString(GL_VERSION));
+    return h;
+}
+
+GLuint ProgramCache_Load(const char *filename, uint64_t key)
+{
+    if (!ProgramCache_Supported())
+        return 0;
+
+    FILE *f = fopen(filename, "rb");
+    if (f == NULL)
+        return 0;
+
+    ProgramCacheHeader header;
+    std::vector<unsigned char> binary;
+    bool ok = fread(&header, sizeof(header), 1, f) == 1 &&
+              memcmp(header.magic, PROGRAM_CACHE_MAGIC, 4) == 0 &&
+              header.version == PROGRAM_CACHE_VERSION &&
+              header.key == key &&
+              header.binary_length > 0;
+    if (ok)
+    {
+        binary.resize(header.binary_length);
+        ok = fread(binary.data(), 1, binary.size(), f) == binary.size();
+    }
+    fclose(f);
+
+    if (!ok)
+        return 0;
+
+    // O driver pode recusar o binário mesmo com a chave correta (ex: após uma
+    // atualização que não mudou GL_VERSION); nesse caso o programa é
+    // compilado novamente pelo chamador.
+    GLuint program_id = glCreateProgram();
+    glProgramBinary(program_id, header.binary_format, binary.data(), (GLsizei)binary.size());
+
+    GLint linked_ok = GL_FALSE;
+    glGetProgramiv(program_id, GL_LINK_STATUS, &linked_ok);
+    if (linked_ok == GL_FALSE)
+    {
+        glDeleteProgram(program_id);
+        return 0;
+    }
+
+    return program_id;
+}
+
+bool ProgramCache_Store(const char *filename, uint64_t key, GLuint program_id)
+{
+    if (!ProgramCache_Supported())
+        return false;
+
+    GLint length = 0;
+    glGetProgramiv(program_id, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return false;
+
+    std::vector<unsigned char> binary(length);
+    GLenum binary_format = 0;
+    GLsizei written = 0;
+    glGetProgramBinary(program_id, length, &written, &binary_format, binary.data());
+    if (written <= 0)
+        return false;
+
+    ProgramCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, PROGRAM_CACHE_MAGIC, 4);
+    header.version = PROGRAM_CACHE_VERSION;
+    header.key = key;
+    header.binary_format = binary_format;
+    header.binary_length = (uint32_t)written;
+
+    CacheFileChunk chunk = {binary.data(), (size_t)written};
+    return CacheFile_Write(filename, &header, sizeof(header), &chunk, 1);
+}
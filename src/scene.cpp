@@ -0,0 +1,1440 @@
+#include "scene.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstddef>
+#include <unordered_map>
+#include <limits>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+// Headers da biblioteca GLM: criação de matrizes e vetores.
+#include <glm/vec4.hpp>
+#include <glm/matrix.hpp>
+#include <glm/geometric.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/gtc/packing.hpp>
+
+// Headers locais, definidos na pasta "include/"
+#include "utils.h"
+#include "matrices.h"
+#include "programcache.h"
+#include "assetmanager.h"
+#include "gputimer.h"
+
+// Abaixo definimos variáveis globais utilizadas em várias funções do código.
+
+// A cena virtual é uma lista contígua de objetos, indexada pelo identificador
+// inteiro retornado por AddMeshToVirtualScene(). Os nomes dos objetos são
+// buscados somente uma vez, durante a inicialização, através de
+// FindVirtualObject(); durante a renderização os objetos são acessados
+// diretamente pelo seu identificador. Veja dentro da função
+// AddMeshToVirtualScene() como que são incluídos objetos dentro da variável
+// g_VirtualScene, e veja na função Scene_Draw() como estes são acessados.
+std::vector<SceneObject> g_VirtualScene;
+std::map<std::string, int> g_VirtualSceneIds; // Nome -> identificador
+
+// Identificadores dos objetos desenhados pelo jogo. Veja Scene_Init().
+int g_SpaceshipObject = -1;
+int g_SphereObject = -1;
+int g_MoonObject = -1;
+int g_AsteroidObject = -1;
+int g_CoinObject = -1;
+
+// Contadores de desempenho de DrawVirtualObject(), impressos periodicamente
+// no terminal pelo loop de renderização.
+unsigned long g_DrawCalls = 0;
+unsigned long g_DrawTriangles = 0;
+double g_DrawCpuSeconds = 0.0;
+
+// Variáveis que definem os programas de GPU (shaders), um para cada
+// material. Veja função CreateGpuPrograms().
+GLuint g_GpuProgramIDs[SCENE_NUM_MATERIALS];
+
+// Os dados dos shaders ficam em dois blocos de uniformes (layout std140),
+// cujas estruturas abaixo devem ter exatamente o mesmo layout das
+// declarações em "shader_vertex.glsl" e "shader_fragment.glsl".
+#define FRAME_UNIFORMS_BINDING 0
+#define OBJECT_UNIFORMS_BINDING 1
+
+// Dados constantes durante o quadro, enviados uma vez por Scene_Draw()
+struct FrameUniforms
+{
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::mat4 view_inverse;
+    glm::vec4 camera_position;
+    glm::vec4 light_position;  // Luz pontual do sombreamento de Gouraud
+    glm::vec4 light_direction; // Luz direcional do sombreamento por fragmento
+};
+
+// Dados de cada objeto desenhado
+struct ObjectUniforms
+{
+    glm::mat4 model;
+    glm::mat4 normal_matrix; // Transforma as normais: inversa da transposta de "model"
+    glm::vec4 bbox_min;      // Axis-Aligned Bounding Box do modelo
+    glm::vec4 bbox_max;
+    GLint instanced;         // Matrizes por instância (veja LoadAsteroids())
+    GLint padding[3];
+};
+
+GLuint g_FrameUniformBuffer = 0;
+GLuint g_ObjectUniformBuffer = 0;
+
+// Os dados dos objetos de vários quadros seguidos são escritos em sequência
+// no mesmo buffer, cada um alinhado a GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT; o
+// buffer só é realocado ("orphaning") quando enche, como o VBO de texto em
+// "textrendering.cpp". Cada desenho apenas seleciona o seu trecho com
+// glBindBufferRange().
+#define OBJECT_UNIFORMS_SLOTS 1024
+GLsizeiptr g_ObjectUniformStride = 0;
+size_t g_ObjectUniformSlot = 0; // Próximo trecho livre do buffer
+
+// Objetos a desenhar no quadro atual, adicionados por QueueVirtualObject(),
+// com os seus dados para o bloco "ObjectUniforms"
+struct SceneDraw
+{
+    int object_id;
+    int material;
+    GLsizei num_instances;
+    GLenum cull_face;
+    ObjectUniforms uniforms;
+};
+std::vector<SceneDraw> g_SceneDraws;
+
+// Número de unidades de textura já ocupadas (veja CreateAssetTextures())
+GLuint g_NumLoadedTextures = 0;
+
+// Unidades de textura lidas por "shader_fragment.glsl" (TextureImage0 a
+// TextureImage5)
+#define SCENE_NUM_TEXTURE_UNITS 6
+
+// Recursos do jogo (modelos, texturas e shaders), listados no manifesto
+// ASSET_MANIFEST e lidos em paralelo pelo gerenciador (veja
+// "assetmanager.h"). Scene_Init() espera somente os essenciais; os demais
+// são enviados para a GPU por UploadLoadedAssets(), um pouco a cada quadro.
+// Até lá, os seus objetos não são desenhados e as suas texturas contêm um
+// único pixel cinza.
+AssetManager g_Assets;
+bool g_AssetsPending = false;     // Ainda há recursos a enviar para a GPU
+GLuint g_TextureUploadBuffer = 0; // Pixel Buffer Object utilizado no envio das texturas
+size_t g_TextureBytes = 0;        // Tamanho dos níveis de mipmap enviados, em bytes
+
+static void CreateAssetTextures();
+static void UploadAsset(Asset *asset);
+
+// Encerra o programa após um erro. Antes esperamos as threads do
+// gerenciador de recursos: uma std::thread ainda em execução na destruição
+// de g_Assets chamaria std::terminate(), e uma delas pode estar gravando um
+// arquivo ".mesh" ou ".tex".
+static void ExitWithError()
+{
+    AssetManager_Finish(&g_Assets);
+    std::exit(EXIT_FAILURE);
+}
+
+// Código dos shaders de vértices e de fragmentos, lido pelo gerenciador de
+// recursos ("vertex" e "fragment" no manifesto) ou, ao recarregar os
+// shaders, por LoadShadersFromFiles()
+struct SceneShader
+{
+    std::string filename;
+    std::string source;
+    bool loaded;
+};
+SceneShader g_VertexShader;
+SceneShader g_FragmentShader;
+
+// Objetos desenhados pelo jogo e os modelos do manifesto que os contêm. Os
+// identificadores são preenchidos por OnModelReady() quando o modelo é
+// enviado para a GPU; até lá valem -1, e QueueVirtualObject() ignora o
+// objeto.
+struct SceneModelObject
+{
+    const char *asset;  // Nome do modelo no manifesto
+    const char *object; // Nome do objeto dentro do arquivo OBJ
+    int *object_id;
+};
+static SceneModelObject g_SceneModelObjects[] = {
+    {"spaceship", "Cube", &g_SpaceshipObject},
+    {"sphere", "the_sphere", &g_SphereObject},
+    {"moon", "moon", &g_MoonObject},
+    {"asteroid", "Asteroid", &g_AsteroidObject},
+    {"coin", "Coin", &g_CoinObject},
+};
+
+// Campo de asteroides, desenhado com uma única chamada instanciada. Veja
+// LoadAsteroids() e DrawAsteroidField().
+std::vector<glm::mat4> g_AsteroidInstances; // Matriz de modelagem de cada asteroide
+GLuint g_AsteroidInstanceBuffer = 0;        // VBO com as matrizes acima
+
+// Materiais dos objetos: valores de "MATERIAL" nos shaders, que definem qual
+// variante do programa de GPU é utilizada. Veja CreateGpuPrograms().
+#define ASTEROID 0
+#define SPACESHIP 1
+#define SPHERE 2
+#define COIN 3
+#define MOON 4
+
+// Callback dos modelos de g_SceneModelObjects: busca o objeto desenhado
+// pelo jogo, uma única vez; no loop de renderização ele é acessado
+// diretamente pelo identificador.
+static void OnModelReady(Asset *asset, void *user)
+{
+    SceneModelObject *model = (SceneModelObject *)user;
+    *model->object_id = FindVirtualObject(model->object);
+}
+
+// Callback dos shaders: os programas de GPU são criados quando o código dos
+// dois shaders estiver disponível
+static void OnShaderReady(Asset *asset, void *user)
+{
+    SceneShader *shader = (SceneShader *)user;
+    shader->source.swap(asset->source);
+    shader->loaded = true;
+
+    if (g_VertexShader.loaded && g_FragmentShader.loaded)
+        CreateGpuPrograms();
+}
+
+void Scene_Init(const std::vector<std::string> &extra_models)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    CreateUniformBuffers();
+    GpuTimer_Init();
+
+    // Lemos a lista de recursos do jogo. Os modelos extras (veja main()) não
+    // são desenhados, e são carregados depois de todos os outros.
+    if (!AssetManager_ReadManifest(&g_Assets, ASSET_MANIFEST))
+        std::exit(EXIT_FAILURE);
+    for (size_t i = 0; i < extra_models.size(); ++i)
+        AssetManager_Add(&g_Assets, ASSET_MESH, extra_models[i].c_str(), extra_models[i].c_str(), false);
+
+    // Os shaders de vértices e de fragmentos que serão utilizados para
+    // renderização. Veja slides 180-200 do documento Aula_03_Rendering_Pipeline_Grafico.pdf.
+    Asset *vertex_shader = AssetManager_Find(&g_Assets, "vertex");
+    Asset *fragment_shader = AssetManager_Find(&g_Assets, "fragment");
+    if (vertex_shader == NULL || fragment_shader == NULL
+        || vertex_shader->type != ASSET_SHADER || fragment_shader->type != ASSET_SHADER)
+    {
+        fprintf(stderr, "ERROR: Shaders \"vertex\" and \"fragment\" not found in \"%s\".\n", ASSET_MANIFEST);
+        std::exit(EXIT_FAILURE);
+    }
+    g_VertexShader.filename = vertex_shader->filename;
+    g_FragmentShader.filename = fragment_shader->filename;
+    AssetManager_OnReady(&g_Assets, "vertex", OnShaderReady, &g_VertexShader);
+    AssetManager_OnReady(&g_Assets, "fragment", OnShaderReady, &g_FragmentShader);
+
+    // As texturas ocupam as unidades de textura na ordem do manifesto
+    // (TextureImage0, TextureImage1, ...), com um pixel cinza até serem
+    // enviadas para a GPU.
+    CreateAssetTextures();
+
+    for (size_t i = 0; i < sizeof(g_SceneModelObjects) / sizeof(g_SceneModelObjects[0]); ++i)
+    {
+        if (!AssetManager_OnReady(&g_Assets, g_SceneModelObjects[i].asset, OnModelReady, &g_SceneModelObjects[i]))
+        {
+            fprintf(stderr, "ERROR: Model \"%s\" not found in \"%s\".\n", g_SceneModelObjects[i].asset, ASSET_MANIFEST);
+            std::exit(EXIT_FAILURE);
+        }
+    }
+
+    // Texturas comprimidas em BC1 com cores sRGB exigem as duas extensões;
+    // sem elas, os arquivos ".tex" guardam os níveis sem compressão.
+    uint32_t format = TEXTURE_FORMAT_RGB8;
+    if (GLAD_GL_EXT_texture_compression_s3tc && GLAD_GL_EXT_texture_sRGB)
+        format = TEXTURE_FORMAT_BC1;
+
+    AssetManager_Start(&g_Assets, format);
+    g_AssetsPending = true;
+
+    // Esperamos somente os recursos essenciais, enviando-os para a GPU à
+    // medida que ficam prontos
+    while (!AssetManager_Ready(&g_Assets, true))
+    {
+        Asset *asset = AssetManager_Take(&g_Assets, true);
+        if (asset == NULL)
+            break;
+        UploadAsset(asset);
+    }
+
+    // O campo de asteroides (veja LoadAsteroids()) e as HitBoxes da
+    // simulação dependem do modelo do asteroide
+    if (g_AsteroidObject < 0)
+    {
+        fprintf(stderr, "ERROR: Model \"asteroid\" must be essential in \"%s\".\n", ASSET_MANIFEST);
+        ExitWithError();
+    }
+
+    printf("Recursos essenciais prontos em %.1f ms.\n",
+           1e3 * std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+    // Habilitamos o Z-buffer. Veja slides 104-116 do documento Aula_09_Projecoes.pdf.
+    glEnable(GL_DEPTH_TEST);
+
+    // Habilitamos o Backface Culling. Veja slides 23-34 do documento Aula_13_Clipping_and_Culling.pdf e slides 112-123 do documento Aula_14_Laboratorio_3_Revisao.pdf.
+    glEnable(GL_CULL_FACE);
+    glCullFace(GL_BACK);
+    glFrontFace(GL_CCW);
+}
+
+void Scene_Draw(const SimulationState &state, const SceneCamera &camera, float time)
+{
+    // Enviamos para a GPU alguns dos recursos que terminaram de ser lidos
+    UploadLoadedAssets(false);
+
+    // Aqui executamos as operações de renderização
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+
+    // "Pintamos" todos os pixels do framebuffer com a cor definida acima,
+    // e também resetamos todos os pixels do Z-buffer (depth buffer).
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    glm::vec4 displacement = state.displacement;
+
+    // Recalcula posição da nave com base no deslocamento calculado
+    glm::vec4 spaceship_position = glm::vec4(displacement.x, displacement.y, displacement.z, 1.0f);
+
+    glm::vec4 camera_position_c;                                      // Ponto "c", centro da câmera
+    glm::vec4 camera_view_vector;                                     // Vetor "view", sentido para onde a câmera está virada
+    glm::vec4 camera_up_vector = glm::vec4(0.0f, 1.0f, 0.0f, 0.0f);   // Vetor "up" fixado para apontar para o "céu" (eito Y global)
+
+    // Calcula a distância necessária da câmera para incluir todo o objeto no campo de visão
+    float distance_to_object = 3.5f;
+
+    float x = cos(camera.phi) * sin(camera.theta);
+    float y = -(sin(camera.phi));
+    float z = cos(camera.phi) * cos(camera.theta);
+
+    // 1a pessoa (câmera livre)
+    if (camera.first_person)
+    {
+        camera_position_c = glm::vec4(displacement.x, displacement.y, displacement.z - 0.5f, 1.0f);
+        camera_view_vector = glm::vec4(-x, y, -z, 0.0f);
+    }
+    // 3a pessoa (câmera look-at na direção da nave)
+    else
+    {
+        // Recalcula a posição da câmera conforme a posição da nave
+        camera_position_c = glm::vec4(spaceship_position.x + x * distance_to_object, spaceship_position.y + -y * distance_to_object, spaceship_position.z + z * distance_to_object, 1.0f);
+        camera_view_vector = spaceship_position - camera_position_c;
+    }
+
+    // Computamos a matriz "View" utilizando os parâmetros da câmera para
+    // definir o sistema de coordenadas da câmera.  Veja slides 2-14, 184-190 e 236-242 do documento Aula_08_Sistemas_de_Coordenadas.pdf.
+    glm::mat4 view = Matrix_Camera_View(camera_position_c, camera_view_vector, camera_up_vector);
+
+    // Agora computamos a matriz de Projeção.
+    glm::mat4 projection;
+
+    // Note que, no sistema de coordenadas da câmera, os planos near e far
+    // estão no sentido negativo! Veja slides 176-204 do documento Aula_09_Projecoes.pdf.
+    float nearplane = -0.1f;  // Posição do "near plane"
+    float farplane = -500.0f; // Posição do "far plane"
+
+    // Projeção Perspectiva.
+    float field_of_view = 3.141592 / 3.0f;
+    projection = Matrix_Perspective(field_of_view, camera.screen_ratio, nearplane, farplane);
+
+    glm::mat4 model = Matrix_Identity(); // Transformação identidade de modelagem
+
+    // Enviamos as matrizes "view" e "projection", e os demais dados do
+    // quadro, para a placa de vídeo (GPU). Veja o arquivo
+    // "shader_vertex.glsl", onde estas são efetivamente aplicadas em todos os
+    // pontos.
+    FrameUniforms frame;
+    frame.view = view;
+    frame.projection = projection;
+    frame.view_inverse = glm::inverse(view);
+    frame.camera_position = frame.view_inverse * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    frame.light_position = glm::vec4(0.0f, 0.0f, 0.0f, 0.0f); // Valor que "light_pos" sempre teve no Vertex Shader
+    frame.light_direction = glm::normalize(glm::vec4(-200.0f, -3.0f, 3.0f, 0.0f));
+    glBindBuffer(GL_UNIFORM_BUFFER, g_FrameUniformBuffer);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), &frame, GL_STREAM_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_UNIFORMS_BINDING, g_FrameUniformBuffer);
+
+    // Desenhamos o modelo da esfera, vista por dentro
+    model = Matrix_Translate(-10.0f, -10.0f, 1.0f) * Matrix_Scale(500.0f, 500.0f, 500.0f);
+    QueueVirtualObject(g_SphereObject, model, SPHERE, 1, GL_FRONT);
+
+    // Desenhamos o modelo da lua
+    model = Matrix_Translate(10.0f, 10.0f, -10.0f) * Matrix_Scale(4.0f, 4.0f, 4.0f);
+    QueueVirtualObject(g_MoonObject, model, MOON);
+
+    // Desenhamos o modelo da nave
+    model = Matrix_Translate(spaceship_position.x, spaceship_position.y, spaceship_position.z)
+            * Matrix_Scale(0.5f, 0.5f, 0.5f)
+            * Matrix_Rotate_Y(3.1415 + camera.theta)
+            * Matrix_Rotate_X(camera.phi)
+            * Matrix_Rotate_Z(state.angle_z * 0.1f);
+
+    QueueVirtualObject(g_SpaceshipObject, model, SPACESHIP);
+
+    // Desenhamos os modelos das moedas
+    LoadCoins(state, time);
+
+    // Desenhamos os modelos dos asteroides
+    DrawAsteroidField();
+
+    // Desenha asteroide em relação ao seu ponto atual na curva de Bezier
+    if (state.bezier_visible)
+    {
+        glm::vec4 bezier_place = state.bezier_position;
+        glm::vec3 bezier_scale = SIMULATION_BEZIER_SCALE;
+        model = Matrix_Translate(bezier_place.x, bezier_place.y, bezier_place.z) * Matrix_Scale(bezier_scale.x, bezier_scale.y, bezier_scale.z);
+        QueueVirtualObject(g_AsteroidObject, model, ASTEROID);
+    }
+
+    DrawQueuedObjects();
+}
+
+// Cria os buffers dos blocos "FrameUniforms" e "ObjectUniforms". Veja
+// CreateGpuPrograms() para a associação dos blocos aos buffers.
+void CreateUniformBuffers()
+{
+    GLint alignment;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    if (alignment <= 0)
+        alignment = 256;
+    g_ObjectUniformStride = ((sizeof(ObjectUniforms) + alignment - 1) / alignment) * alignment;
+
+    glGenBuffers(1, &g_FrameUniformBuffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, g_FrameUniformBuffer);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), NULL, GL_STREAM_DRAW);
+
+    glGenBuffers(1, &g_ObjectUniformBuffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, g_ObjectUniformBuffer);
+    glBufferData(GL_UNIFORM_BUFFER, OBJECT_UNIFORMS_SLOTS * g_ObjectUniformStride, NULL, GL_STREAM_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+// Adiciona um objeto de g_VirtualScene à lista de desenho do quadro, com a
+// matriz de modelagem "model" e o material "material" (ASTEROID, SPACESHIP
+// etc.). Os objetos são desenhados por DrawQueuedObjects().
+void QueueVirtualObject(int object_id, const glm::mat4 &model, int material, GLsizei num_instances, GLenum cull_face)
+{
+    // Modelo ou shaders ainda não carregados (veja Scene_Init())
+    if (object_id < 0 || g_GpuProgramIDs[material] == 0)
+        return;
+
+    const SceneObject &theobject = g_VirtualScene[object_id];
+
+    SceneDraw draw;
+    draw.object_id = object_id;
+    draw.material = material;
+    draw.num_instances = num_instances;
+    draw.cull_face = cull_face;
+    draw.uniforms.model = model;
+    draw.uniforms.normal_matrix = glm::inverse(glm::transpose(model));
+    draw.uniforms.bbox_min = glm::vec4(theobject.bbox_min, 1.0f);
+    draw.uniforms.bbox_max = glm::vec4(theobject.bbox_max, 1.0f);
+    draw.uniforms.instanced = num_instances > 1 ? GL_TRUE : GL_FALSE;
+    draw.uniforms.padding[0] = draw.uniforms.padding[1] = draw.uniforms.padding[2] = 0;
+    g_SceneDraws.push_back(draw);
+}
+
+// Passe de renderização de cada material, cujo tempo de GPU é medido
+// separadamente (veja "gputimer.h")
+static int MaterialPass(int material)
+{
+    if (material == SPACESHIP)
+        return PROFILER_GPU_SHIP;
+    if (material == SPHERE)
+        return PROFILER_GPU_SKYBOX;
+    return PROFILER_GPU_WORLD;
+}
+
+// Ordem de desenho: agrupamos os objetos pelo passe, para medir cada um com
+// uma única query, e dentro do passe pelo material, isto é, pelo programa de
+// GPU, para trocar de programa o mínimo de vezes por quadro. O céu é o
+// último passe: os seus fragmentos encobertos pelos demais objetos são
+// descartados pelo teste de profundidade antes do Fragment Shader.
+static bool CompareDraws(const SceneDraw &a, const SceneDraw &b)
+{
+    int pass_a = MaterialPass(a.material);
+    int pass_b = MaterialPass(b.material);
+    if (pass_a != pass_b)
+        return pass_a < pass_b;
+    return a.material < b.material;
+}
+
+// Envia os dados de todos os objetos da lista de desenho para a GPU de uma
+// só vez e os desenha, selecionando o trecho de cada um no buffer do bloco
+// "ObjectUniforms" no lugar de várias chamadas glUniform*() por objeto.
+void DrawQueuedObjects()
+{
+    std::stable_sort(g_SceneDraws.begin(), g_SceneDraws.end(), CompareDraws);
+
+    glBindBuffer(GL_UNIFORM_BUFFER, g_ObjectUniformBuffer);
+    GLuint current_program = 0;
+    int current_pass = -1;
+
+    size_t first = 0;
+    while (first < g_SceneDraws.size())
+    {
+        size_t count = std::min(g_SceneDraws.size() - first, (size_t)OBJECT_UNIFORMS_SLOTS);
+
+        // Se o restante do buffer não comporta os objetos, pedimos um novo
+        // bloco de memória ao driver; o bloco antigo continua válido até a
+        // GPU terminar de utilizá-lo.
+        if (g_ObjectUniformSlot + count > OBJECT_UNIFORMS_SLOTS)
+        {
+            glBufferData(GL_UNIFORM_BUFFER, OBJECT_UNIFORMS_SLOTS * g_ObjectUniformStride, NULL, GL_STREAM_DRAW);
+            g_ObjectUniformSlot = 0;
+        }
+
+        // A região escrita nunca foi utilizada desde a última realocação,
+        // portanto não é preciso sincronizar com a GPU
+        char *data = (char *)glMapBufferRange(GL_UNIFORM_BUFFER,
+                                              g_ObjectUniformSlot * g_ObjectUniformStride,
+                                              count * g_ObjectUniformStride,
+                                              GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        if (data != NULL)
+        {
+            for (size_t i = 0; i < count; ++i)
+                memcpy(data + i * g_ObjectUniformStride, &g_SceneDraws[first + i].uniforms, sizeof(ObjectUniforms));
+            glUnmapBuffer(GL_UNIFORM_BUFFER);
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                const SceneDraw &draw = g_SceneDraws[first + i];
+                int pass = MaterialPass(draw.material);
+                if (pass != current_pass)
+                {
+                    GpuTimer_Begin(pass);
+                    current_pass = pass;
+                }
+                GLuint program = g_GpuProgramIDs[draw.material];
+                if (program != current_program)
+                {
+                    glUseProgram(program);
+                    current_program = program;
+                }
+                glBindBufferRange(GL_UNIFORM_BUFFER, OBJECT_UNIFORMS_BINDING, g_ObjectUniformBuffer,
+                                  (g_ObjectUniformSlot + i) * g_ObjectUniformStride, sizeof(ObjectUniforms));
+                if (draw.cull_face != GL_BACK)
+                    glCullFace(draw.cull_face);
+                DrawVirtualObject(draw.object_id, draw.num_instances);
+                if (draw.cull_face != GL_BACK)
+                    glCullFace(GL_BACK);
+            }
+        }
+
+        g_ObjectUniformSlot += count;
+        first += count;
+    }
+
+    GpuTimer_End();
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    g_SceneDraws.clear();
+}
+
+// Constrói o campo de asteroides: as matrizes de modelagem dos seis
+// asteroides fixos do jogo, seguidas de "num_extra_asteroids" asteroides
+// aleatórios (veja a opção "--asteroids N" em main()). As matrizes são
+// enviadas uma única vez para a GPU, em um VBO de atributos por instância.
+void LoadAsteroids(int num_extra_asteroids)
+{
+    g_AsteroidInstances.clear();
+
+    // Asteroides fixos do jogo. Suas HitBoxes são definidas em "simulation.cpp".
+    g_AsteroidInstances.push_back(Matrix_Translate(0.0f, -2.5f, -6.0f));
+    g_AsteroidInstances.push_back(Matrix_Translate(6.0f, -1.5f, -14.5f) * Matrix_Scale(1.75, 1.5, 1.0));
+    g_AsteroidInstances.push_back(Matrix_Translate(1.0f, -0.5f, -10.5f) * Matrix_Rotate_Z(4.0));
+    g_AsteroidInstances.push_back(Matrix_Translate(0.5f, 2.5f, -10.0f) * Matrix_Rotate_X(3.0) * Matrix_Scale(1.0, 0.9, 1.45));
+    g_AsteroidInstances.push_back(Matrix_Translate(-2.5f, 1.0f, -7.5f) * Matrix_Rotate_Y(2.0) * Matrix_Scale(0.6, 1.2, 1.25));
+    g_AsteroidInstances.push_back(Matrix_Translate(-3.5f, -1.5f, -13.5f) * Matrix_Rotate_Z(1.0) * Matrix_Scale(0.95, 1.0, 1.4));
+
+    // Asteroides extras, espalhados em um cinturão ao redor da origem. Eles
+    // não possuem HitBox; servem somente para medir o desempenho da
+    // renderização em função do número de instâncias. A semente é fixa para
+    // que as medições sejam reproduzíveis.
+    std::mt19937 rng(2023);
+    std::uniform_real_distribution<float> angle(0.0f, 2.0f * 3.141592f);
+    std::uniform_real_distribution<float> radius(20.0f, 200.0f);
+    std::uniform_real_distribution<float> height(-20.0f, 20.0f);
+    std::uniform_real_distribution<float> scale(0.3f, 1.5f);
+    for (int i = 0; i < num_extra_asteroids; ++i)
+    {
+        float a = angle(rng);
+        float r = radius(rng);
+        g_AsteroidInstances.push_back(Matrix_Translate(r * cos(a), height(rng), r * sin(a))
+                                      * Matrix_Rotate_X(angle(rng))
+                                      * Matrix_Rotate_Y(angle(rng))
+                                      * Matrix_Scale(scale(rng), scale(rng), scale(rng)));
+    }
+
+    // Cada instância leva também a matriz que transforma as suas normais, para
+    // que o Vertex Shader não precise inverter uma matriz por vértice.
+    std::vector<glm::mat4> instance_data;
+    instance_data.reserve(2 * g_AsteroidInstances.size());
+    for (size_t i = 0; i < g_AsteroidInstances.size(); ++i)
+    {
+        instance_data.push_back(g_AsteroidInstances[i]);
+        instance_data.push_back(glm::inverse(glm::transpose(g_AsteroidInstances[i])));
+    }
+
+    // Enviamos as matrizes para a GPU e as associamos ao VAO do asteroide como
+    // atributos por instância. Um atributo mat4 ocupa quatro localizações
+    // consecutivas, uma para cada coluna. Veja "(location = 3)" e
+    // "(location = 7)" em "shader_vertex.glsl".
+    if (g_AsteroidInstanceBuffer == 0)
+        glGenBuffers(1, &g_AsteroidInstanceBuffer);
+
+    glBindVertexArray(g_VirtualScene[g_AsteroidObject].vertex_array_object_id);
+    glBindBuffer(GL_ARRAY_BUFFER, g_AsteroidInstanceBuffer);
+    glBufferData(GL_ARRAY_BUFFER, instance_data.size() * sizeof(glm::mat4), instance_data.data(), GL_STATIC_DRAW);
+
+    for (GLuint column = 0; column < 8; ++column)
+    {
+        GLuint location = 3 + column;
+        glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, 2 * sizeof(glm::mat4), (void *)(column * sizeof(glm::vec4)));
+        glEnableVertexAttribArray(location);
+        glVertexAttribDivisor(location, 1); // Avança uma vez por instância
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+}
+
+// Desenha todos os asteroides do campo construído por LoadAsteroids() com uma
+// única chamada de desenho.
+void DrawAsteroidField()
+{
+    QueueVirtualObject(g_AsteroidObject, Matrix_Identity(), ASTEROID, (GLsizei)g_AsteroidInstances.size());
+}
+
+// Desenha as moedas que ainda não foram coletadas, girando conforme "time"
+void LoadCoins(const SimulationState &state, float time)
+{
+    glm::mat4 model = Matrix_Identity();
+
+    if (state.coin_visible[0])
+    {
+        // Desenhamos os modelos das moedas
+        model = Matrix_Translate(0.0f, -1.75f, -7.5f) * Matrix_Scale(0.5f, 0.5f, 0.5f) * Matrix_Rotate_Y(time);
+        QueueVirtualObject(g_CoinObject, model, COIN);
+    }
+
+    if (state.coin_visible[1])
+    {
+        model = Matrix_Translate(0.0f, 0.0f, -14.5f) * Matrix_Scale(0.5f, 0.5f, 0.5f) * Matrix_Rotate_Y(time);
+        QueueVirtualObject(g_CoinObject, model, COIN);
+    }
+
+    if (state.coin_visible[2])
+    {
+        model = Matrix_Translate(3.0f, -4.0f, -18.5f) * Matrix_Scale(0.5f, 0.5f, 0.5f) * Matrix_Rotate_Y(time);
+        QueueVirtualObject(g_CoinObject, model, COIN);
+    }
+}
+
+// Cria uma textura e o seu sampler, associados à unidade de textura
+// "textureunit", sem imagem. Veja slides 95-96 do documento Aula_20_Mapeamento_de_Texturas.pdf
+GLuint CreateTexture(GLuint textureunit)
+{
+    // Agora criamos objetos na GPU com OpenGL para armazenar a textura
+    GLuint texture_id;
+    GLuint sampler_id;
+    glGenTextures(1, &texture_id);
+    glGenSamplers(1, &sampler_id);
+
+    glSamplerParameteri(sampler_id, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glSamplerParameteri(sampler_id, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    // Parâmetros de amostragem da textura.
+    glSamplerParameteri(sampler_id, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glSamplerParameteri(sampler_id, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    glActiveTexture(GL_TEXTURE0 + textureunit);
+    glBindTexture(GL_TEXTURE_2D, texture_id);
+    glBindSampler(textureunit, sampler_id);
+
+    return texture_id;
+}
+
+// Envia para a textura "texture_id", ligada à unidade "textureunit", uma
+// imagem de um único pixel cinza, utilizada enquanto a imagem verdadeira não
+// é carregada. Uma imagem 1x1 já é uma cadeia de mipmaps completa.
+static void UploadPlaceholderTexture(GLuint textureunit, GLuint texture_id)
+{
+    const unsigned char placeholder[3] = {128, 128, 128};
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+    glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+
+    glActiveTexture(GL_TEXTURE0 + textureunit);
+    glBindTexture(GL_TEXTURE_2D, texture_id);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_SRGB8, 1, 1, 0, GL_RGB, GL_UNSIGNED_BYTE, placeholder);
+}
+
+// Envia todos os níveis de mipmap de "texture" para a textura "texture_id",
+// ligada à unidade "textureunit". Os níveis já vêm prontos do arquivo ".tex"
+// (veja "texturecache.h"), portanto glGenerateMipmap() não é necessário.
+// Se houver um Pixel Buffer Object ligado a GL_PIXEL_UNPACK_BUFFER, "data" é
+// o deslocamento dos níveis dentro dele, e a cópia para a textura é feita
+// pelo driver sem bloquear a CPU.
+static void UploadTextureData(GLuint textureunit, GLuint texture_id, const TextureData &texture, const unsigned char *data)
+{
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+    glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+
+    glActiveTexture(GL_TEXTURE0 + textureunit);
+    glBindTexture(GL_TEXTURE_2D, texture_id);
+
+    for (uint32_t level = 0; level < texture.num_levels; ++level)
+    {
+        GLsizei width = (GLsizei)TextureData_LevelDimension(texture.width, level);
+        GLsizei height = (GLsizei)TextureData_LevelDimension(texture.height, level);
+        GLsizei size = (GLsizei)TextureData_LevelSize(texture.format, width, height);
+
+        if (texture.format == TEXTURE_FORMAT_BC1)
+            glCompressedTexImage2D(GL_TEXTURE_2D, level, GL_COMPRESSED_SRGB_S3TC_DXT1_EXT, width, height, 0, size, data);
+        else
+            glTexImage2D(GL_TEXTURE_2D, level, GL_SRGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
+
+        data += size;
+    }
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, texture.num_levels - 1);
+}
+
+// Cria as texturas de todas as imagens do manifesto, nas próximas unidades
+// de textura livres. Até que UploadAsset() envie a imagem, cada textura
+// contém um único pixel cinza.
+// As unidades lidas pelos shaders que ficarem sem imagem no manifesto
+// recebem uma textura somente com o pixel cinza.
+static void CreateAssetTextures()
+{
+    for (size_t i = 0; i < g_Assets.assets.size(); ++i)
+    {
+        Asset *asset = g_Assets.assets[i];
+        if (asset->type != ASSET_TEXTURE)
+            continue;
+
+        asset->texture_unit = g_NumLoadedTextures;
+        asset->texture_id = CreateTexture(asset->texture_unit);
+        UploadPlaceholderTexture(asset->texture_unit, asset->texture_id);
+        g_NumLoadedTextures += 1;
+    }
+
+    while (g_NumLoadedTextures < SCENE_NUM_TEXTURE_UNITS)
+    {
+        GLuint texture_id = CreateTexture(g_NumLoadedTextures);
+        UploadPlaceholderTexture(g_NumLoadedTextures, texture_id);
+        g_NumLoadedTextures += 1;
+    }
+
+    if (g_TextureUploadBuffer == 0)
+        glGenBuffers(1, &g_TextureUploadBuffer);
+}
+
+// Envia para a GPU um recurso lido pelo gerenciador e o marca como pronto,
+// o que chama o seu callback (veja Scene_Init()). Um erro em um recurso
+// essencial encerra o programa; nos demais, o recurso é somente ignorado.
+static void UploadAsset(Asset *asset)
+{
+    if (asset->failed)
+    {
+        fprintf(stderr, "ERROR: Cannot load asset \"%s\" from \"%s\".\n", asset->name.c_str(), asset->filename.c_str());
+        if (asset->essential)
+            ExitWithError();
+    }
+    else if (asset->type == ASSET_MESH)
+    {
+        if (asset->from_cache)
+            printf("Carregando objetos do cache \"%s\"... OK (%.1f ms).\n",
+                   MeshCache_Filename(asset->filename.c_str()).c_str(), 1e3 * asset->load_seconds);
+        asset->object_id = AddMeshToVirtualScene(asset->from_cache ? asset->cache.view : MeshData_View(asset->mesh));
+    }
+    else if (asset->type == ASSET_TEXTURE)
+    {
+        const TextureData &texture = asset->texture;
+        printf("Carregando imagem \"%s\"... OK (%ux%u, %s, %u níveis, %s, %.1f ms).\n",
+               asset->filename.c_str(), texture.width, texture.height,
+               texture.format == TEXTURE_FORMAT_BC1 ? "BC1" : "RGB8", texture.num_levels,
+               asset->from_cache ? "lida do .tex" : "convertida", 1e3 * asset->load_seconds);
+
+        // Copiamos os níveis para um Pixel Buffer Object, realocado
+        // ("orphaning") a cada imagem para não esperar o envio da anterior,
+        // e a textura é preenchida a partir dele.
+        GLsizeiptr size = (GLsizeiptr)texture.data.size();
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, g_TextureUploadBuffer);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+        void *data = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        if (data != NULL)
+        {
+            memcpy(data, texture.data.data(), size);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            UploadTextureData(asset->texture_unit, asset->texture_id, texture, (const unsigned char *)0);
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+        // Sem o PBO, enviamos diretamente da memória da CPU
+        if (data == NULL)
+            UploadTextureData(asset->texture_unit, asset->texture_id, texture, texture.data.data());
+
+        g_TextureBytes += texture.data.size();
+    }
+
+    // Shaders não são enviados aqui: o callback OnShaderReady() cria os
+    // programas de GPU
+    AssetManager_MarkReady(&g_Assets, asset);
+}
+
+// Envia para a GPU os recursos já lidos pelo gerenciador, até gastar
+// "budget_seconds" segundos (ao menos um recurso por chamada, já que o
+// envio de um recurso não pode ser dividido). Os demais ficam para as
+// próximas chamadas, uma por quadro, para que o carregamento não atrase os
+// quadros. Com "wait" verdadeiro, espera e envia todos os recursos. Deve ser
+// chamada pela thread do contexto OpenGL.
+void UploadLoadedAssets(bool wait, double budget_seconds)
+{
+    if (!g_AssetsPending)
+        return;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    Asset *asset;
+    while ((asset = AssetManager_Take(&g_Assets, wait)) != NULL)
+    {
+        UploadAsset(asset);
+        if (!wait && std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() >= budget_seconds)
+            break;
+    }
+
+    if (AssetManager_Ready(&g_Assets, false))
+    {
+        printf("Recursos: %d carregados em %.1f ms, texturas com %.1f MB.\n", (int)g_Assets.assets.size(),
+               1e3 * std::chrono::duration<double>(std::chrono::steady_clock::now() - g_Assets.start).count(),
+               g_TextureBytes / (1024.0 * 1024.0));
+        AssetManager_Finish(&g_Assets);
+        g_AssetsPending = false;
+    }
+}
+
+// Função que busca o identificador de um objeto de g_VirtualScene pelo seu
+// nome. Deve ser utilizada somente durante a inicialização.
+int FindVirtualObject(const char *object_name)
+{
+    std::map<std::string, int>::const_iterator it = g_VirtualSceneIds.find(object_name);
+    if (it == g_VirtualSceneIds.end())
+    {
+        fprintf(stderr, "ERROR: Object \"%s\" not found in the virtual scene.\n", object_name);
+        ExitWithError();
+    }
+    return it->second;
+}
+
+// Função que desenha um objeto armazenado em g_VirtualScene. Veja definição
+// dos objetos na função AddMeshToVirtualScene(). Se "num_instances" for maior
+// que 1, o objeto é desenhado várias vezes com uma única chamada; as matrizes
+// de modelagem de cada instância devem estar associadas ao VAO (veja
+// LoadAsteroids()).
+void DrawVirtualObject(int object_id, GLsizei num_instances)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    const SceneObject &theobject = g_VirtualScene[object_id];
+
+    // "Ligamos" o VAO. Informamos que queremos utilizar os atributos de
+    // vértices apontados pelo VAO criado pela função AddMeshToVirtualScene(). Veja
+    // comentários detalhados dentro da definição de AddMeshToVirtualScene().
+    glBindVertexArray(theobject.vertex_array_object_id);
+
+    // Pedimos para a GPU rasterizar os vértices dos eixos XYZ
+    // apontados pelo VAO como linhas. Veja a definição de
+    // g_VirtualScene[] dentro da função AddMeshToVirtualScene(), e veja
+    // a documentação da função glDrawElementsBaseVertex() em
+    // http://docs.gl/gl3/glDrawElementsBaseVertex.
+    if (num_instances == 1)
+    {
+        glDrawElementsBaseVertex(
+            theobject.rendering_mode,
+            theobject.num_indices,
+            theobject.index_type,
+            (void *)theobject.index_offset,
+            theobject.base_vertex);
+    }
+    else
+    {
+        glDrawElementsInstancedBaseVertex(
+            theobject.rendering_mode,
+            theobject.num_indices,
+            theobject.index_type,
+            (void *)theobject.index_offset,
+            num_instances,
+            theobject.base_vertex);
+    }
+
+    // "Desligamos" o VAO, evitando assim que operações posteriores venham a
+    // alterar o mesmo. Isso evita bugs.
+    glBindVertexArray(0);
+
+    g_DrawCalls += 1;
+    g_DrawTriangles += (theobject.num_indices / 3) * num_instances;
+    g_DrawCpuSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Função que carrega os shaders de vértices e de fragmentos que serão
+// utilizados para renderização. Veja slides 180-200 do documento Aula_03_Rendering_Pipeline_Grafico.pdf.
+//
+void LoadShadersFromFiles()
+{
+    g_VertexShader.source = LoadShaderSource(g_VertexShader.filename.c_str());
+    g_FragmentShader.source = LoadShaderSource(g_FragmentShader.filename.c_str());
+    CreateGpuPrograms();
+}
+
+// Cria os programas de GPU a partir do código dos shaders já lido do disco
+// (veja Scene_Init() e LoadShadersFromFiles()).
+void CreateGpuPrograms()
+{
+    // Cada material é desenhado por uma variante dos mesmos shaders,
+    // compilada com "#define MATERIAL n". Assim, cada programa contém somente
+    // o código (e as leituras de textura) do seu material, sem desvios por
+    // fragmento.
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    int cached_programs = 0;
+
+    for (int material = 0; material < SCENE_NUM_MATERIALS; ++material)
+    {
+        char defines[32];
+        snprintf(defines, sizeof(defines), "#define MATERIAL %d\n", material);
+
+        std::string vertex_source = InsertShaderDefines(g_VertexShader.source, defines);
+        std::string fragment_source = InsertShaderDefines(g_FragmentShader.source, defines);
+
+        // Deletamos o programa de GPU anterior, caso ele exista.
+        GLuint &program_id = g_GpuProgramIDs[material];
+        if (program_id != 0)
+            glDeleteProgram(program_id);
+
+        // Buscamos o programa já linkado no cache em disco (veja
+        // "programcache.h"). Qualquer mudança no código dos shaders ou no
+        // driver muda a chave e invalida o cache.
+        char cache_filename[64];
+        snprintf(cache_filename, sizeof(cache_filename), "../../data/shader_material%d.program", material);
+        uint64_t cache_key = ProgramCache_Key(vertex_source, fragment_source);
+        program_id = ProgramCache_Load(cache_filename, cache_key);
+
+        if (program_id == 0)
+        {
+            GLuint vertex_shader_id = glCreateShader(GL_VERTEX_SHADER);
+            GLuint fragment_shader_id = glCreateShader(GL_FRAGMENT_SHADER);
+            CompileShader(vertex_shader_id, vertex_source, g_VertexShader.filename.c_str());
+            CompileShader(fragment_shader_id, fragment_source, g_FragmentShader.filename.c_str());
+
+            // Criamos um programa de GPU utilizando os shaders compilados
+            // acima, e o gravamos no cache.
+            program_id = CreateGpuProgram(vertex_shader_id, fragment_shader_id, cache_filename, cache_key);
+        }
+        else
+            cached_programs += 1;
+
+        // Associamos os blocos de uniformes dos shaders aos pontos de ligação
+        // dos buffers criados por CreateUniformBuffers(), uma única vez por
+        // programa. Veja arquivo "shader_vertex.glsl" e "shader_fragment.glsl".
+        GLuint frame_block = glGetUniformBlockIndex(program_id, "FrameUniforms");
+        GLuint object_block = glGetUniformBlockIndex(program_id, "ObjectUniforms");
+        if (frame_block != GL_INVALID_INDEX)
+            glUniformBlockBinding(program_id, frame_block, FRAME_UNIFORMS_BINDING);
+        if (object_block != GL_INVALID_INDEX)
+            glUniformBlockBinding(program_id, object_block, OBJECT_UNIFORMS_BINDING);
+
+        // Variáveis em "shader_fragment.glsl" para acesso das imagens de
+        // textura. As que não são utilizadas pelo material não existem no
+        // programa, e glUniform1i() com a localização -1 é ignorada.
+        glUseProgram(program_id);
+        glUniform1i(glGetUniformLocation(program_id, "TextureImage0"), 0);
+        glUniform1i(glGetUniformLocation(program_id, "TextureImage1"), 1);
+        glUniform1i(glGetUniformLocation(program_id, "TextureImage2"), 2);
+        glUniform1i(glGetUniformLocation(program_id, "TextureImage3"), 3);
+        glUniform1i(glGetUniformLocation(program_id, "TextureImage4"), 4);
+        glUniform1i(glGetUniformLocation(program_id, "TextureImage5"), 5);
+        glUseProgram(0);
+    }
+
+    printf("Programas de GPU: %d de %d do cache, %.1f ms.\n", cached_programs, SCENE_NUM_MATERIALS,
+           1e3 * std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+}
+
+// Função que computa as normais de um ObjModel, caso elas não tenham sido
+// especificadas dentro do arquivo ".obj"
+void ComputeNormals(ObjModel *model, int weighting, int num_threads)
+{
+    if (!model->attrib.normals.empty())
+        return;
+
+    // Primeiro computamos as normais para todos os TRIÂNGULOS.
+    // Segundo, computamos as normais dos VÉRTICES através do método proposto
+    // por Gouraud, onde a normal de cada vértice vai ser a média das normais de
+    // todas as faces que compartilham este vértice. Veja "normals.h".
+
+    size_t num_vertices = model->attrib.vertices.size() / 3;
+
+    // Índices dos vértices de todos os triângulos do modelo, em sequência
+    std::vector<int> triangles;
+    for (size_t shape = 0; shape < model->shapes.size(); ++shape)
+    {
+        tinyobj::mesh_t &mesh = model->shapes[shape].mesh;
+        size_t num_triangles = mesh.num_face_vertices.size();
+
+        for (size_t triangle = 0; triangle < num_triangles; ++triangle)
+        {
+            assert(mesh.num_face_vertices[triangle] == 3);
+
+            for (size_t vertex = 0; vertex < 3; ++vertex)
+            {
+                tinyobj::index_t &idx = mesh.indices[3 * triangle + vertex];
+                triangles.push_back(idx.vertex_index);
+                idx.normal_index = idx.vertex_index;
+            }
+        }
+    }
+
+    model->attrib.normals.resize(3 * num_vertices);
+    ComputeVertexNormals(model->attrib.vertices.data(), num_vertices, triangles.data(), triangles.size() / 3,
+                         weighting, model->attrib.normals.data(), num_threads);
+}
+
+// Número de floats por vértice antes da quantização feita em
+// BuildTriangles(): posição (X, Y, Z), normal (X, Y, Z) e textura (U, V).
+#define VERTEX_ATTRIBUTE_FLOATS 8
+
+// Chave usada para identificar vértices repetidos em BuildTriangles(): os
+// bits dos VERTEX_ATTRIBUTE_FLOATS atributos do vértice.
+struct VertexKey
+{
+    uint32_t bits[VERTEX_ATTRIBUTE_FLOATS];
+
+    bool operator==(const VertexKey &other) const
+    {
+        return memcmp(bits, other.bits, sizeof(bits)) == 0;
+    }
+};
+
+struct VertexKeyHash
+{
+    size_t operator()(const VertexKey &key) const
+    {
+        // FNV-1a sobre as palavras de 32 bits da chave
+        uint64_t h = 14695981039346656037ULL;
+        for (size_t i = 0; i < VERTEX_ATTRIBUTE_FLOATS; ++i)
+        {
+            h ^= key.bits[i];
+            h *= 1099511628211ULL;
+        }
+        return (size_t)h;
+    }
+};
+
+// Constrói triângulos para futura renderização a partir de um ObjModel. Os
+// atributos de cada vértice são quantizados e intercalados em um único buffer
+// (veja MeshVertex em "meshcache.h"). Vértices idênticos (mesma posição,
+// normal e coordenadas de textura) dentro de um objeto são armazenados uma
+// única vez, e os triângulos passam a referenciá-los através dos índices.
+void BuildTriangles(ObjModel *model, MeshData *mesh)
+{
+    mesh->shapes.clear();
+    mesh->vertices.clear();
+    mesh->indices.clear();
+    mesh->flags = 0;
+
+    std::unordered_map<VertexKey, uint32_t, VertexKeyHash> unique_vertices;
+    std::vector<float> shape_vertices;
+    std::vector<uint32_t> shape_indices;
+
+    for (size_t shape = 0; shape < model->shapes.size(); ++shape)
+    {
+        size_t num_triangles = model->shapes[shape].mesh.num_face_vertices.size();
+        size_t base_vertex = mesh->vertices.size();
+
+        unique_vertices.clear();
+        unique_vertices.reserve(3 * num_triangles);
+        shape_vertices.clear();
+        shape_indices.clear();
+
+        const float minval = std::numeric_limits<float>::min();
+        const float maxval = std::numeric_limits<float>::max();
+
+        glm::vec3 bbox_min = glm::vec3(maxval, maxval, maxval);
+        glm::vec3 bbox_max = glm::vec3(minval, minval, minval);
+
+        for (size_t triangle = 0; triangle < num_triangles; ++triangle)
+        {
+            assert(model->shapes[shape].mesh.num_face_vertices[triangle] == 3);
+
+            for (size_t vertex = 0; vertex < 3; ++vertex)
+            {
+                tinyobj::index_t idx = model->shapes[shape].mesh.indices[3 * triangle + vertex];
+
+                float attributes[VERTEX_ATTRIBUTE_FLOATS] = {0.0f};
+
+                const float vx = model->attrib.vertices[3 * idx.vertex_index + 0];
+                const float vy = model->attrib.vertices[3 * idx.vertex_index + 1];
+                const float vz = model->attrib.vertices[3 * idx.vertex_index + 2];
+                // printf("tri %d vert %d = (%.2f, %.2f, %.2f)\n", (int)triangle, (int)vertex, vx, vy, vz);
+                attributes[0] = vx; // X
+                attributes[1] = vy; // Y
+                attributes[2] = vz; // Z
+
+                bbox_min.x = std::min(bbox_min.x, vx);
+                bbox_min.y = std::min(bbox_min.y, vy);
+                bbox_min.z = std::min(bbox_min.z, vz);
+                bbox_max.x = std::max(bbox_max.x, vx);
+                bbox_max.y = std::max(bbox_max.y, vy);
+                bbox_max.z = std::max(bbox_max.z, vz);
+
+                if (idx.normal_index != -1)
+                {
+                    attributes[3] = model->attrib.normals[3 * idx.normal_index + 0]; // X
+                    attributes[4] = model->attrib.normals[3 * idx.normal_index + 1]; // Y
+                    attributes[5] = model->attrib.normals[3 * idx.normal_index + 2]; // Z
+                    mesh->flags |= MESH_HAS_NORMALS;
+                }
+
+                if (idx.texcoord_index != -1)
+                {
+                    attributes[6] = model->attrib.texcoords[2 * idx.texcoord_index + 0]; // U
+                    attributes[7] = model->attrib.texcoords[2 * idx.texcoord_index + 1]; // V
+                    mesh->flags |= MESH_HAS_TEXCOORDS;
+                }
+
+                // Procuramos o vértice na tabela de vértices únicos do objeto;
+                // se ainda não existe, ele é adicionado no final da lista.
+                VertexKey key;
+                memcpy(key.bits, attributes, sizeof(key.bits));
+
+                uint32_t next_vertex = (uint32_t)unique_vertices.size();
+                auto inserted = unique_vertices.insert(std::make_pair(key, next_vertex));
+                if (inserted.second)
+                    shape_vertices.insert(shape_vertices.end(), attributes, attributes + VERTEX_ATTRIBUTE_FLOATS);
+
+                shape_indices.push_back(inserted.first->second);
+            }
+        }
+
+        size_t num_vertices = unique_vertices.size();
+
+        // Quantizamos os vértices únicos do objeto. A posição é normalizada
+        // para [0, 1] dentro da AABB do objeto e reconstruída em
+        // "shader_vertex.glsl" a partir de bbox_min e bbox_max.
+        glm::vec3 bbox_size = bbox_max - bbox_min;
+        for (size_t i = 0; i < 3; ++i)
+            if (bbox_size[i] <= 0.0f)
+                bbox_size[i] = 1.0f;
+
+        for (size_t i = 0; i < num_vertices; ++i)
+        {
+            const float *attributes = &shape_vertices[VERTEX_ATTRIBUTE_FLOATS * i];
+
+            glm::vec3 position = (glm::make_vec3(attributes) - bbox_min) / bbox_size;
+            glm::vec3 normal = glm::make_vec3(attributes + 3);
+
+            MeshVertex thevertex;
+            for (size_t c = 0; c < 3; ++c)
+                thevertex.position[c] = (uint16_t)glm::round(glm::clamp(position[c], 0.0f, 1.0f) * 65535.0f);
+            thevertex.position[3] = 0;
+            thevertex.normal = glm::packSnorm3x10_1x2(glm::vec4(normal, 0.0f));
+            uint32_t texcoords = glm::packHalf2x16(glm::make_vec2(attributes + 6));
+            thevertex.texcoords[0] = (uint16_t)(texcoords & 0xFFFF);
+            thevertex.texcoords[1] = (uint16_t)(texcoords >> 16);
+
+            mesh->vertices.push_back(thevertex);
+        }
+
+        // Índices de 16 bits bastam se o objeto tiver no máximo 65536
+        // vértices, pois os índices são relativos a "base_vertex".
+        size_t index_size = (num_vertices <= 65536) ? sizeof(uint16_t) : sizeof(uint32_t);
+
+        // Mantemos o início de cada objeto alinhado em 4 bytes, já que objetos
+        // com índices de 16 e 32 bits compartilham o mesmo buffer.
+        mesh->indices.resize((mesh->indices.size() + 3) & ~(size_t)3);
+        size_t index_offset = mesh->indices.size();
+        mesh->indices.resize(index_offset + shape_indices.size() * index_size);
+
+        unsigned char *index_data = mesh->indices.data() + index_offset;
+        for (size_t i = 0; i < shape_indices.size(); ++i)
+        {
+            if (index_size == sizeof(uint16_t))
+            {
+                uint16_t index = (uint16_t)shape_indices[i];
+                memcpy(index_data + i * sizeof(index), &index, sizeof(index));
+            }
+            else
+            {
+                uint32_t index = shape_indices[i];
+                memcpy(index_data + i * sizeof(index), &index, sizeof(index));
+            }
+        }
+
+        MeshShape theshape;
+        memset(&theshape, 0, sizeof(theshape));
+        if (model->shapes[shape].name.size() >= sizeof(theshape.name))
+            fprintf(stderr, "WARNING: Nome do objeto '%s' truncado.\n", model->shapes[shape].name.c_str());
+        strncpy(theshape.name, model->shapes[shape].name.c_str(), sizeof(theshape.name) - 1);
+        theshape.index_offset = index_offset;           // Primeiro índice, em bytes
+        theshape.num_indices = shape_indices.size();    // Número de indices
+        theshape.index_size = index_size;
+        theshape.base_vertex = base_vertex;
+        theshape.num_vertices = num_vertices;
+        theshape.bbox_min[0] = bbox_min.x;
+        theshape.bbox_min[1] = bbox_min.y;
+        theshape.bbox_min[2] = bbox_min.z;
+        theshape.bbox_max[0] = bbox_max.x;
+        theshape.bbox_max[1] = bbox_max.y;
+        theshape.bbox_max[2] = bbox_max.z;
+
+        mesh->shapes.push_back(theshape);
+    }
+}
+
+// Envia uma malha para a GPU e adiciona seus objetos em g_VirtualScene. A
+// malha pode vir tanto de BuildTriangles() quanto de um arquivo ".mesh"
+// mapeado em memória; em ambos os casos os buffers são copiados diretamente.
+// Retorna o identificador do primeiro objeto da malha; os demais objetos
+// recebem identificadores consecutivos.
+int AddMeshToVirtualScene(const MeshView &mesh)
+{
+    int first_object_id = (int)g_VirtualScene.size();
+
+    GLuint vertex_array_object_id;
+    glGenVertexArrays(1, &vertex_array_object_id);
+    glBindVertexArray(vertex_array_object_id);
+
+    for (uint32_t shape = 0; shape < mesh.num_shapes; ++shape)
+    {
+        const MeshShape &theshape = mesh.shapes[shape];
+
+        // Cada triângulo tinha 3 vértices exclusivos antes da remoção de
+        // vértices repetidos feita por BuildTriangles().
+        printf("- Objeto '%s': %u -> %u vértices, índices de %u bits\n",
+               theshape.name, theshape.num_indices, theshape.num_vertices, 8 * theshape.index_size);
+
+        SceneObject theobject;
+        theobject.name = theshape.name;
+        theobject.index_offset = theshape.index_offset;
+        theobject.num_indices = theshape.num_indices;
+        theobject.index_type = (theshape.index_size == sizeof(GLushort)) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+        theobject.base_vertex = theshape.base_vertex;
+        theobject.rendering_mode = GL_TRIANGLES; // Índices correspondem ao tipo de rasterização GL_TRIANGLES.
+        theobject.vertex_array_object_id = vertex_array_object_id;
+
+        theobject.bbox_min = glm::make_vec3(theshape.bbox_min);
+        theobject.bbox_max = glm::make_vec3(theshape.bbox_max);
+
+        g_VirtualSceneIds[theobject.name] = (int)g_VirtualScene.size();
+        g_VirtualScene.push_back(theobject);
+    }
+
+    const GLsizei stride = sizeof(MeshVertex);
+
+    GLuint VBO_vertex_coefficients_id;
+    glGenBuffers(1, &VBO_vertex_coefficients_id);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO_vertex_coefficients_id);
+    glBufferData(GL_ARRAY_BUFFER, (size_t)mesh.num_vertices * stride, mesh.vertices, GL_STATIC_DRAW);
+
+    // Posição com 16 bits por coeficiente, normalizada para [0, 1]
+    GLuint location = 0;            // "(location = 0)" em "shader_vertex.glsl"
+    GLint number_of_dimensions = 3; // vec3 em "shader_vertex.glsl"
+    glVertexAttribPointer(location, number_of_dimensions, GL_UNSIGNED_SHORT, GL_TRUE, stride, (void *)offsetof(MeshVertex, position));
+    glEnableVertexAttribArray(location);
+
+    if (mesh.flags & MESH_HAS_NORMALS)
+    {
+        // Normal empacotada: 10 bits com sinal por coeficiente
+        location = 1;             // "(location = 1)" em "shader_vertex.glsl"
+        number_of_dimensions = 4; // GL_INT_2_10_10_10_REV exige 4 coeficientes
+        glVertexAttribPointer(location, number_of_dimensions, GL_INT_2_10_10_10_REV, GL_TRUE, stride, (void *)offsetof(MeshVertex, normal));
+        glEnableVertexAttribArray(location);
+    }
+
+    if (mesh.flags & MESH_HAS_TEXCOORDS)
+    {
+        location = 2;             // "(location = 2)" em "shader_vertex.glsl"
+        number_of_dimensions = 2; // vec2 em "shader_vertex.glsl"
+        glVertexAttribPointer(location, number_of_dimensions, GL_HALF_FLOAT, GL_FALSE, stride, (void *)offsetof(MeshVertex, texcoords));
+        glEnableVertexAttribArray(location);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    GLuint indices_id;
+    glGenBuffers(1, &indices_id);
+
+    // "Ligamos" o buffer. Note que o tipo agora é GL_ELEMENT_ARRAY_BUFFER.
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indices_id);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.index_bytes, mesh.indices, GL_STATIC_DRAW);
+    glBindVertexArray(0);
+
+    return first_object_id;
+}
+
+// Lê o código de um shader de um arquivo GLSL. As linhas de "defines" são
+// inseridas logo após a diretiva "#version", que deve ser a primeira do
+// arquivo.
+std::string LoadShaderSource(const char *filename, const char *defines)
+{
+    // Lemos o arquivo de texto indicado pela variável "filename"
+    // e colocamos seu conteúdo em memória, apontado pela variável
+    // "shader_string".
+    std::ifstream file;
+    try
+    {
+        file.exceptions(std::ifstream::failbit);
+        file.open(filename);
+    }
+    catch (std::exception &e)
+    {
+        fprintf(stderr, "ERROR: Cannot open file \"%s\".\n", filename);
+        ExitWithError();
+    }
+    std::stringstream shader;
+    shader << file.rdbuf();
+    return InsertShaderDefines(shader.str(), defines);
+}
+
+// Insere as linhas de "defines" no código "source" de um shader, logo após
+// a diretiva "#version", que deve ser a primeira do arquivo.
+std::string InsertShaderDefines(const std::string &source, const char *defines)
+{
+    std::string str = source;
+    if (defines != NULL && defines[0] != '\0')
+    {
+        // "#line" mantém os números de linha das mensagens de erro iguais
+        // aos do arquivo
+        size_t version_end = str.find('\n');
+        if (version_end != std::string::npos)
+            str.insert(version_end + 1, std::string(defines) + "#line 2\n");
+    }
+    return str;
+}
+
+// Compila o código "str" de um shader. "filename" é utilizado somente nas
+// mensagens de erro.
+void CompileShader(GLuint shader_id, const std::string &str, const char *filename)
+{
+    const GLchar *shader_string = str.c_str();
+    const GLint shader_string_length = static_cast<GLint>(str.length());
+
+    // Define o código do shader GLSL, contido na string "shader_string"
+    glShaderSource(shader_id, 1, &shader_string, &shader_string_length);
+
+    // Compila o código do shader GLSL (em tempo de execução)
+    glCompileShader(shader_id);
+
+    // Verificamos se ocorreu algum erro ou "warning" durante a compilação
+    GLint compiled_ok;
+    glGetShaderiv(shader_id, GL_COMPILE_STATUS, &compiled_ok);
+
+    GLint log_length = 0;
+    glGetShaderiv(shader_id, GL_INFO_LOG_LENGTH, &log_length);
+
+    // Alocamos memória para guardar o log de compilação.
+    // A chamada "new" em C++ é equivalente ao "malloc()" do C.
+    GLchar *log = new GLchar[log_length];
+    glGetShaderInfoLog(shader_id, log_length, &log_length, log);
+
+    // Imprime no terminal qualquer erro ou "warning" de compilação
+    if (log_length != 0)
+    {
+        std::string output;
+
+        if (!compiled_ok)
+        {
+            output += "ERROR: OpenGL compilation of \"";
+            output += filename;
+            output += "\" failed.\n";
+            output += "== Start of compilation log\n";
+            output += log;
+            output += "== End of compilation log\n";
+        }
+        else
+        {
+            output += "WARNING: OpenGL compilation of \"";
+            output += filename;
+            output += "\".\n";
+            output += "== Start of compilation log\n";
+            output += log;
+            output += "== End of compilation log\n";
+        }
+
+        fprintf(stderr, "%s", output.c_str());
+    }
+
+    // A chamada "delete" em C++ é equivalente ao "free()" do C
+    delete[] log;
+}
+
+// Esta função cria um programa de GPU, o qual contém obrigatoriamente um
+// Vertex Shader e um Fragment Shader.
+GLuint CreateGpuProgram(GLuint vertex_shader_id, GLuint fragment_shader_id, const char *cache_filename, uint64_t cache_key)
+{
+    // Criamos um identificador (ID) para este programa de GPU
+    GLuint program_id = glCreateProgram();
+
+    // Definição dos dois shaders GLSL que devem ser executados pelo programa
+    glAttachShader(program_id, vertex_shader_id);
+    glAttachShader(program_id, fragment_shader_id);
+
+    // Pedimos ao driver que guarde o binário do programa, para o cache
+    bool store_in_cache = cache_filename != NULL && ProgramCache_Supported();
+    if (store_in_cache)
+        glProgramParameteri(program_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
+    // Linkagem dos shaders acima ao programa
+    glLinkProgram(program_id);
+
+    // Verificamos se ocorreu algum erro durante a linkagem
+    GLint linked_ok = GL_FALSE;
+    glGetProgramiv(program_id, GL_LINK_STATUS, &linked_ok);
+
+    // Imprime no terminal qualquer erro de linkagem
+    if (linked_ok == GL_FALSE)
+    {
+        GLint log_length = 0;
+        glGetProgramiv(program_id, GL_INFO_LOG_LENGTH, &log_length);
+
+        // Alocamos memória para guardar o log de compilação.
+        // A chamada "new" em C++ é equivalente ao "malloc()" do C.
+        GLchar *log = new GLchar[log_length];
+
+        glGetProgramInfoLog(program_id, log_length, &log_length, log);
+
+        std::string output;
+
+        output += "ERROR: OpenGL linking of program failed.\n";
+        output += "== Start of link log\n";
+        output += log;
+        output += "\n== End of link log\n";
+
+        // A chamada "delete" em C++ é equivalente ao "free()" do C
+        delete[] log;
+
+        fprintf(stderr, "%s", output.c_str());
+    }
+    else if (store_in_cache)
+        ProgramCache_Store(cache_filename, cache_key, program_id);
+
+    // Os "Shader Objects" podem ser marcados para deleção após serem linkados
+    glDeleteShader(vertex_shader_id);
+    glDeleteShader(fragment_shader_id);
+
+    // Retornamos o ID gerado acima
+    return program_id;
+}
@@ -1,9 +1,17 @@
 #version 330 core
 
+// Materiais. Veja LoadShadersFromFiles() em "scene.cpp", que compila uma
+// variante destes shaders para cada material, com "#define MATERIAL n".
+#define ASTEROID 0
+#define SPACESHIP 1
+#define SPHERE 2
+#define COIN 3
+#define MOON 4
+
 // Atributos de fragmentos recebidos como entrada ("in") pelo Fragment Shader.
 // Neste exemplo, este atributo foi gerado pelo rasterizador como a
 // interpolação da posição global e a normal de cada vértice, definidas em
-// "shader_vertex.glsl" e "main.cpp".
+// "shader_vertex.glsl" e "scene.cpp".
 in vec4 position_world;
 in vec4 normal;
 
@@ -13,26 +21,31 @@ in vec4 position_model;
 // Coordenadas de textura obtidas do arquivo OBJ (se existirem!)
 in vec2 texcoords;
 
+#if MATERIAL == COIN
 in vec4 gouraud;
+#endif
 
-// Matrizes computadas no código C++ e enviadas para a GPU
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
-
-// Identificador que define qual objeto está sendo desenhado no momento
-#define ASTEROID 0
-#define SPACESHIP  1
-#define SPHERE 2
-#define COIN 3
-#define MOON 4
-
-
-uniform int object_id;
-
-// Parâmetros da axis-aligned bounding box (AABB) do modelo
-uniform vec4 bbox_min;
-uniform vec4 bbox_max;
+// Matrizes computadas no código C++ e enviadas para a GPU. Os blocos devem
+// ser idênticos aos de "shader_vertex.glsl".
+layout (std140) uniform FrameUniforms
+{
+    mat4 view;
+    mat4 projection;
+    mat4 view_inverse;
+    vec4 camera_position;
+    vec4 light_position;
+    vec4 light_direction;
+};
+
+// Dados do objeto sendo desenhado. Veja ObjectUniforms em "scene.cpp".
+layout (std140) uniform ObjectUniforms
+{
+    mat4 model;
+    mat4 normal_matrix; // inverse(transpose(model)), calculada na CPU
+    vec4 bbox_min;
+    vec4 bbox_max;
+    int instanced;
+};
 
 // Variáveis para acesso das imagens de textura
 uniform sampler2D TextureImage0;
@@ -51,10 +64,9 @@ out vec4 color;
 
 void main()
 {
-    // Obtemos a posição da câmera utilizando a inversa da matriz que define o
-    // sistema de coordenadas da câmera.
-    vec4 origin = vec4(0.0, 0.0, 0.0, 1.0);
-    vec4 camera_position = inverse(view) * origin;
+    // A posição da câmera, obtida com a inversa da matriz que define o
+    // sistema de coordenadas da câmera, é calculada uma vez por quadro na
+    // CPU (veja Scene_Draw()).
 
     // O fragmento atual é coberto por um ponto que percente à superfície de um
     // dos objetos virtuais da cena. Este ponto, p, possui uma posição no
@@ -68,7 +80,7 @@ void main()
     vec4 n = normalize(normal);
 
     // Vetor que define o sentido da fonte de luz em relação ao ponto atual.
-    vec4 light_pos = normalize(vec4(-200.0,-3.0,3.0,0.0));
+    vec4 light_pos = light_direction;
 
     vec4 l = normalize(light_pos - position_world);
 
@@ -96,7 +108,8 @@ void main()
     vec3 Ka; // Refletância ambiente
     int  q;  // Expoente especular para o modelo de iluminação de Blinn-Phong
 
-    if ( object_id == ASTEROID )
+    // Somente o código do material deste programa é compilado
+#if MATERIAL == ASTEROID
     {
         // Coordenadas de textura do plano, obtidas do arquivo OBJ.
         U = texcoords.x;
@@ -116,7 +129,7 @@ void main()
         color.rgb = lambert + ambient_term + BlinnPhong_term;
 
     }
-    else if ( object_id == SPHERE )
+#elif MATERIAL == SPHERE
     {
         // Coordenadas de textura do plano, obtidas do arquivo OBJ.
         U = texcoords.x;
@@ -140,7 +153,7 @@ void main()
         color.rgb = Kd0;
 
     }
-    else if ( object_id == MOON )
+#elif MATERIAL == MOON
     {
         // Coordenadas de textura do plano, obtidas do arquivo OBJ.
         U = texcoords.x;
@@ -176,7 +189,7 @@ void main()
         color.rgb = lambert + ambient_term + BlinnPhong_term;
 
     }
-    else if ( object_id == SPACESHIP )
+#elif MATERIAL == SPACESHIP
     {
         // Coordenadas de textura do plano, obtidas do arquivo OBJ.
         U = texcoords.x;
@@ -194,10 +207,11 @@ void main()
         color.rgb = ambient_term + lambert + Ks*I*max(0,dot(r,v));
 
     }
-    else if ( object_id == COIN )
+#elif MATERIAL == COIN
     {
         color = gouraud;
     }
+#endif
 
     color.a = 1;
     color.rgb = pow(color.rgb, vec3(1.0,1.0,1.0)/2.2);
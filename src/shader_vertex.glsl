@@ -1,15 +1,52 @@
 #version 330 core
 
+// Materiais. Veja LoadShadersFromFiles() em "scene.cpp", que compila uma
+// variante destes shaders para cada material, com "#define MATERIAL n".
+#define ASTEROID 0
+#define SPACESHIP 1
+#define SPHERE 2
+#define COIN 3
+#define MOON 4
+
 // Atributos de vértice recebidos como entrada ("in") pelo Vertex Shader.
-// Veja a função BuildTrianglesAndAddToVirtualScene() em "main.cpp".
-layout (location = 0) in vec4 model_coefficients;
-layout (location = 1) in vec4 normal_coefficients;
+// Veja as funções BuildTriangles() e AddMeshToVirtualScene() em "scene.cpp".
+// Os atributos chegam quantizados (veja MeshVertex em "meshcache.h"): a
+// posição normalizada em [0, 1] dentro da AABB do objeto, a normal com 10
+// bits por coeficiente e as coordenadas de textura em half float.
+layout (location = 0) in vec3 position_quantized;
+layout (location = 1) in vec3 normal_quantized;
 layout (location = 2) in vec2 texture_coefficients;
 
-// Matrizes computadas no código C++ e enviadas para a GPU
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+// Matriz de modelagem de cada instância (ocupa as localizações 3 a 6) e a
+// sua matriz de normais (localizações 7 a 10), utilizadas no lugar de
+// "model" e "normal_matrix" quando "instanced" é verdadeiro. Veja
+// LoadAsteroids() em "scene.cpp".
+layout (location = 3) in mat4 instance_model;
+layout (location = 7) in mat4 instance_normal_matrix;
+
+// Matrizes computadas no código C++ e enviadas para a GPU, em blocos
+// enviados uma vez por quadro e uma vez por objeto por Scene_Draw() em
+// "scene.cpp". A AABB do modelo é utilizada para reconstruir a posição dos
+// vértices.
+layout (std140) uniform FrameUniforms
+{
+    mat4 view;
+    mat4 projection;
+    mat4 view_inverse;
+    vec4 camera_position;
+    vec4 light_position;
+    vec4 light_direction;
+};
+
+// Dados do objeto sendo desenhado. Veja ObjectUniforms em "scene.cpp".
+layout (std140) uniform ObjectUniforms
+{
+    mat4 model;
+    mat4 normal_matrix; // inverse(transpose(model)), calculada na CPU
+    vec4 bbox_min; // Parâmetros da axis-aligned bounding box (AABB) do modelo
+    vec4 bbox_max;
+    int instanced;
+};
 
 // Atributos de vértice que serão gerados como saída ("out") pelo Vertex Shader.
 // ** Estes serão interpolados pelo rasterizador! ** gerando, assim, valores
@@ -19,26 +56,38 @@ out vec4 position_world;
 out vec4 position_model;
 out vec4 normal;
 out vec2 texcoords;
+
+#if MATERIAL == COIN
+// Cor calculada por vértice (sombreamento de Gouraud), utilizada somente
+// pelas moedas
 out vec4 gouraud;
 
-uniform vec4 light_pos;
 uniform sampler2D TextureImage3;
+#endif
 
 void main()
 {
+    // Reconstruímos a posição e a normal do vértice em coordenadas locais do
+    // modelo, com os coeficientes W de pontos (1) e vetores (0).
+    vec4 model_coefficients = vec4(mix(bbox_min.xyz, bbox_max.xyz, position_quantized), 1.0);
+    vec4 normal_coefficients = vec4(normal_quantized, 0.0);
+
+    // Matriz de modelagem do objeto: uniforme ou por instância.
+    mat4 model_matrix = (instanced != 0) ? instance_model : model;
+
     // A variável gl_Position define a posição final de cada vértice
     // OBRIGATORIAMENTE em "normalized device coordinates" (NDC), onde cada
     // coeficiente estará entre -1 e 1 após divisão por w.
     // Veja {+NDC2+}.
     //
-    // O código em "main.cpp" define os vértices dos modelos em coordenadas
+    // O código em "scene.cpp" define os vértices dos modelos em coordenadas
     // locais de cada modelo (array model_coefficients). Abaixo, utilizamos
     // operações de modelagem, definição da câmera, e projeção, para computar
     // as coordenadas finais em NDC (variável gl_Position). Após a execução
     // deste Vertex Shader, a placa de vídeo (GPU) fará a divisão por W. Veja
     // slides 41-67 e 69-86 do documento Aula_09_Projecoes.pdf.
 
-    gl_Position = projection * view * model * model_coefficients;
+    gl_Position = projection * view * model_matrix * model_coefficients;
 
     // Como as variáveis acima  (tipo vec4) são vetores com 4 coeficientes,
     // também é possível acessar e modificar cada coeficiente de maneira
@@ -55,22 +104,21 @@ void main()
     // rasterizador para gerar atributos únicos para cada fragmento gerado.
 
     // Posição do vértice atual no sistema de coordenadas global (World).
-    position_world = model * model_coefficients;
+    position_world = model_matrix * model_coefficients;
 
     // Posição do vértice atual no sistema de coordenadas local do modelo.
     position_model = model_coefficients;
 
     // Normal do vértice atual no sistema de coordenadas global (World).
     // Veja slides 123-151 do documento Aula_07_Transformacoes_Geometricas_3D.pdf.
-    normal = inverse(transpose(model)) * normal_coefficients;
+    // A inversa da transposta é calculada na CPU, uma vez por objeto.
+    normal = ((instanced != 0) ? instance_normal_matrix : normal_matrix) * normal_coefficients;
     normal.w = 0.0;
 
     // Coordenadas de textura obtidas do arquivo OBJ (se existirem!)
     texcoords = texture_coefficients;
 
-    vec4 origin = vec4(0.0, 0.0, 0.0, 1.0);
-    vec4 camera_position = inverse(view) * origin;
-
+#if MATERIAL == COIN
     // Espectro da fonte de iluminação
     vec3 I = vec3(1.0,1.0,1.0); // espectro da fonte de luz
 
@@ -86,7 +134,7 @@ void main()
 
     // Vetor que define o sentido da câmera em relação ao ponto atual.
     vec4 v = normalize(camera_position - position_world);
-    vec4 l = normalize(light_pos - position_world);
+    vec4 l = normalize(light_position - position_world);
     vec4 n = normalize(normal);
     vec4 r = -l+(2*n*(dot(n,l)));
 
@@ -96,5 +144,6 @@ void main()
 
     // Avaliar equação do modelo de iluminação:
     gouraud.rgb = ambient_term + lambert + Ks*I*max(0,dot(r,v));
+#endif
 }
 
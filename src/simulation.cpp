@@ -0,0 +1,283 @@
+#include "simulation.h"
+
+#include <cmath>
+
+#include <glm/glm.hpp>
+
+#include "profiler.h"
+
+// Reação de cada corpo do mundo de colisões ao colidir com a nave: obstáculos
+// reiniciam o jogo e moedas são coletadas ("user_data" é o índice da moeda).
+#define BODY_OBSTACLE 0
+#define BODY_COIN 1
+
+// Adiciona as HitBoxes fixas do nível no mundo de colisões. As HitBoxes ficam
+// no dobro das coordenadas em que os objetos são desenhados, assim como a
+// HitBox da nave (veja Simulation_SpaceshipHitBox()).
+static void LoadLevelHitBoxes(CollisionWorld *world)
+{
+    // Asteroid0
+    glm::vec3 AsteroidDimensions = glm::vec3(4.0f, 4.0f, 3.0f);
+    glm::vec3 BackLeft = glm::vec3(0.0f, -5.0f, -12.5f) - AsteroidDimensions * 0.5f;
+    glm::vec3 FrontRight = glm::vec3(0.0f, -5.0f, -12.5f) + AsteroidDimensions * 0.5f;
+    CollisionWorld_AddBox(world, {BackLeft, FrontRight}, BODY_OBSTACLE, 0);
+
+    // Asteroid1
+    AsteroidDimensions = glm::vec3(7.0f, 3.5f, 3.0f);
+    BackLeft = glm::vec3(10.5f, -3.0f, -30.f) - AsteroidDimensions * 0.5f;
+    FrontRight = glm::vec3(10.5f, -2.25f, -30.0f) + AsteroidDimensions * 0.5f;
+    CollisionWorld_AddBox(world, {BackLeft, FrontRight}, BODY_OBSTACLE, 1);
+
+    // Asteroid2
+    AsteroidDimensions = glm::vec3(4.0f, 2.0f, 3.0f);
+    BackLeft = glm::vec3(1.0f, -0.80f, -22.0) - AsteroidDimensions * 0.5f;
+    FrontRight = glm::vec3(1.0f, -0.80f, -22.0) + AsteroidDimensions * 0.5f;
+    CollisionWorld_AddBox(world, {BackLeft, FrontRight}, BODY_OBSTACLE, 2);
+
+    // Asteroid3
+    AsteroidDimensions = glm::vec3(4.0f, 2.0f, 3.0f);
+    BackLeft = glm::vec3(1.5f, 5.0f, -20.0) - AsteroidDimensions * 0.5f;
+    FrontRight = glm::vec3(1.5f, 5.0f, -20.0) + AsteroidDimensions * 0.5f;
+    CollisionWorld_AddBox(world, {BackLeft, FrontRight}, BODY_OBSTACLE, 3);
+
+    // Asteroid4
+    AsteroidDimensions = glm::vec3(4.0f, 5.0f, 3.0f);
+    BackLeft = glm::vec3(-4.5f, 2.0f, -15.0) - AsteroidDimensions * 0.5f;
+    FrontRight = glm::vec3(-4.5f, 2.0f, -15.0) + AsteroidDimensions * 0.5f;
+    CollisionWorld_AddBox(world, {BackLeft, FrontRight}, BODY_OBSTACLE, 4);
+
+    // Asteroid5
+    AsteroidDimensions = glm::vec3(7.0f, 1.5f, 3.5f);
+    BackLeft = glm::vec3(-7.0f, -3.9f, -27.0) - AsteroidDimensions * 0.5f;
+    FrontRight = glm::vec3(-7.0f, -1.5f, -27.0) + AsteroidDimensions * 0.5f;
+    CollisionWorld_AddBox(world, {BackLeft, FrontRight}, BODY_OBSTACLE, 5);
+
+    // Moedas. Moedas já coletadas continuam no mundo; colidir com elas
+    // novamente não tem efeito.
+    glm::vec3 CoinCenters[SIMULATION_NUM_COINS] = {
+        glm::vec3(0.0f, -1.75f, -14.5f),
+        glm::vec3(0.0f, 2.0f, -29.0f),
+        glm::vec3(5.0f, -6.0f, -36.5f),
+    };
+    glm::vec3 CoinDimensions = glm::vec3(3.5f, 1.5f, 2.0f);
+
+    for (int i = 0; i < SIMULATION_NUM_COINS; ++i)
+        CollisionWorld_AddBox(world, {CoinCenters[i] - CoinDimensions, CoinCenters[i] + CoinDimensions}, BODY_COIN, i);
+
+    // Lua
+    HitSphere MoonHitSphere = {glm::vec3(20.0f, 20.0f, -20.0f), 8.0};
+    CollisionWorld_AddSphere(world, MoonHitSphere, BODY_OBSTACLE, 0);
+}
+
+void Simulation_Init(Simulation *sim, glm::vec3 asteroid_bbox_min, glm::vec3 asteroid_bbox_max)
+{
+    SimulationState &state = sim->current;
+    state.tick = 0;
+    state.time = 0.0;
+    state.displacement = glm::vec4(0.0f, 0.0f, 0.0f, 0.0f);
+    state.angle_z = 0.0f;
+    for (int i = 0; i < SIMULATION_NUM_COINS; ++i)
+        state.coin_visible[i] = true;
+    state.bezier_start = -1.0;
+    state.bezier_visible = false;
+    state.bezier_position = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    state.crashes = 0;
+    sim->previous = state;
+
+    sim->accumulator = 0.0;
+    sim->universe_limit = 50.0f;
+    sim->bezier_body = -1;
+    sim->asteroid_bbox_min = asteroid_bbox_min;
+    sim->asteroid_bbox_max = asteroid_bbox_max;
+
+    // A célula da grade tem a ordem de grandeza das HitBoxes dos asteroides
+    CollisionWorld_Init(&sim->world, 8.0f);
+    LoadLevelHitBoxes(&sim->world);
+}
+
+void Simulation_Free(Simulation *sim)
+{
+    CollisionWorld_Free(&sim->world);
+}
+
+HitBox Simulation_SpaceshipHitBox(glm::vec4 displacement)
+{
+    // A nave é desenhada na posição "displacement", mas sua HitBox é somada
+    // ao deslocamento novamente, ficando no dobro das coordenadas de desenho.
+    glm::vec3 spaceship_position = glm::vec3(displacement.x, displacement.y, displacement.z);
+    glm::vec3 SpaceshipDimensions = glm::vec3(0.2f, 0.2f, 1.0);
+    glm::vec3 BackLeft = spaceship_position - SpaceshipDimensions * 0.5f + spaceship_position;
+    glm::vec3 FrontRight = spaceship_position + SpaceshipDimensions * 0.5f + spaceship_position;
+    return {BackLeft, FrontRight};
+}
+
+// Atualiza o asteroide que percorre a curva de Bezier em 10 segundos. Entre
+// duas passagens ele fica fora de cena durante um passo.
+static void UpdateBezierAsteroid(Simulation *sim)
+{
+    SimulationState &state = sim->current;
+
+    // pontos da curva de Bezier
+    const glm::vec4 p1Bezier = glm::vec4(-200, -100, -100, 1);
+    const glm::vec4 p2Bezier = glm::vec4(-100, 100, -80, 1);
+    const glm::vec4 p3Bezier = glm::vec4(80, 80, -80, 1);
+    const glm::vec4 p4Bezier = glm::vec4(150, -120, -60, 1);
+
+    if (state.bezier_start < 0.0)
+    {
+        // Inicia uma nova passagem
+        state.bezier_start = state.time;
+        state.bezier_visible = false;
+        return;
+    }
+
+    // t precisa estar em um intervalo entre 0 e 1
+    float t = (float)((state.time - state.bezier_start) / 10.0);
+    if (t >= 1.0f)
+    {
+        // O asteroide sai de cena até reiniciar a curva
+        state.bezier_start = -1.0;
+        state.bezier_visible = false;
+        if (sim->bezier_body >= 0)
+            CollisionWorld_Remove(&sim->world, sim->bezier_body);
+        sim->bezier_body = -1;
+        return;
+    }
+
+    // Seguimos formula
+    state.bezier_position = (float)(pow(1 - t, 3)) * p1Bezier + (float)(3 * t * pow(1 - t, 2)) * p2Bezier + (float)(3 * pow(t, 2) * (1 - t)) * p3Bezier + (float)(pow(t, 3)) * p4Bezier;
+    state.bezier_visible = true;
+
+    // HitBox do asteroide, que acompanha a curva
+    glm::vec3 BezierCenter = 2.0f * glm::vec3(state.bezier_position.x, state.bezier_position.y, state.bezier_position.z);
+    glm::vec3 BezierHalfSize = SIMULATION_BEZIER_SCALE * (sim->asteroid_bbox_max - sim->asteroid_bbox_min);
+    HitBox BezierHitBox = {BezierCenter - BezierHalfSize, BezierCenter + BezierHalfSize};
+    if (sim->bezier_body < 0)
+        sim->bezier_body = CollisionWorld_AddBox(&sim->world, BezierHitBox, BODY_OBSTACLE, 0);
+    else
+        CollisionWorld_MoveBox(&sim->world, sim->bezier_body, BezierHitBox);
+}
+
+void Simulation_Tick(Simulation *sim, const SimulationInput &input)
+{
+    const float dt = 1.0f / SIMULATION_TICK_RATE;
+    const float speed = 3.5f;             // Velocidade da nave
+    const float delta = 3.141592f / 8.0f; // Variável na rotação da spaceship
+
+    sim->previous = sim->current;
+    SimulationState &state = sim->current;
+    state.tick += 1;
+    state.time += dt;
+
+    // A nave se move na direção para onde a câmera está virada, definida
+    // pelos ângulos em coordenadas esféricas (igual nas câmeras de 1a e de
+    // 3a pessoa), e lateralmente no plano perpendicular ao vetor "up".
+    float x = cos(input.camera_phi) * sin(input.camera_theta);
+    float y = -(sin(input.camera_phi));
+    float z = cos(input.camera_phi) * cos(input.camera_theta);
+    glm::vec3 forward = glm::vec3(-x, y, -z);
+    glm::vec3 left = glm::normalize(glm::cross(glm::vec3(0.0f, 1.0f, 0.0f), forward));
+
+    glm::vec3 movement = glm::vec3(0.0f, 0.0f, 0.0f);
+    if (input.forward)
+        movement += forward;
+    if (input.backward)
+        movement -= forward;
+    if (input.left)
+        movement += left;
+    if (input.right)
+        movement -= left;
+    state.displacement += glm::vec4(movement * speed * dt, 0.0f);
+
+    if (input.reset_roll)
+        state.angle_z = 0.0f;
+    if (input.roll)
+        state.angle_z += delta * dt * 40;
+
+    UpdateBezierAsteroid(sim);
+
+    // Buscamos no mundo de colisões somente os corpos que colidem com a
+    // nave; moedas são coletadas e obstáculos reiniciam o jogo.
+    HitBox SpaceshipHitBox = Simulation_SpaceshipHitBox(state.displacement);
+    bool crashed;
+    {
+        PROFILE_SCOPE(PROFILER_COLLISION);
+        crashed = SpaceshipUniverseCollision(SpaceshipHitBox, sim->universe_limit);
+
+        sim->collisions.clear();
+        CollisionWorld_Collide(&sim->world, SpaceshipHitBox, &sim->collisions);
+    }
+    for (size_t i = 0; i < sim->collisions.size(); ++i)
+    {
+        const CollisionBody &body = sim->world.bodies[sim->collisions[i]];
+        if (body.kind == BODY_COIN)
+            state.coin_visible[body.user_data] = false;
+        else
+            crashed = true;
+    }
+
+    // Se houver colisão com algum asteróide, lua ou com o "universo"
+    if (crashed)
+    {
+        // Spaceship retorna para origem
+        state.displacement = glm::vec4(0.0f, 0.0f, 0.0f, 0.0f);
+
+        // Colocamos coins novamente no mapa
+        for (int i = 0; i < SIMULATION_NUM_COINS; ++i)
+            state.coin_visible[i] = true;
+
+        state.crashes += 1;
+    }
+}
+
+int Simulation_Advance(Simulation *sim, double frame_seconds, const SimulationInput &input)
+{
+    const double dt = 1.0 / SIMULATION_TICK_RATE;
+
+    sim->accumulator += frame_seconds;
+
+    SimulationInput tick_input = input;
+    int ticks = 0;
+    while (sim->accumulator >= dt && ticks < SIMULATION_MAX_TICKS_PER_FRAME)
+    {
+        unsigned int crashes = sim->current.crashes;
+        Simulation_Tick(sim, tick_input);
+        sim->accumulator -= dt;
+        ticks += 1;
+
+        // Eventos são aplicados uma única vez, e a câmera volta para a
+        // posição inicial após uma colisão.
+        tick_input.reset_roll = false;
+        if (sim->current.crashes != crashes)
+        {
+            tick_input.camera_theta = 0.0f;
+            tick_input.camera_phi = 0.0f;
+        }
+    }
+
+    // Descartamos o tempo que não pôde ser simulado neste quadro
+    if (sim->accumulator >= dt)
+        sim->accumulator = fmod(sim->accumulator, dt);
+
+    return ticks;
+}
+
+SimulationState Simulation_Interpolate(const Simulation *sim)
+{
+    const SimulationState &previous = sim->previous;
+    SimulationState state = sim->current;
+    float alpha = (float)(sim->accumulator * SIMULATION_TICK_RATE);
+
+    // Não interpolamos saltos: a nave voltando para a origem após uma
+    // colisão, ou o asteroide recomeçando a curva.
+    if (previous.crashes == state.crashes)
+        state.displacement = glm::mix(previous.displacement, state.displacement, alpha);
+
+    if (previous.bezier_visible && state.bezier_visible && previous.bezier_start == state.bezier_start)
+        state.bezier_position = glm::mix(previous.bezier_position, state.bezier_position, alpha);
+
+    state.angle_z = glm::mix(previous.angle_z, state.angle_z, alpha);
+    state.time = previous.time + (state.time - previous.time) * alpha;
+
+    return state;
+}
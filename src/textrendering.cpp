@@ -1,17 +1,22 @@
 // Based on http://hamelot.io/visualization/opengl-text-without-any-external-libraries/
 //   and on https://github.com/rougier/freetype-gl
+#include <cstdint>
+#include <cstring>
 #include <string>
+#include <vector>
+#include <algorithm>
 
 #include <glad/glad.h>
-#include <GLFW/glfw3.h>
 
 #include <glm/mat4x4.hpp>
 #include <glm/vec4.hpp>
 
 #include "utils.h"
 #include "dejavufont.h"
+#include "textrendering.h"
 
-GLuint CreateGpuProgram(GLuint vertex_shader_id, GLuint fragment_shader_id); // Função definida em main.cpp
+GLuint CreateGpuProgram(GLuint vertex_shader_id, GLuint fragment_shader_id,
+                        const char *cache_filename = NULL, uint64_t cache_key = 0); // Função definida em scene.cpp
 
 const GLchar* const textvertexshader_source = ""
 "#version 330\n"
@@ -31,7 +36,7 @@ const GLchar* const textfragmentshader_source = ""
 "out vec4 fragColor;\n"
 "void main()\n"
 "{\n"
-    "fragColor = vec4(0, 0, 0, texture(tex, texCoords).r);\n"
+    "fragColor = vec4(1, 1, 1, texture(tex, texCoords).r);\n"
 "}\n"
 "\0";
 
@@ -87,6 +92,37 @@ GLuint textVBO;
 GLuint textprogram_id;
 GLuint texttexture_id;
 
+// Capacidade do VBO de texto, em caracteres. Textos maiores são desenhados
+// em mais de uma chamada.
+#define TEXT_BUFFER_GLYPHS 8192
+#define TEXT_VERTICES_PER_GLYPH 6
+
+// Caracteres acumulados por TextRendering_PrintString() desde o último
+// TextRendering_Flush()
+std::vector<TextVertex> g_TextBatch;
+
+// Próximo vértice livre do VBO de texto. O VBO é preenchido em sequência ao
+// longo dos quadros, e só é realocado ("orphaning") quando enche, para que
+// não seja preciso esperar a GPU terminar de ler os caracteres anteriores.
+size_t g_TextBufferOffset = 0;
+
+// Número de chamadas de desenho feitas por TextRendering_Flush()
+unsigned long g_TextDrawCalls = 0;
+
+// Glifos indexados diretamente pelo codepoint, para ASCII e Latin-1.
+// Construída por TextRendering_BuildGlyphTable().
+#define TEXT_GLYPH_TABLE_SIZE 256
+const texture_glyph_t *g_GlyphTable[TEXT_GLYPH_TABLE_SIZE];
+
+// Glifos dos demais codepoints, ordenados pelo codepoint para busca binária
+std::vector<std::pair<uint32_t, const texture_glyph_t *> > g_GlyphFallback;
+
+// A fonte embutida contém somente os caracteres ASCII. As letras acentuadas
+// de Latin-1 (U+00C0 a U+00FF) sem glifo próprio são desenhadas com a letra
+// sem acento, para que textos em português continuem legíveis.
+static const char latin1_fold[] = "AAAAAAACEEEEIIIIDNOOOOOxOUUUUYTs"
+                                  "aaaaaaaceeeeiiiidnooooo/ouuuuyty";
+
 void TextRendering_Init()
 {
     GLuint sampler;
@@ -127,7 +163,7 @@ void TextRendering_Init()
     glBindVertexArray(textVAO);
 
     glBindBuffer(GL_ARRAY_BUFFER, textVBO);
-    glBufferData(GL_ARRAY_BUFFER, 24 * sizeof(float), NULL, GL_DYNAMIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, TEXT_BUFFER_GLYPHS * TEXT_VERTICES_PER_GLYPH * sizeof(TextVertex), NULL, GL_STREAM_DRAW);
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 0, 0);
     glEnableVertexAttribArray(0);
     glCheckError();
@@ -140,30 +176,226 @@ void TextRendering_Init()
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
     glCheckError();
+
+    TextRendering_BuildGlyphTable();
+
+    g_TextBatch.reserve(TEXT_BUFFER_GLYPHS * TEXT_VERTICES_PER_GLYPH);
+    g_TextBufferOffset = 0;
 }
 
-float textscale = 1.5f;
+void TextRendering_BuildGlyphTable()
+{
+    memset(g_GlyphTable, 0, sizeof(g_GlyphTable));
+    g_GlyphFallback.clear();
+
+    for (size_t j = 0; j < dejavufont.glyphs_count; ++j)
+    {
+        uint32_t codepoint = dejavufont.glyphs[j].codepoint;
+        if (codepoint < TEXT_GLYPH_TABLE_SIZE)
+        {
+            if (g_GlyphTable[codepoint] == NULL)
+                g_GlyphTable[codepoint] = &dejavufont.glyphs[j];
+        }
+        else if (codepoint != (uint32_t)-1) // -1 é o glifo "ausente" da fonte
+        {
+            g_GlyphFallback.push_back(std::make_pair(codepoint, &dejavufont.glyphs[j]));
+        }
+    }
+
+    // Espaço sem quebra e letras acentuadas sem glifo próprio
+    if (g_GlyphTable[0xA0] == NULL)
+        g_GlyphTable[0xA0] = g_GlyphTable[' '];
+    for (uint32_t codepoint = 0xC0; codepoint <= 0xFF; ++codepoint)
+        if (g_GlyphTable[codepoint] == NULL)
+            g_GlyphTable[codepoint] = g_GlyphTable[(unsigned char)latin1_fold[codepoint - 0xC0]];
+
+    std::sort(g_GlyphFallback.begin(), g_GlyphFallback.end());
+}
+
+// Glifo de um codepoint, ou NULL se a fonte não o contém
+static const texture_glyph_t *FindGlyph(uint32_t codepoint)
+{
+    if (codepoint < TEXT_GLYPH_TABLE_SIZE)
+        return g_GlyphTable[codepoint];
+
+    std::vector<std::pair<uint32_t, const texture_glyph_t *> >::const_iterator it =
+        std::lower_bound(g_GlyphFallback.begin(), g_GlyphFallback.end(),
+                         std::make_pair(codepoint, (const texture_glyph_t *)NULL));
+    if (it != g_GlyphFallback.end() && it->first == codepoint)
+        return it->second;
+    return NULL;
+}
 
-void TextRendering_PrintString(GLFWwindow* window, const std::string &str, float x, float y, float scale = 1.0f)
+// Busca linear de um glifo, como feito antes de TextRendering_BuildGlyphTable().
+// As substituições de caracteres são as mesmas da tabela, de modo que as duas
+// buscas encontrem os mesmos glifos.
+static const texture_glyph_t *FindGlyphLinear(uint32_t codepoint)
 {
-    scale *= textscale;
-    int width, height;
-    glfwGetWindowSize(window, &width, &height);
-    float sx = scale / width;
-    float sy = scale / height;
+    for (size_t j = 0; j < dejavufont.glyphs_count; ++j)
+        if (dejavufont.glyphs[j].codepoint == codepoint)
+            return &dejavufont.glyphs[j];
+
+    if (codepoint == 0xA0)
+        return FindGlyphLinear(' ');
+    if (codepoint >= 0xC0 && codepoint <= 0xFF)
+        return FindGlyphLinear((unsigned char)latin1_fold[codepoint - 0xC0]);
+    return NULL;
+}
 
-    for (size_t i = 0; i < str.size(); i++)
+// Decodifica o caractere UTF-8 que inicia em str[*i] e avança *i para o
+// próximo. Bytes que não formam uma sequência UTF-8 válida são interpretados
+// como Latin-1, já que alguns arquivos fonte do projeto usam essa codificação.
+static uint32_t DecodeUTF8(const std::string &str, size_t *i)
+{
+    unsigned char c = (unsigned char)str[*i];
+    *i += 1;
+    if (c < 0x80)
+        return c;
+
+    size_t length;
+    uint32_t codepoint;
+    if ((c & 0xE0) == 0xC0)
     {
-        // Find the glyph for the character we are looking for
-        texture_glyph_t *glyph = 0;
-        for (size_t j = 0; j < dejavufont.glyphs_count; ++j)
+        length = 1;
+        codepoint = c & 0x1F;
+    }
+    else if ((c & 0xF0) == 0xE0)
+    {
+        length = 2;
+        codepoint = c & 0x0F;
+    }
+    else if ((c & 0xF8) == 0xF0)
+    {
+        length = 3;
+        codepoint = c & 0x07;
+    }
+    else
+    {
+        return c;
+    }
+
+    if (*i + length > str.size())
+        return c;
+    for (size_t k = 0; k < length; ++k)
+    {
+        unsigned char next = (unsigned char)str[*i + k];
+        if ((next & 0xC0) != 0x80)
+            return c;
+        codepoint = (codepoint << 6) | (next & 0x3F);
+    }
+
+    // Sequências mais longas que o necessário também são inválidas
+    static const uint32_t min_codepoint[4] = {0, 0x80, 0x800, 0x10000};
+    if (codepoint < min_codepoint[length] || codepoint > 0x10FFFF)
+        return c;
+
+    *i += length;
+    return codepoint;
+}
+
+// Desenha todos os caracteres acumulados por TextRendering_PrintString(),
+// com o estado de OpenGL configurado uma única vez. Deve ser chamada uma vez
+// por quadro, após todo o texto do quadro.
+void TextRendering_Flush()
+{
+    if (g_TextBatch.empty())
+        return;
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    glDepthFunc(GL_ALWAYS);
+
+    glUseProgram(textprogram_id);
+    glBindVertexArray(textVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, textVBO);
+
+    const size_t capacity = TEXT_BUFFER_GLYPHS * TEXT_VERTICES_PER_GLYPH;
+    size_t first = 0;
+    while (first < g_TextBatch.size())
+    {
+        size_t count = std::min(g_TextBatch.size() - first, capacity);
+
+        // Se o restante do VBO não comporta os vértices, pedimos um novo
+        // bloco de memória ao driver; o bloco antigo continua válido até a
+        // GPU terminar de utilizá-lo.
+        if (g_TextBufferOffset + count > capacity)
         {
-            if (dejavufont.glyphs[j].codepoint == (uint32_t)str[i])
-            {
-                glyph = &dejavufont.glyphs[j];
-                break;
-            }
+            glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(TextVertex), NULL, GL_STREAM_DRAW);
+            g_TextBufferOffset = 0;
         }
+
+        // A região escrita nunca foi utilizada desde a última realocação,
+        // portanto não é preciso sincronizar com a GPU
+        void *data = glMapBufferRange(GL_ARRAY_BUFFER,
+                                      g_TextBufferOffset * sizeof(TextVertex),
+                                      count * sizeof(TextVertex),
+                                      GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        if (data != NULL)
+        {
+            memcpy(data, &g_TextBatch[first], count * sizeof(TextVertex));
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+            glDrawArrays(GL_TRIANGLES, (GLint)g_TextBufferOffset, (GLsizei)count);
+            g_TextDrawCalls += 1;
+        }
+
+        g_TextBufferOffset += count;
+        first += count;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+    glUseProgram(0);
+    glDepthFunc(GL_LESS);
+
+    glDisable(GL_BLEND);
+
+    g_TextBatch.clear();
+}
+
+float textscale = 1.5f;
+
+// Métricas da janela utilizadas pelas funções TextRendering_Print*()
+TextLayout g_TextLayout = TextLayout_Create(800, 600, textscale);
+
+TextLayout TextLayout_Create(int width, int height, float scale)
+{
+    TextLayout layout;
+    layout.width = std::max(width, 1);
+    layout.height = std::max(height, 1);
+    layout.scale = scale;
+    layout.sx = scale / layout.width;
+    layout.sy = scale / layout.height;
+    layout.line_height = dejavufont.height * layout.sy;
+    layout.char_width = dejavufont.glyphs[32].advance_x * layout.sx;
+    return layout;
+}
+
+void TextRendering_SetWindowSize(int width, int height)
+{
+    // Janela minimizada: mantemos as métricas anteriores
+    if (width <= 0 || height <= 0)
+        return;
+    g_TextLayout = TextLayout_Create(width, height, textscale);
+}
+
+float TextRendering_LayoutString(const TextLayout &layout, const std::string &str, float x, float y, float scale,
+                                 std::vector<TextVertex> *vertices, int lookup)
+{
+    float sx = layout.sx * scale;
+    float sy = layout.sy * scale;
+
+    size_t i = 0;
+    while (i < str.size())
+    {
+        // Find the glyph for the character we are looking for
+        uint32_t codepoint = DecodeUTF8(str, &i);
+        const texture_glyph_t *glyph;
+        if (lookup == TEXT_LOOKUP_LINEAR)
+            glyph = FindGlyphLinear(codepoint);
+        else
+            glyph = FindGlyph(codepoint);
         if (!glyph) {
             continue;
         }
@@ -178,7 +410,7 @@ void TextRendering_PrintString(GLFWwindow* window, const std::string &str, float
         float s1 = glyph->s1 - 0.5f/dejavufont.tex_width;
         float t1 = glyph->t1 - 0.5f/dejavufont.tex_height;
 
-        struct {float x, y, s, t;} data[6] = {
+        TextVertex data[TEXT_VERTICES_PER_GLYPH] = {
             { x0, y0, s0, t0 },
             { x0, y1, s0, t1 },
             { x1, y1, s1, t1 },
@@ -186,121 +418,106 @@ void TextRendering_PrintString(GLFWwindow* window, const std::string &str, float
             { x1, y1, s1, t1 },
             { x1, y0, s1, t0 }
         };
-
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-        glDepthFunc(GL_ALWAYS);
-        glBindBuffer(GL_ARRAY_BUFFER, textVBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, 24 * sizeof(float), data);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-        glUseProgram(textprogram_id);
-        glBindVertexArray(textVAO);
-
-        glDrawArrays(GL_TRIANGLES, 0, 6);
-
-        glBindVertexArray(0);
-        glUseProgram(0);
-        glDepthFunc(GL_LESS);
-
-        glDisable(GL_BLEND);
+        vertices->insert(vertices->end(), data, data + TEXT_VERTICES_PER_GLYPH);
 
         x += (glyph->advance_x * sx);
     }
+    return x;
+}
+
+// Adiciona os caracteres de "str" ao lote de texto do quadro. O texto só é
+// desenhado na próxima chamada de TextRendering_Flush().
+void TextRendering_PrintString(const std::string &str, float x, float y, float scale)
+{
+    TextRendering_LayoutString(g_TextLayout, str, x, y, scale, &g_TextBatch);
 }
 
-float TextRendering_LineHeight(GLFWwindow* window)
+float TextRendering_LineHeight()
 {
-    int width, height;
-    glfwGetWindowSize(window, &width, &height);
-    return dejavufont.height / height * textscale;
+    return g_TextLayout.line_height;
 }
 
-float TextRendering_CharWidth(GLFWwindow* window)
+float TextRendering_CharWidth()
 {
-    int width, height;
-    glfwGetWindowSize(window, &width, &height);
-    return dejavufont.glyphs[32].advance_x / width * textscale;
+    return g_TextLayout.char_width;
 }
 
-void TextRendering_PrintMatrix(GLFWwindow* window, glm::mat4 M, float x, float y, float scale = 1.0f)
+void TextRendering_PrintMatrix(glm::mat4 M, float x, float y, float scale)
 {
     char buffer[40];
-    float lineheight = TextRendering_LineHeight(window) * scale;
+    float lineheight = TextRendering_LineHeight() * scale;
 
     snprintf(buffer, 40, "[%+0.2f %+0.2f %+0.2f %+0.2f]", M[0][0], M[1][0], M[2][0], M[3][0]);
-    TextRendering_PrintString(window, buffer, x, y, scale);
+    TextRendering_PrintString(buffer, x, y, scale);
     snprintf(buffer, 40, "[%+0.2f %+0.2f %+0.2f %+0.2f]", M[0][1], M[1][1], M[2][1], M[3][1]);
-    TextRendering_PrintString(window, buffer, x, y - lineheight, scale);
+    TextRendering_PrintString(buffer, x, y - lineheight, scale);
     snprintf(buffer, 40, "[%+0.2f %+0.2f %+0.2f %+0.2f]", M[0][2], M[1][2], M[2][2], M[3][2]);
-    TextRendering_PrintString(window, buffer, x, y - 2*lineheight, scale);
+    TextRendering_PrintString(buffer, x, y - 2*lineheight, scale);
     snprintf(buffer, 40, "[%+0.2f %+0.2f %+0.2f %+0.2f]", M[0][3], M[1][3], M[2][3], M[3][3]);
-    TextRendering_PrintString(window, buffer, x, y - 3*lineheight, scale);
+    TextRendering_PrintString(buffer, x, y - 3*lineheight, scale);
 }
 
-void TextRendering_PrintVector(GLFWwindow* window, glm::vec4 v, float x, float y, float scale = 1.0f)
+void TextRendering_PrintVector(glm::vec4 v, float x, float y, float scale)
 {
     char buffer[10];
-    float lineheight = TextRendering_LineHeight(window) * scale;
+    float lineheight = TextRendering_LineHeight() * scale;
 
     snprintf(buffer, 10, "[%+0.2f]", v.x);
-    TextRendering_PrintString(window, buffer, x, y, scale);
+    TextRendering_PrintString(buffer, x, y, scale);
     snprintf(buffer, 10, "[%+0.2f]", v.y);
-    TextRendering_PrintString(window, buffer, x, y - lineheight, scale);
+    TextRendering_PrintString(buffer, x, y - lineheight, scale);
     snprintf(buffer, 10, "[%+0.2f]", v.z);
-    TextRendering_PrintString(window, buffer, x, y - 2*lineheight, scale);
+    TextRendering_PrintString(buffer, x, y - 2*lineheight, scale);
     snprintf(buffer, 10, "[%+0.2f]", v.w);
-    TextRendering_PrintString(window, buffer, x, y - 3*lineheight, scale);
+    TextRendering_PrintString(buffer, x, y - 3*lineheight, scale);
 }
 
-void TextRendering_PrintMatrixVectorProduct(GLFWwindow* window, glm::mat4 M, glm::vec4 v, float x, float y, float scale = 1.0f)
+void TextRendering_PrintMatrixVectorProduct(glm::mat4 M, glm::vec4 v, float x, float y, float scale)
 {
     char buffer[70];
-    float lineheight = TextRendering_LineHeight(window) * scale;
+    float lineheight = TextRendering_LineHeight() * scale;
 
     auto r = M*v;
     snprintf(buffer, 70, "[%+0.2f %+0.2f %+0.2f %+0.2f][%+0.2f]     [%+0.2f]\n", M[0][0], M[1][0], M[2][0], M[3][0], v[0], r[0]);
-    TextRendering_PrintString(window, buffer, x, y, scale);
+    TextRendering_PrintString(buffer, x, y, scale);
     snprintf(buffer, 70, "[%+0.2f %+0.2f %+0.2f %+0.2f][%+0.2f]     [%+0.2f]\n", M[0][1], M[1][1], M[2][1], M[3][1], v[1], r[1]);
-    TextRendering_PrintString(window, buffer, x, y - lineheight, scale);
+    TextRendering_PrintString(buffer, x, y - lineheight, scale);
     snprintf(buffer, 70, "[%+0.2f %+0.2f %+0.2f %+0.2f][%+0.2f] --> [%+0.2f]\n", M[0][2], M[1][2], M[2][2], M[3][2], v[2], r[2]);
-    TextRendering_PrintString(window, buffer, x, y - 2*lineheight, scale);
+    TextRendering_PrintString(buffer, x, y - 2*lineheight, scale);
     snprintf(buffer, 70, "[%+0.2f %+0.2f %+0.2f %+0.2f][%+0.2f]     [%+0.2f]\n", M[0][3], M[1][3], M[2][3], M[3][3], v[3], r[3]);
-    TextRendering_PrintString(window, buffer, x, y - 3*lineheight, scale);
+    TextRendering_PrintString(buffer, x, y - 3*lineheight, scale);
 }
 
-void TextRendering_PrintMatrixVectorProductMoreDigits(GLFWwindow* window, glm::mat4 M, glm::vec4 v, float x, float y, float scale = 1.0f)
+void TextRendering_PrintMatrixVectorProductMoreDigits(glm::mat4 M, glm::vec4 v, float x, float y, float scale)
 {
     char buffer[70];
-    float lineheight = TextRendering_LineHeight(window) * scale;
+    float lineheight = TextRendering_LineHeight() * scale;
 
     auto r = M*v;
     snprintf(buffer, 70, "[%5.1f %5.1f %5.1f %5.1f][%5.2f]     [%+6.1f]\n", M[0][0], M[1][0], M[2][0], M[3][0], v[0], r[0]);
-    TextRendering_PrintString(window, buffer, x, y, scale);
+    TextRendering_PrintString(buffer, x, y, scale);
     snprintf(buffer, 70, "[%5.1f %5.1f %5.1f %5.1f][%5.2f]     [%+6.1f]\n", M[0][1], M[1][1], M[2][1], M[3][1], v[1], r[1]);
-    TextRendering_PrintString(window, buffer, x, y - lineheight, scale);
+    TextRendering_PrintString(buffer, x, y - lineheight, scale);
     snprintf(buffer, 70, "[%5.1f %5.1f %5.1f %5.1f][%5.2f] --> [%+6.1f]\n", M[0][2], M[1][2], M[2][2], M[3][2], v[2], r[2]);
-    TextRendering_PrintString(window, buffer, x, y - 2*lineheight, scale);
+    TextRendering_PrintString(buffer, x, y - 2*lineheight, scale);
     snprintf(buffer, 70, "[%5.1f %5.1f %5.1f %5.1f][%5.2f]     [%+6.1f]\n", M[0][3], M[1][3], M[2][3], M[3][3], v[3], r[3]);
-    TextRendering_PrintString(window, buffer, x, y - 3*lineheight, scale);
+    TextRendering_PrintString(buffer, x, y - 3*lineheight, scale);
 }
 
-void TextRendering_PrintMatrixVectorProductDivW(GLFWwindow* window, glm::mat4 M, glm::vec4 v, float x, float y, float scale = 1.0f)
+void TextRendering_PrintMatrixVectorProductDivW(glm::mat4 M, glm::vec4 v, float x, float y, float scale)
 {
     auto r = M*v;
     auto w = r[3];
 
     char buffer[90];
-    float lineheight = TextRendering_LineHeight(window) * scale;
+    float lineheight = TextRendering_LineHeight() * scale;
 
     snprintf(buffer, 90, "[%+0.2f %+0.2f %+0.2f %+0.2f][%+0.2f]     [%+0.2f]        [%+0.2f]\n", M[0][0], M[1][0], M[2][0], M[3][0], v[0], r[0], r[0]/w);
-    TextRendering_PrintString(window, buffer, x, y, scale);
+    TextRendering_PrintString(buffer, x, y, scale);
     snprintf(buffer, 90, "[%+0.2f %+0.2f %+0.2f %+0.2f][%+0.2f]     [%+0.2f] div. w [%+0.2f]\n", M[0][1], M[1][1], M[2][1], M[3][1], v[1], r[1], r[1]/w);
-    TextRendering_PrintString(window, buffer, x, y - lineheight, scale);
+    TextRendering_PrintString(buffer, x, y - lineheight, scale);
     snprintf(buffer, 90, "[%+0.2f %+0.2f %+0.2f %+0.2f][%+0.2f] --> [%+0.2f] -----> [%+0.2f]\n", M[0][2], M[1][2], M[2][2], M[3][2], v[2], r[2], r[2]/w);
-    TextRendering_PrintString(window, buffer, x, y - 2*lineheight, scale);
+    TextRendering_PrintString(buffer, x, y - 2*lineheight, scale);
     snprintf(buffer, 90, "[%+0.2f %+0.2f %+0.2f %+0.2f][%+0.2f]     [%+0.2f]        [%+0.2f]\n", M[0][3], M[1][3], M[2][3], M[3][3], v[3], r[3], r[3]/w);
-    TextRendering_PrintString(window, buffer, x, y - 3*lineheight, scale);
+    TextRendering_PrintString(buffer, x, y - 3*lineheight, scale);
 }
@@ -0,0 +1,368 @@
+#include "texturecache.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include "cachefile.h"
+
+// Cabeçalho de um arquivo ".tex". Logo após o cabeçalho vêm os
+// "data_bytes" bytes de todos os níveis de mipmap, em sequência.
+struct TextureCacheHeader
+{
+    char magic[4];        // "SETX"
+    uint32_t version;     // TEXTURE_CACHE_VERSION
+    uint64_t source_size; // Tamanho em bytes da imagem de origem
+    int64_t source_mtime; // Data de modificação da imagem de origem (veja CacheFile_Stat())
+    uint64_t source_hash; // Hash FNV-1a do conteúdo da imagem
+    uint32_t format;      // TEXTURE_FORMAT_*
+    uint32_t width;
+    uint32_t height;
+    uint32_t num_levels;
+    uint64_t data_bytes;
+};
+
+static const char TEXTURE_CACHE_MAGIC[4] = {'S', 'E', 'T', 'X'};
+
+uint32_t TextureData_LevelDimension(uint32_t size, uint32_t level)
+{
+    uint32_t d = size >> level;
+    return d > 0 ? d : 1;
+}
+
+size_t TextureData_LevelSize(uint32_t format, uint32_t width, uint32_t height)
+{
+    if (format == TEXTURE_FORMAT_BC1)
+        return (size_t)((width + 3) / 4) * ((height + 3) / 4) * 8;
+    return (size_t)width * height * 3;
+}
+
+// Número de níveis de uma cadeia completa de mipmaps, até 1x1
+static uint32_t NumLevels(uint32_t width, uint32_t height)
+{
+    uint32_t levels = 1;
+    while (width > 1 || height > 1)
+    {
+        width = TextureData_LevelDimension(width, 1);
+        height = TextureData_LevelDimension(height, 1);
+        levels += 1;
+    }
+    return levels;
+}
+
+// Tabelas de conversão entre sRGB (8 bits) e intensidade linear. Os
+// mipmaps de uma textura GL_SRGB8 devem ser a média das cores em espaço
+// linear; calcular a média dos valores sRGB escureceria os níveis menores.
+struct SrgbTables
+{
+    float to_linear[256];
+    unsigned char from_linear[4096]; // Indexada por linear * 4095
+
+    SrgbTables()
+    {
+        for (int i = 0; i < 256; ++i)
+        {
+            float c = i / 255.0f;
+            to_linear[i] = (c <= 0.04045f) ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+        }
+        for (int i = 0; i < 4096; ++i)
+        {
+            float l = i / 4095.0f;
+            float c = (l <= 0.0031308f) ? l * 12.92f : 1.055f * powf(l, 1.0f / 2.4f) - 0.055f;
+            from_linear[i] = (unsigned char)(c * 255.0f + 0.5f);
+        }
+    }
+};
+
+static const SrgbTables &GetSrgbTables()
+{
+    // Inicializada uma única vez, mesmo com várias threads (C++11)
+    static const SrgbTables tables;
+    return tables;
+}
+
+// Reduz uma imagem RGB à metade em cada dimensão (até 1 pixel), com a média
+// de blocos de 2x2 pixels. Em dimensões ímpares a última linha ou coluna é
+// descartada, como em glGenerateMipmap() na maioria dos drivers.
+static void Downsample(const unsigned char *src, uint32_t width, uint32_t height,
+                       unsigned char *dst, uint32_t dst_width, uint32_t dst_height)
+{
+    const SrgbTables &t = GetSrgbTables();
+    for (uint32_t y = 0; y < dst_height; ++y)
+    {
+        uint32_t y0 = 2 * y < height ? 2 * y : height - 1;
+        uint32_t y1 = 2 * y + 1 < height ? 2 * y + 1 : height - 1;
+        for (uint32_t x = 0; x < dst_width; ++x)
+        {
+            uint32_t x0 = 2 * x < width ? 2 * x : width - 1;
+            uint32_t x1 = 2 * x + 1 < width ? 2 * x + 1 : width - 1;
+            const unsigned char *p00 = src + 3 * ((size_t)y0 * width + x0);
+            const unsigned char *p01 = src + 3 * ((size_t)y0 * width + x1);
+            const unsigned char *p10 = src + 3 * ((size_t)y1 * width + x0);
+            const unsigned char *p11 = src + 3 * ((size_t)y1 * width + x1);
+            unsigned char *q = dst + 3 * ((size_t)y * dst_width + x);
+            for (int c = 0; c < 3; ++c)
+            {
+                float l = 0.25f * (t.to_linear[p00[c]] + t.to_linear[p01[c]] + t.to_linear[p10[c]] + t.to_linear[p11[c]]);
+                q[c] = t.from_linear[(int)(l * 4095.0f + 0.5f)];
+            }
+        }
+    }
+}
+
+static uint16_t Pack565(const int color[3])
+{
+    return (uint16_t)(((color[0] >> 3) << 11) | ((color[1] >> 2) << 5) | (color[2] >> 3));
+}
+
+// Cor de 8 bits por canal de uma cor 5:6:5, replicando os bits mais
+// significativos, como faz a placa de vídeo
+static void Unpack565(uint16_t packed, int color[3])
+{
+    int r = (packed >> 11) & 31, g = (packed >> 5) & 63, b = packed & 31;
+    color[0] = (r << 3) | (r >> 2);
+    color[1] = (g << 2) | (g >> 4);
+    color[2] = (b << 3) | (b >> 2);
+}
+
+// Comprime um bloco de 4x4 pixels RGB no formato BC1: duas cores 5:6:5 e um
+// índice de 2 bits por pixel, que escolhe entre as duas cores e duas
+// interpolações entre elas. As cores extremas são os cantos da caixa
+// envolvente das cores do bloco, na diagonal que acompanha a correlação
+// entre os canais, aproximadas uma da outra em 1/16 para reduzir o erro
+// (J.M.P. van Waveren, "Real-Time DXT Compression", 2006).
+static void CompressBlockBC1(const unsigned char block[16][3], unsigned char out[8])
+{
+    int min[3] = {255, 255, 255};
+    int max[3] = {0, 0, 0};
+    int mean[3] = {0, 0, 0};
+    for (int i = 0; i < 16; ++i)
+    {
+        for (int c = 0; c < 3; ++c)
+        {
+            if (block[i][c] < min[c]) min[c] = block[i][c];
+            if (block[i][c] > max[c]) max[c] = block[i][c];
+            mean[c] += block[i][c];
+        }
+    }
+
+    // Canal de maior variação; os outros são invertidos na caixa se variam
+    // no sentido oposto a ele
+    int axis = 0;
+    for (int c = 1; c < 3; ++c)
+        if (max[c] - min[c] > max[axis] - min[axis])
+            axis = c;
+    for (int c = 0; c < 3; ++c)
+    {
+        if (c == axis)
+            continue;
+        int covariance = 0;
+        for (int i = 0; i < 16; ++i)
+            covariance += (16 * block[i][axis] - mean[axis]) * (16 * block[i][c] - mean[c]);
+        if (covariance < 0)
+        {
+            int tmp = min[c];
+            min[c] = max[c];
+            max[c] = tmp;
+        }
+    }
+
+    for (int c = 0; c < 3; ++c)
+    {
+        int inset = (max[c] - min[c]) / 16;
+        max[c] -= inset;
+        min[c] += inset;
+    }
+
+    uint16_t color0 = Pack565(max);
+    uint16_t color1 = Pack565(min);
+
+    // Com color0 > color1 o bloco usa quatro cores; com color0 == color1,
+    // todos os pixels usam o índice 0
+    if (color0 < color1)
+    {
+        uint16_t tmp = color0;
+        color0 = color1;
+        color1 = tmp;
+    }
+
+    uint32_t indices = 0;
+    if (color0 != color1)
+    {
+        int palette[4][3];
+        Unpack565(color0, palette[0]);
+        Unpack565(color1, palette[1]);
+        for (int c = 0; c < 3; ++c)
+        {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+
+        for (int i = 0; i < 16; ++i)
+        {
+            int best = 0;
+            int best_distance = 1 << 30;
+            for (int j = 0; j < 4; ++j)
+            {
+                int dr = block[i][0] - palette[j][0];
+                int dg = block[i][1] - palette[j][1];
+                int db = block[i][2] - palette[j][2];
+                int distance = dr * dr + dg * dg + db * db;
+                if (distance < best_distance)
+                {
+                    best = j;
+                    best_distance = distance;
+                }
+            }
+            indices |= (uint32_t)best << (2 * i);
+        }
+    }
+
+    out[0] = (unsigned char)(color0 & 0xff);
+    out[1] = (unsigned char)(color0 >> 8);
+    out[2] = (unsigned char)(color1 & 0xff);
+    out[3] = (unsigned char)(color1 >> 8);
+    out[4] = (unsigned char)(indices & 0xff);
+    out[5] = (unsigned char)((indices >> 8) & 0xff);
+    out[6] = (unsigned char)((indices >> 16) & 0xff);
+    out[7] = (unsigned char)(indices >> 24);
+}
+
+// Comprime um nível inteiro. Nas bordas de imagens com dimensões que não são
+// múltiplas de 4, os pixels que faltam no bloco repetem os da borda.
+static void CompressLevelBC1(const unsigned char *pixels, uint32_t width, uint32_t height, unsigned char *out)
+{
+    unsigned char block[16][3];
+    for (uint32_t by = 0; by < height; by += 4)
+    {
+        for (uint32_t bx = 0; bx < width; bx += 4)
+        {
+            for (uint32_t y = 0; y < 4; ++y)
+            {
+                uint32_t py = by + y < height ? by + y : height - 1;
+                for (uint32_t x = 0; x < 4; ++x)
+                {
+                    uint32_t px = bx + x < width ? bx + x : width - 1;
+                    memcpy(block[4 * y + x], pixels + 3 * ((size_t)py * width + px), 3);
+                }
+            }
+            CompressBlockBC1(block, out);
+            out += 8;
+        }
+    }
+}
+
+void TextureData_Build(const unsigned char *pixels, int width, int height, uint32_t format, TextureData *texture)
+{
+    texture->format = format;
+    texture->width = (uint32_t)width;
+    texture->height = (uint32_t)height;
+    texture->num_levels = NumLevels(texture->width, texture->height);
+
+    size_t total = 0;
+    for (uint32_t level = 0; level < texture->num_levels; ++level)
+        total += TextureData_LevelSize(format,
+                                       TextureData_LevelDimension(texture->width, level),
+                                       TextureData_LevelDimension(texture->height, level));
+    texture->data.resize(total);
+
+    // Cada nível é reduzido a partir do anterior, ainda sem compressão
+    std::vector<unsigned char> current(pixels, pixels + (size_t)width * height * 3);
+    std::vector<unsigned char> next;
+    unsigned char *out = texture->data.data();
+    for (uint32_t level = 0; level < texture->num_levels; ++level)
+    {
+        uint32_t w = TextureData_LevelDimension(texture->width, level);
+        uint32_t h = TextureData_LevelDimension(texture->height, level);
+
+        if (format == TEXTURE_FORMAT_BC1)
+            CompressLevelBC1(current.data(), w, h, out);
+        else
+            memcpy(out, current.data(), current.size());
+        out += TextureData_LevelSize(format, w, h);
+
+        if (level + 1 < texture->num_levels)
+        {
+            uint32_t next_w = TextureData_LevelDimension(texture->width, level + 1);
+            uint32_t next_h = TextureData_LevelDimension(texture->height, level + 1);
+            next.resize((size_t)next_w * next_h * 3);
+            Downsample(current.data(), w, h, next.data(), next_w, next_h);
+            current.swap(next);
+        }
+    }
+}
+
+std::string TextureCache_Filename(const char *image_filename)
+{
+    return CacheFile_Filename(image_filename, ".tex");
+}
+
+bool TextureCache_Read(const char *image_filename, uint32_t format, TextureData *texture)
+{
+    std::string cache_filename = TextureCache_Filename(image_filename);
+    FILE *f = fopen(cache_filename.c_str(), "rb");
+    if (f == NULL)
+        return false;
+
+    TextureCacheHeader header;
+    bool valid = fread(&header, sizeof(header), 1, f) == 1 &&
+                 memcmp(header.magic, TEXTURE_CACHE_MAGIC, 4) == 0 &&
+                 header.version == TEXTURE_CACHE_VERSION &&
+                 header.format == format &&
+                 header.width > 0 && header.height > 0 &&
+                 header.num_levels == NumLevels(header.width, header.height);
+
+    if (valid)
+    {
+        size_t expected = 0;
+        for (uint32_t level = 0; level < header.num_levels; ++level)
+            expected += TextureData_LevelSize(format,
+                                              TextureData_LevelDimension(header.width, level),
+                                              TextureData_LevelDimension(header.height, level));
+        valid = (header.data_bytes == expected);
+    }
+
+    // O cache só é válido se a imagem de origem não mudou
+    if (valid)
+        valid = CacheFile_SourceUnchanged(image_filename, header.source_size, header.source_mtime, header.source_hash);
+
+    if (valid)
+    {
+        texture->data.resize((size_t)header.data_bytes);
+        valid = fread(texture->data.data(), 1, texture->data.size(), f) == texture->data.size();
+    }
+    fclose(f);
+
+    if (!valid)
+    {
+        texture->data.clear();
+        return false;
+    }
+
+    texture->format = header.format;
+    texture->width = header.width;
+    texture->height = header.height;
+    texture->num_levels = header.num_levels;
+    return true;
+}
+
+bool TextureCache_Write(const char *image_filename, const TextureData &texture)
+{
+    TextureCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TEXTURE_CACHE_MAGIC, 4);
+    header.version = TEXTURE_CACHE_VERSION;
+    header.format = texture.format;
+    header.width = texture.width;
+    header.height = texture.height;
+    header.num_levels = texture.num_levels;
+    header.data_bytes = texture.data.size();
+
+    if (!CacheFile_Stat(image_filename, &header.source_size, &header.source_mtime) ||
+        !CacheFile_Hash(image_filename, &header.source_hash))
+        return false;
+
+    CacheFileChunk chunk = {texture.data.data(), texture.data.size()};
+    std::string cache_filename = TextureCache_Filename(image_filename);
+    return CacheFile_Write(cache_filename.c_str(), &header, sizeof(header), &chunk, 1);
+}